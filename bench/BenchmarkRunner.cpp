@@ -0,0 +1,113 @@
+#include "BenchmarkRunner.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QHash>
+#include <QSysInfo>
+#include <QDateTime>
+#include <algorithm>
+
+BenchmarkRunner::BenchmarkRunner(int minTimeMs, int repetitions)
+    : m_minTimeMs(qMax(1, minTimeMs))
+    , m_repetitions(qMax(1, repetitions))
+{
+}
+
+void BenchmarkRunner::run(const QString& name, const std::function<void()>& body)
+{
+    if (!m_filter.isEmpty() && !name.contains(m_filter)) {
+        return;
+    }
+
+    // Calibrate: double the iteration count until one repetition takes long enough
+    const qint64 targetNs = qint64(m_minTimeMs) * 1000000 / m_repetitions;
+    qint64 iterations = 1;
+    QElapsedTimer timer;
+    forever {
+        timer.start();
+        for (qint64 i = 0; i < iterations; ++i) {
+            body();
+        }
+        qint64 elapsed = timer.nsecsElapsed();
+        if (elapsed >= targetNs || iterations >= (qint64(1) << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    QList<double> samples;
+    for (int r = 0; r < m_repetitions; ++r) {
+        timer.start();
+        for (qint64 i = 0; i < iterations; ++i) {
+            body();
+        }
+        samples.append(double(timer.nsecsElapsed()) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = samples[samples.size() / 2];
+    result.minNsPerOp = samples.first();
+    m_results.append(result);
+
+    qInfo("%-48s %12.1f ns/op  (min %.1f, %lld iterations)",
+          qPrintable(name), result.nsPerOp, result.minNsPerOp, static_cast<long long>(iterations));
+}
+
+QJsonObject BenchmarkRunner::toJson() const
+{
+    QJsonArray benchmarks;
+    for (const BenchmarkResult& result : m_results) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["iterations"] = result.iterations;
+        entry["ns_per_op"] = result.nsPerOp;
+        entry["min_ns_per_op"] = result.minNsPerOp;
+        benchmarks.append(entry);
+    }
+
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    context["host"] = QSysInfo::machineHostName();
+    context["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    context["qt_version"] = QString(qVersion());
+
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = benchmarks;
+    return root;
+}
+
+bool BenchmarkRunner::compareWithBaseline(const QJsonObject& baseline, double thresholdPercent, QString* report) const
+{
+    QHash<QString, double> baselineNs;
+    const QJsonArray benchmarks = baseline["benchmarks"].toArray();
+    for (const QJsonValue& value : benchmarks) {
+        QJsonObject entry = value.toObject();
+        baselineNs.insert(entry["name"].toString(), entry["ns_per_op"].toDouble());
+    }
+
+    bool ok = true;
+    for (const BenchmarkResult& result : m_results) {
+        if (!baselineNs.contains(result.name) || baselineNs[result.name] <= 0) {
+            *report += QString("%1: no baseline\n").arg(result.name);
+            continue;
+        }
+
+        double before = baselineNs[result.name];
+        double changePercent = (result.nsPerOp - before) / before * 100.0;
+        bool regressed = changePercent > thresholdPercent;
+        if (regressed) ok = false;
+
+        *report += QString("%1: %2 -> %3 ns/op (%4%5%)%6\n")
+                       .arg(result.name)
+                       .arg(before, 0, 'f', 1)
+                       .arg(result.nsPerOp, 0, 'f', 1)
+                       .arg(changePercent >= 0 ? "+" : "")
+                       .arg(changePercent, 0, 'f', 1)
+                       .arg(regressed ? "  REGRESSION" : "");
+    }
+
+    return ok;
+}
@@ -0,0 +1,54 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <functional>
+
+// Keeps the compiler from discarding a benchmarked computation
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+struct BenchmarkResult
+{
+    QString name;
+    qint64 iterations = 0;
+    double nsPerOp = 0.0;   // median over repetitions
+    double minNsPerOp = 0.0;
+};
+
+// Minimal calibrated microbenchmark loop with JSON output and baseline diffing
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(int minTimeMs = 200, int repetitions = 5);
+
+    void setFilter(const QString& filter) { m_filter = filter; }
+
+    void run(const QString& name, const std::function<void()>& body);
+
+    const QList<BenchmarkResult>& results() const { return m_results; }
+
+    QJsonObject toJson() const;
+
+    // Prints a per-benchmark comparison; returns false if any benchmark got
+    // slower than the baseline by more than thresholdPercent
+    bool compareWithBaseline(const QJsonObject& baseline, double thresholdPercent, QString* report) const;
+
+private:
+    int m_minTimeMs;
+    int m_repetitions;
+    QString m_filter;
+    QList<BenchmarkResult> m_results;
+};
+
+#endif // BENCHMARKRUNNER_H
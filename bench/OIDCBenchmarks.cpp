@@ -0,0 +1,266 @@
+#include "OIDCBenchmarks.h"
+#include "BenchmarkRunner.h"
+#include "OIDCManager.h"
+#include "JWTDecoder.h"
+#include "ClaimExtractor.h"
+#include "JsonScanner.h"
+#include "JwsSigner.h"
+#include "ClientAssertion.h"
+#include "DpopProof.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QUrl>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+static const QByteArray::Base64Options BASE64URL = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+// Builds a realistic signed-looking JWT whose size is driven by group membership
+QString makeBenchmarkToken(int groupCount)
+{
+    QJsonObject header;
+    header["alg"] = "RS256";
+    header["typ"] = "JWT";
+    header["kid"] = "bench-key-1";
+
+    QJsonArray groups;
+    for (int i = 0; i < groupCount; ++i) {
+        groups.append(QString("cn=group-%1,ou=groups,dc=example,dc=com").arg(i));
+    }
+
+    QJsonObject payload;
+    payload["iss"] = "https://idp.example.com";
+    payload["sub"] = "248289761001";
+    payload["aud"] = "bench-client";
+    payload["exp"] = 1893456000;
+    payload["iat"] = 1893452400;
+    payload["nonce"] = "n-0S6_WzA2Mj";
+    payload["acr"] = "com:imprivata:oidc:epic:sso";
+    payload["amr"] = QJsonArray({"pwd", "otp"});
+    payload["name"] = "Jane Doe";
+    payload["email"] = "jane.doe@example.com";
+    payload["groups"] = groups;
+
+    QByteArray signature(256, '\x5a');
+
+    return QString::fromLatin1(QJsonDocument(header).toJson(QJsonDocument::Compact).toBase64(BASE64URL) + "." +
+                               QJsonDocument(payload).toJson(QJsonDocument::Compact).toBase64(BASE64URL) + "." +
+                               signature.toBase64(BASE64URL));
+}
+
+void OIDCManagerBenchmark::registerBenchmarks(BenchmarkRunner& runner)
+{
+    OIDCManager manager;
+    manager.m_config.clientID = "bench-client";
+    manager.m_config.scopes = "openid profile email groups";
+    manager.m_config.responseType = "code";
+    manager.m_state = "5f2b7c9d1e3a4b6c";
+    manager.m_nonce = "n-0S6_WzA2Mj";
+    manager.m_codeChallenge = "E9Melhoa2OwvFrEMTJguCHaoeK1t8URWbuGJSstw-cM";
+    manager.m_config.acrValue = "SSO (com:imprivata:oidc:epic:sso)";
+    manager.m_config.loginHint = "jane.doe@example.com";
+    manager.m_config.promptLogin = true;
+    manager.m_config.extraParams = "resource=https://api.example.com&ui_locales=en";
+
+    runner.run("OIDCManager::buildAuthorizationURL", [&manager]() {
+        QUrl url = manager.buildAuthorizationURL("https://idp.example.com/oauth2/authorize");
+        doNotOptimize(url);
+    });
+
+    const QByteArray getRequest =
+        "GET /callback?code=SplxlOBeZQQYbYS6WxSbIA&state=5f2b7c9d1e3a4b6c HTTP/1.1\r\n"
+        "Host: localhost:8080\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n"
+        "Accept: text/html\r\n"
+        "\r\n";
+    runner.run("OIDCManager::parseCallbackRequest/get", [&getRequest]() {
+        QString url = OIDCManager::parseCallbackRequest(getRequest, 8080);
+        doNotOptimize(url);
+    });
+
+    const QByteArray postRequest =
+        "POST /callback HTTP/1.1\r\n"
+        "Host: localhost:8080\r\n"
+        "Content-Type: application/x-www-form-urlencoded\r\n"
+        "\r\n"
+        "state=5f2b7c9d1e3a4b6c&id_token=" + makeBenchmarkToken(100).toLatin1() +
+        "&access_token=" + makeBenchmarkToken(10).toLatin1();
+    runner.run("OIDCManager::parseCallbackRequest/form_post", [&postRequest]() {
+        QString url = OIDCManager::parseCallbackRequest(postRequest, 8080);
+        doNotOptimize(url);
+    });
+
+    QJsonObject tokenResponse;
+    tokenResponse["access_token"] = makeBenchmarkToken(10);
+    tokenResponse["id_token"] = makeBenchmarkToken(100);
+    tokenResponse["refresh_token"] = "8xLOxBtZp8";
+    tokenResponse["token_type"] = "Bearer";
+    tokenResponse["expires_in"] = 3600;
+    const QByteArray tokenResponseData = QJsonDocument(tokenResponse).toJson(QJsonDocument::Compact);
+    runner.run("OIDCManager::tokenResponse/parse+format", [&tokenResponseData]() {
+        QJsonDocument doc = QJsonDocument::fromJson(tokenResponseData);
+        QString result = OIDCManager::formatTokenResponse(doc.object());
+        doNotOptimize(result);
+    });
+
+    for (JsonObjectView::Backend backend : {JsonObjectView::QtBackend, JsonObjectView::OnDemandBackend}) {
+        const QString suffix = backend == JsonObjectView::QtBackend ? "/qt" : "/ondemand";
+        runner.run("JsonObjectView::tokenResponse/parse+format" + suffix, [&tokenResponseData, backend]() {
+            JsonObjectView json(tokenResponseData, backend);
+            QString result = OIDCManager::formatTokenResponse(json);
+            doNotOptimize(result);
+        });
+    }
+}
+
+QStringList checkJsonBackends()
+{
+    // Malformed responses must fail on both backends; duplicates resolve alike
+    static const char* const inputs[] = {
+        "{}", "  {\"a\":true} \n", "{\"a\":-0.5e+3}", "{\"a\":null,\"b\":[1,{\"c\":2}]}",
+        "{\"a\":1,\"a\":2}", "{\"a\":\"x\",\"a\":false}",
+        "{\"a\":}", "{\"a\":,\"b\":1}", "{\"a\":tru}", "{\"a\":truex}", "{\"a\":nul}", "{\"a\":1x}",
+        "{\"a\":01}", "{\"a\":1.}", "{\"a\":1e}", "{\"a\":-}", "{\"a\":+1}", "{\"a\":1}x", "{\"a\":1} {}",
+        "{\"a\":\"x\"", "{\"a\" 1}",
+    };
+
+    QStringList mismatches;
+    for (const char* input : inputs) {
+        const QByteArray json(input);
+        JsonObjectView qt(json, JsonObjectView::QtBackend);
+        JsonObjectView onDemand(json, JsonObjectView::OnDemandBackend);
+
+        const QLatin1String key("a");
+        bool agree = qt.isValid() == onDemand.isValid();
+        if (agree && qt.isValid()) {
+            agree = qt.type(key) == onDemand.type(key) && qt.integer(key, -1) == onDemand.integer(key, -1)
+                 && qt.string(key) == onDemand.string(key);
+        }
+        if (!agree) {
+            mismatches << QString("%1: qt %2, ondemand %3").arg(QString::fromLatin1(input))
+                          .arg(qt.isValid() ? "valid" : "invalid", onDemand.isValid() ? "valid" : "invalid");
+        }
+    }
+    return mismatches;
+}
+
+void registerJWTDecoderBenchmarks(BenchmarkRunner& runner)
+{
+    for (int groupCount : {0, 100, 1000}) {
+        const QString token = makeBenchmarkToken(groupCount);
+        const QString payload = token.section('.', 1, 1);
+        const QString suffix = QString("/groups:%1").arg(groupCount);
+
+        runner.run("JWTDecoder::decodeBase64URLSafe" + suffix, [&payload]() {
+            QByteArray decoded = JWTDecoder::decodeBase64URLSafe(payload);
+            doNotOptimize(decoded);
+        });
+
+        runner.run("JWTDecoder::formatTokenDetails" + suffix, [&token]() {
+            QString details = JWTDecoder::formatTokenDetails(token);
+            doNotOptimize(details);
+        });
+
+        // Validation-only read: full DOM versus the single-pass extractor
+        runner.run("JWTDecoder::validationClaims/dom" + suffix, [&payload]() {
+            QJsonObject claims = QJsonDocument::fromJson(JWTDecoder::decodeBase64URLSafe(payload)).object();
+            qint64 exp = qint64(claims["exp"].toDouble());
+            QString nonce = claims["nonce"].toString();
+            doNotOptimize(exp);
+            doNotOptimize(nonce);
+        });
+
+        runner.run("ClaimExtractor::extractFromJWT/validation" + suffix, [&token]() {
+            ClaimSet claims;
+            ClaimExtractor::extractFromJWT(token, VALIDATION_CLAIMS, &claims);
+            qint64 exp = claims.integer(Claim::Exp);
+            QString nonce = claims.string(Claim::Nonce);
+            doNotOptimize(exp);
+            doNotOptimize(nonce);
+        });
+    }
+}
+
+// Fresh unencrypted PEM key, so the benchmarks need no key files
+static QByteArray generateKeyPem(const char* type, const char* parameter)
+{
+    EVP_PKEY* key = qstrcmp(type, "RSA") == 0 ? EVP_PKEY_Q_keygen(nullptr, nullptr, "RSA", size_t(2048))
+                                              : EVP_PKEY_Q_keygen(nullptr, nullptr, type, parameter);
+    BIO* bio = BIO_new(BIO_s_mem());
+    QByteArray pem;
+    if (key && bio && PEM_write_bio_PrivateKey(bio, key, nullptr, nullptr, 0, nullptr, nullptr) == 1) {
+        char* data = nullptr;
+        long length = BIO_get_mem_data(bio, &data);
+        pem = QByteArray(data, int(length));
+    }
+    BIO_free(bio);
+    EVP_PKEY_free(key);
+    return pem;
+}
+
+void registerClientAssertionBenchmarks(BenchmarkRunner& runner)
+{
+    const QString audience = "https://idp.example.com/oauth2/token";
+    const QByteArray jti = "Vh3z5fQ0rX2kLm8pNw1aYg";
+
+    runner.run("ClientAssertionPool::assertionPayload", [&audience, &jti]() {
+        QByteArray payload = ClientAssertionPool::assertionPayload("bench-client", audience, jti, 1893452400, 60);
+        doNotOptimize(payload);
+    });
+
+    // What a token request pays when it signs its own assertion (an empty pool)
+    for (const char* type : {"RSA", "EC"}) {
+        JwsSigner signer;
+        QString error;
+        if (!signer.loadPem(generateKeyPem(type, "P-256"), "JWT", "bench-key-1", &error)) {
+            qWarning("Skipping %s signing benchmark: %s", type, qPrintable(error));
+            continue;
+        }
+
+        const QByteArray payload = ClientAssertionPool::assertionPayload("bench-client", audience, jti, 1893452400, 60);
+        runner.run("JwsSigner::signToken/" + signer.algorithm(), [&signer, &payload]() {
+            QByteArray token = signer.signToken(payload);
+            doNotOptimize(token);
+        });
+    }
+}
+
+// Per-request CPU cost of DPoP: what each token, refresh or resource request adds
+void registerDpopBenchmarks(BenchmarkRunner& runner)
+{
+    runner.run("JwsSigner::generateP256", []() {
+        JwsSigner signer;
+        bool ok = signer.generateP256("dpop+jwt", nullptr);
+        doNotOptimize(ok);
+    });
+
+    DpopProofFactory dpop;
+    QString error;
+    if (!dpop.generateKey(&error)) {
+        qWarning("Skipping DPoP benchmarks: %s", qPrintable(error));
+        return;
+    }
+
+    const QUrl tokenEndpoint("https://idp.example.com/oauth2/token");
+    const QUrl resource("https://api.example.com/v1/patients?page=2");
+    const QString accessToken = makeBenchmarkToken(10);
+    dpop.setNonce(tokenEndpoint, "eyJ7S_zG.eyJH0-Z.HX4w-7v");
+
+    runner.run("DpopProofFactory::payload/token", [&dpop, &tokenEndpoint]() {
+        QByteArray payload = dpop.payload("POST", tokenEndpoint, 1893452400, "Vh3z5fQ0rX2kLm8pNw1aYg",
+                                          "eyJ7S_zG.eyJH0-Z.HX4w-7v", QString());
+        doNotOptimize(payload);
+    });
+
+    runner.run("DpopProofFactory::proof/token", [&dpop, &tokenEndpoint]() {
+        QByteArray proof = dpop.proof("POST", tokenEndpoint);
+        doNotOptimize(proof);
+    });
+
+    runner.run("DpopProofFactory::proof/resource", [&dpop, &resource, &accessToken]() {
+        QByteArray proof = dpop.proof("GET", resource, accessToken);
+        doNotOptimize(proof);
+    });
+}
@@ -0,0 +1,25 @@
+#ifndef OIDCBENCHMARKS_H
+#define OIDCBENCHMARKS_H
+
+#include <QString>
+#include <QStringList>
+
+class BenchmarkRunner;
+
+// Friend of OIDCManager so the URL builder can be driven without a live flow
+class OIDCManagerBenchmark
+{
+public:
+    static void registerBenchmarks(BenchmarkRunner& runner);
+};
+
+void registerJWTDecoderBenchmarks(BenchmarkRunner& runner);
+void registerClientAssertionBenchmarks(BenchmarkRunner& runner);
+void registerDpopBenchmarks(BenchmarkRunner& runner);
+
+QString makeBenchmarkToken(int groupCount);
+
+// Inputs on which the two JsonObjectView backends disagree (empty when they match)
+QStringList checkJsonBackends();
+
+#endif // OIDCBENCHMARKS_H
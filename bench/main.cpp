@@ -0,0 +1,70 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QFile>
+#include <QTextStream>
+#include "BenchmarkRunner.h"
+#include "OIDCBenchmarks.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("oidc-tester-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Microbenchmarks for the OIDC Tester hot paths");
+    parser.addHelpOption();
+    parser.addOption({"json", "Write results as JSON to <file>.", "file"});
+    parser.addOption({"baseline", "Compare against a previous --json output.", "file"});
+    parser.addOption({"threshold", "Allowed slowdown vs. the baseline in percent.", "percent", "10"});
+    parser.addOption({"filter", "Only run benchmarks whose name contains <text>.", "text"});
+    parser.addOption({"min-time", "Measured time per benchmark in milliseconds.", "ms", "200"});
+    parser.process(app);
+
+    QTextStream out(stdout);
+
+    // A fast parser is only worth timing if it rejects what QJsonDocument rejects
+    const QStringList mismatches = checkJsonBackends();
+    if (!mismatches.isEmpty()) {
+        out << "JsonObjectView backends disagree:" << Qt::endl;
+        for (const QString& mismatch : mismatches) {
+            out << "  " << mismatch << Qt::endl;
+        }
+        return 3;
+    }
+
+    BenchmarkRunner runner(parser.value("min-time").toInt());
+    runner.setFilter(parser.value("filter"));
+
+    registerJWTDecoderBenchmarks(runner);
+    OIDCManagerBenchmark::registerBenchmarks(runner);
+    registerClientAssertionBenchmarks(runner);
+    registerDpopBenchmarks(runner);
+
+    if (parser.isSet("json")) {
+        QFile file(parser.value("json"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            out << "Failed to write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+        file.write(QJsonDocument(runner.toJson()).toJson(QJsonDocument::Indented));
+    }
+
+    if (parser.isSet("baseline")) {
+        QFile file(parser.value("baseline"));
+        if (!file.open(QIODevice::ReadOnly)) {
+            out << "Failed to read baseline " << file.fileName() << Qt::endl;
+            return 1;
+        }
+
+        QString report;
+        bool ok = runner.compareWithBaseline(QJsonDocument::fromJson(file.readAll()).object(),
+                                             parser.value("threshold").toDouble(), &report);
+        out << Qt::endl << report;
+        if (!ok) {
+            return 2;
+        }
+    }
+
+    return 0;
+}
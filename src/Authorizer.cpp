@@ -0,0 +1,39 @@
+#include "Authorizer.h"
+#include <QDesktopServices>
+#include <QProcess>
+
+Authorizer::Authorizer(QObject *parent)
+    : QObject(parent)
+{
+}
+
+Authorizer::~Authorizer()
+{
+}
+
+void Authorizer::cancel()
+{
+}
+
+BrowserAuthorizer::BrowserAuthorizer(QObject *parent)
+    : Authorizer(parent)
+{
+}
+
+bool BrowserAuthorizer::authorize(const QUrl& authURL, const QString& redirectURI)
+{
+    Q_UNUSED(redirectURI);
+
+    // Open browser in incognito mode
+    if (!QProcess::startDetached("google-chrome", {"--incognito", authURL.toString()})) {
+        // Fallback to default browser if Chrome fails
+        emit logMessage("Failed to launch Chrome incognito, trying default browser...");
+        if (!QDesktopServices::openUrl(authURL)) {
+            emit errorOccurred("Failed to open browser.");
+            emit logMessage("Failed to open browser.");
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef AUTHORIZER_H
+#define AUTHORIZER_H
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+
+// Performs the user-agent leg of the flow: given the authorization URL, get
+// the IdP to redirect back to the redirect URI.
+class Authorizer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Authorizer(QObject *parent = nullptr);
+    ~Authorizer() override;
+
+    // Returns false if the authorization could not be started at all
+    virtual bool authorize(const QUrl& authURL, const QString& redirectURI) = 0;
+    virtual void cancel();
+
+    // True if the redirect is delivered through callbackCaptured() instead of
+    // the local callback server
+    virtual bool capturesCallback() const = 0;
+
+signals:
+    void callbackCaptured(const QUrl& url);
+    void errorOccurred(const QString& error);
+    void logMessage(const QString& message);
+};
+
+// Hands the authorization URL to a human in Chrome incognito (or the default browser)
+class BrowserAuthorizer : public Authorizer
+{
+    Q_OBJECT
+
+public:
+    explicit BrowserAuthorizer(QObject *parent = nullptr);
+
+    bool authorize(const QUrl& authURL, const QString& redirectURI) override;
+    bool capturesCallback() const override { return false; }
+};
+
+#endif // AUTHORIZER_H
@@ -0,0 +1,92 @@
+#include "ClaimExtractor.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <cstring>
+
+int ClaimExtractor::lookup(const char* key, int length)
+{
+    for (int i = 0; i < int(Claim::Count); ++i) {
+        const char* name = CLAIM_NAMES[i];
+        // A key may contain a NUL, so compare lengths before bytes
+        if (std::strlen(name) == size_t(length) && std::memcmp(name, key, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ClaimExtractor::extract(const QByteArray& payload, ClaimMask wanted, ClaimSet* claims)
+{
+    *claims = ClaimSet();
+    claims->m_payload = payload;
+    if (wanted == 0) return true;
+
+    const char* data = payload.constData();
+
+    // Scans the whole payload: a repeated claim resolves to its last
+    // occurrence, as in QJsonDocument and JsonObjectView
+    return JsonScanner::forEachMember(data, payload.size(),
+        [&](int keyOffset, int keyLength, bool keyEscaped, int valueOffset, int valueLength, JsonType type) {
+            // Registered names never need escaping, so escaped keys cannot match
+            int index = keyEscaped ? -1 : lookup(data + keyOffset, keyLength);
+            if (index >= 0 && (wanted & (ClaimMask(1) << index))) {
+                claims->m_offsets[index] = valueOffset;
+                claims->m_lengths[index] = valueLength;
+                claims->m_types[index] = type;
+            }
+            return true;
+        });
+}
+
+bool ClaimExtractor::extractFromJWT(const QString& token, ClaimMask wanted, ClaimSet* claims)
+{
+    int first = token.indexOf('.');
+    int second = first < 0 ? -1 : token.indexOf('.', first + 1);
+    if (second < 0) {
+        *claims = ClaimSet();
+        return false;
+    }
+
+    QByteArray payload = QByteArray::fromBase64(token.mid(first + 1, second - first - 1).toLatin1(),
+                                                QByteArray::Base64UrlEncoding);
+    return extract(payload, wanted, claims);
+}
+
+QByteArray ClaimSet::raw(Claim claim) const
+{
+    if (!has(claim)) return QByteArray();
+    return m_payload.mid(m_offsets[int(claim)], m_lengths[int(claim)]);
+}
+
+QString ClaimSet::string(Claim claim) const
+{
+    if (type(claim) != JsonType::String) return QString();
+    return JsonScanner::unescape(m_payload.constData() + m_offsets[int(claim)] + 1, m_lengths[int(claim)] - 2);
+}
+
+qint64 ClaimSet::integer(Claim claim, qint64 defaultValue) const
+{
+    if (type(claim) != JsonType::Number) return defaultValue;
+
+    bool ok = false;
+    double value = QByteArray::fromRawData(m_payload.constData() + m_offsets[int(claim)],
+                                           m_lengths[int(claim)]).toDouble(&ok);
+    return ok ? qint64(value) : defaultValue;
+}
+
+QStringList ClaimSet::strings(Claim claim) const
+{
+    if (type(claim) == JsonType::String) {
+        return {string(claim)};
+    }
+    if (type(claim) != JsonType::Array) {
+        return {};
+    }
+
+    QStringList values;
+    const QJsonArray array = QJsonDocument::fromJson(raw(claim)).array();
+    for (const QJsonValue& value : array) {
+        values.append(value.toString());
+    }
+    return values;
+}
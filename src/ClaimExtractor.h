@@ -0,0 +1,82 @@
+#ifndef CLAIMEXTRACTOR_H
+#define CLAIMEXTRACTOR_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include "JsonScanner.h"
+
+// Registered (RFC 7519) and OIDC Core claims the extractor knows by name
+enum class Claim : quint8
+{
+    Iss, Sub, Aud, Exp, Nbf, Iat, Jti,
+    Nonce, Acr, Amr, Azp, AuthTime, Sid, AtHash, CHash,
+    Scope, ClientId,
+    Count
+};
+
+typedef quint32 ClaimMask;
+
+constexpr ClaimMask claimBit(Claim claim) { return ClaimMask(1) << int(claim); }
+
+// Claims needed to validate an ID token (time window, issuer, audience, nonce, acr)
+constexpr ClaimMask VALIDATION_CLAIMS = claimBit(Claim::Iss) | claimBit(Claim::Aud) | claimBit(Claim::Exp) |
+                                        claimBit(Claim::Nbf) | claimBit(Claim::Iat) | claimBit(Claim::Nonce) |
+                                        claimBit(Claim::Acr) | claimBit(Claim::Azp);
+
+// Raw JSON slices of the requested claims. Values stay in the decoded payload
+// (implicitly shared) and are only converted when read.
+class ClaimSet
+{
+public:
+    bool has(Claim claim) const { return m_types[int(claim)] != JsonType::Missing; }
+    JsonType type(Claim claim) const { return m_types[int(claim)]; }
+
+    // Raw JSON text of the value (strings include their quotes)
+    QByteArray raw(Claim claim) const;
+
+    QString string(Claim claim) const;
+    qint64 integer(Claim claim, qint64 defaultValue = 0) const;
+
+    // "aud" may be a string or an array of strings
+    QStringList strings(Claim claim) const;
+
+    const QByteArray& payload() const { return m_payload; }
+
+private:
+    friend class ClaimExtractor;
+
+    QByteArray m_payload;
+    int m_offsets[int(Claim::Count)] = {};
+    int m_lengths[int(Claim::Count)] = {};
+    JsonType m_types[int(Claim::Count)] = {};
+};
+
+// Pulls selected top-level claims out of a JWT payload in a single forward
+// scan, without building a QJsonDocument. Nested values are skipped, not
+// parsed, and a claim that appears twice takes its last value.
+class ClaimExtractor
+{
+public:
+    static constexpr const char* name(Claim claim) { return CLAIM_NAMES[int(claim)]; }
+
+    // payload is the decoded JSON object text; false only if it is malformed
+    // (requested claims that are absent simply stay Missing)
+    static bool extract(const QByteArray& payload, ClaimMask wanted, ClaimSet* claims);
+
+    // Decodes the payload segment of a compact JWT, then extracts
+    static bool extractFromJWT(const QString& token, ClaimMask wanted, ClaimSet* claims);
+
+private:
+    static constexpr const char* CLAIM_NAMES[] = {
+        "iss", "sub", "aud", "exp", "nbf", "iat", "jti",
+        "nonce", "acr", "amr", "azp", "auth_time", "sid", "at_hash", "c_hash",
+        "scope", "client_id"
+    };
+    static_assert(sizeof(CLAIM_NAMES) / sizeof(CLAIM_NAMES[0]) == size_t(Claim::Count),
+                  "CLAIM_NAMES must match the Claim enum");
+
+    static int lookup(const char* key, int length);
+};
+
+#endif // CLAIMEXTRACTOR_H
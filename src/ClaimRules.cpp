@@ -0,0 +1,279 @@
+#include "ClaimRules.h"
+#include "JsonScanner.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QVarLengthArray>
+#include <cstring>
+
+ClaimRules::ClaimRules()
+    : m_evaluated(0)
+{
+}
+
+bool ClaimRules::loadFile(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = QString("Cannot open rules file %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return compile(QString::fromUtf8(file.readAll()), error);
+}
+
+int ClaimRules::slotFor(Source source, const QString& claim)
+{
+    if (claim == "now") return NOW_SLOT;
+
+    QByteArray name = claim.toUtf8();
+    int slot = m_claimNames[source].indexOf(name);
+    if (slot < 0) {
+        m_claimNames[source].append(name);
+        slot = m_claimNames[source].size() - 1;
+    }
+    return slot;
+}
+
+bool ClaimRules::compile(const QString& text, QString* error)
+{
+    static const QRegularExpression rulePattern(
+        "^(?:(id_token|access_token)\\s*:\\s*)?"
+        "([A-Za-z_][\\w:.\\-]*)"
+        "(?:\\s+-\\s+([A-Za-z_][\\w:.\\-]*))?"
+        "\\s*(==|!=|<=|>=|<|>|!contains|contains|exists|missing)"
+        "\\s*(.*)$");
+    static const QStringList operators = {"==", "!=", "<", "<=", ">", ">=", "contains", "!contains", "exists", "missing"};
+
+    m_program.clear();
+    m_ruleText.clear();
+    for (QVector<QByteArray>& names : m_claimNames) {
+        names.clear();
+    }
+
+    const QStringList lines = text.split('\n');
+    for (int lineNumber = 1; lineNumber <= lines.size(); ++lineNumber) {
+        QString line = lines[lineNumber - 1];
+        int comment = line.indexOf('#');
+        if (comment >= 0 && line.left(comment).count('"') % 2 == 0) {
+            line.truncate(comment);
+        }
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+
+        QRegularExpressionMatch match = rulePattern.match(line);
+        if (!match.hasMatch()) {
+            *error = QString("line %1: cannot parse \"%2\"").arg(lineNumber).arg(line);
+            return false;
+        }
+
+        Instruction instruction;
+        instruction.source = match.captured(1) == "access_token" ? AccessToken : IdToken;
+        instruction.op = Op(operators.indexOf(match.captured(4)));
+        instruction.left = slotFor(instruction.source, match.captured(2));
+        instruction.right = match.captured(3).isEmpty() ? NO_SLOT : slotFor(instruction.source, match.captured(3));
+        instruction.literalKind = NoLiteral;
+        instruction.number = 0.0;
+
+        QString literal = match.captured(5).trimmed();
+        bool unary = instruction.op == Exists || instruction.op == Missing;
+        if (unary != literal.isEmpty()) {
+            *error = QString("line %1: %2").arg(lineNumber)
+                         .arg(unary ? "exists/missing take no value" : "missing value to compare with");
+            return false;
+        }
+
+        if (literal.size() >= 2 && literal.startsWith('"') && literal.endsWith('"')) {
+            instruction.literalKind = StringLiteral;
+            instruction.text = literal.mid(1, literal.size() - 2);
+        } else if (!literal.isEmpty()) {
+            bool isNumber = false;
+            instruction.number = literal.toDouble(&isNumber);
+            instruction.literalKind = isNumber ? NumberLiteral : BareLiteral;
+            instruction.text = literal;
+            instruction.bare = literal.toUtf8();
+        }
+
+        bool ordering = instruction.op >= Less && instruction.op <= GreaterEqual;
+        if ((ordering || instruction.right != NO_SLOT || instruction.left == NOW_SLOT) &&
+            !unary && instruction.literalKind != NumberLiteral) {
+            *error = QString("line %1: numeric comparison needs a number").arg(lineNumber);
+            return false;
+        }
+        if ((instruction.op == Contains || instruction.op == NotContains) && instruction.right != NO_SLOT) {
+            *error = QString("line %1: contains applies to a single claim").arg(lineNumber);
+            return false;
+        }
+
+        m_program.append(instruction);
+        m_ruleText.append(line);
+    }
+
+    m_violations.reset(new std::atomic<quint64>[qMax(1, m_program.size())]);
+    resetCounters();
+    return true;
+}
+
+void ClaimRules::resetCounters()
+{
+    for (int i = 0; i < m_program.size(); ++i) {
+        m_violations[i].store(0, std::memory_order_relaxed);
+    }
+    m_evaluated.store(0, std::memory_order_relaxed);
+}
+
+// True if the array or space-separated string value holds `text`
+static bool valueContains(const QByteArray& payload, int offset, int length, JsonType type, const QString& text)
+{
+    const char* data = payload.constData();
+    if (type == JsonType::String) {
+        const QStringList words = JsonScanner::unescape(data + offset + 1, length - 2).split(' ', Qt::SkipEmptyParts);
+        return words.contains(text);
+    }
+    if (type != JsonType::Array) return false;
+
+    int end = offset + length;
+    int pos = JsonScanner::skipWhitespace(data, offset + 1, end);
+    while (pos < end && data[pos] != ']') {
+        JsonType elementType;
+        int elementEnd = JsonScanner::skipValue(data, pos, end, &elementType);
+        if (elementEnd < 0) return false;
+
+        if (elementType == JsonType::String &&
+            JsonScanner::unescape(data + pos + 1, elementEnd - pos - 2) == text) {
+            return true;
+        }
+
+        pos = JsonScanner::skipWhitespace(data, elementEnd, end);
+        if (pos < end && data[pos] == ',') {
+            pos = JsonScanner::skipWhitespace(data, pos + 1, end);
+        }
+    }
+    return false;
+}
+
+bool ClaimRules::check(const Instruction& instruction, const QByteArray& payload, const Slice* slices, qint64 now) const
+{
+    auto present = [slices](int slot) {
+        return slot == NOW_SLOT || JsonType(slices[slot].type) != JsonType::Missing;
+    };
+    auto numberAt = [&payload, slices, now](int slot, bool* ok) -> double {
+        if (slot == NOW_SLOT) {
+            *ok = true;
+            return double(now);
+        }
+        const Slice& slice = slices[slot];
+        *ok = JsonType(slice.type) == JsonType::Number;
+        return *ok ? QByteArray::fromRawData(payload.constData() + slice.offset, slice.length).toDouble(ok) : 0.0;
+    };
+
+    if (instruction.op == Exists) return present(instruction.left);
+    if (instruction.op == Missing) return !present(instruction.left);
+
+    // Any comparison against an absent claim fails, including !=
+    if (!present(instruction.left) || (instruction.right != NO_SLOT && !present(instruction.right))) {
+        return false;
+    }
+
+    if (instruction.op == Contains || instruction.op == NotContains) {
+        const Slice& slice = slices[instruction.left];
+        bool found = valueContains(payload, slice.offset, slice.length, JsonType(slice.type), instruction.text);
+        return instruction.op == Contains ? found : !found;
+    }
+
+    if (instruction.literalKind == NumberLiteral) {
+        bool ok = false;
+        double value = numberAt(instruction.left, &ok);
+        if (ok && instruction.right != NO_SLOT) {
+            value -= numberAt(instruction.right, &ok);
+        }
+        if (!ok) return false;
+
+        switch (instruction.op) {
+        case Equal: return value == instruction.number;
+        case NotEqual: return value != instruction.number;
+        case Less: return value < instruction.number;
+        case LessEqual: return value <= instruction.number;
+        case Greater: return value > instruction.number;
+        case GreaterEqual: return value >= instruction.number;
+        default: return false;
+        }
+    }
+
+    const Slice& slice = slices[instruction.left];
+    bool equal;
+    if (instruction.literalKind == StringLiteral) {
+        equal = JsonType(slice.type) == JsonType::String &&
+                JsonScanner::unescape(payload.constData() + slice.offset + 1, slice.length - 2) == instruction.text;
+    } else {
+        // true / false / null compare against the raw JSON text
+        equal = slice.length == instruction.bare.size() &&
+                std::memcmp(payload.constData() + slice.offset, instruction.bare.constData(), slice.length) == 0;
+    }
+    return instruction.op == Equal ? equal : !equal;
+}
+
+int ClaimRules::evaluate(const QString& idToken, const QString& accessToken) const
+{
+    if (m_program.isEmpty()) return 0;
+
+    m_evaluated.fetch_add(1, std::memory_order_relaxed);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    QByteArray payloads[SourceCount];
+    QVarLengthArray<Slice, 16> slices[SourceCount];
+    const QString* tokens[SourceCount] = {&idToken, &accessToken};
+
+    for (int source = 0; source < SourceCount; ++source) {
+        const QVector<QByteArray>& names = m_claimNames[source];
+        slices[source].resize(names.size());
+        if (names.isEmpty()) continue;
+
+        // Opaque (non-JWT) tokens leave every claim missing
+        QStringList segments = tokens[source]->split('.');
+        if (segments.size() != 3) continue;
+        payloads[source] = QByteArray::fromBase64(segments[1].toLatin1(), QByteArray::Base64UrlEncoding);
+
+        const char* data = payloads[source].constData();
+        int remaining = names.size();
+        Slice* out = slices[source].data();
+        JsonScanner::forEachMember(data, payloads[source].size(),
+            [&](int keyOffset, int keyLength, bool keyEscaped, int valueOffset, int valueLength, JsonType type) {
+                if (keyEscaped) return true;
+                for (int slot = 0; slot < names.size(); ++slot) {
+                    const QByteArray& name = names[slot];
+                    if (name.size() == keyLength && std::memcmp(name.constData(), data + keyOffset, keyLength) == 0) {
+                        out[slot].offset = valueOffset;
+                        out[slot].length = valueLength;
+                        out[slot].type = quint8(type);
+                        --remaining;
+                        break;
+                    }
+                }
+                return remaining > 0;
+            });
+    }
+
+    int violated = 0;
+    for (int rule = 0; rule < m_program.size(); ++rule) {
+        const Instruction& instruction = m_program[rule];
+        if (!check(instruction, payloads[instruction.source], slices[instruction.source].constData(), now)) {
+            m_violations[rule].fetch_add(1, std::memory_order_relaxed);
+            ++violated;
+        }
+    }
+    return violated;
+}
+
+QString ClaimRules::summary() const
+{
+    quint64 total = 0;
+    for (int rule = 0; rule < m_program.size(); ++rule) {
+        total += violations(rule);
+    }
+
+    QString result = QString("Rule violations: %1 across %2 token(s)").arg(total).arg(evaluatedTokens());
+    for (int rule = 0; rule < m_program.size(); ++rule) {
+        result += QString("\n  %1  %2").arg(violations(rule), 8).arg(m_ruleText[rule]);
+    }
+    return result;
+}
@@ -0,0 +1,87 @@
+#ifndef CLAIMRULES_H
+#define CLAIMRULES_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+#include <atomic>
+#include <memory>
+
+// Assertions on token claims, one per line:
+//
+//   acr == "com:imprivata:oidc:epic:sso"
+//   exp - iat <= 3600
+//   exp > now
+//   groups contains "cn=admins,ou=groups,dc=example,dc=com"
+//   access_token: scope contains "openid"
+//   sid exists
+//
+// Operators: == != < <= > >= contains !contains exists missing. The left side
+// is a top-level claim, "claim - claim" or "now"; rules apply to the ID token
+// unless prefixed with "access_token:". "contains" matches array elements or
+// space-separated words (scope, amr). '#' starts a comment.
+//
+// Rules compile once into a flat instruction list plus a per-token table of
+// the claims they reference; evaluation is a single scan of each payload and
+// is safe from any number of threads.
+class ClaimRules
+{
+public:
+    ClaimRules();
+
+    bool compile(const QString& text, QString* error);
+    bool loadFile(const QString& path, QString* error);
+
+    bool isEmpty() const { return m_program.isEmpty(); }
+    int ruleCount() const { return m_program.size(); }
+    QString ruleText(int rule) const { return m_ruleText.value(rule); }
+
+    // Counts violations per rule; returns the number of rules violated
+    int evaluate(const QString& idToken, const QString& accessToken) const;
+
+    quint64 violations(int rule) const { return m_violations[rule].load(std::memory_order_relaxed); }
+    quint64 evaluatedTokens() const { return m_evaluated.load(std::memory_order_relaxed); }
+    void resetCounters();
+
+    // "Rule violations: N of M tokens" followed by one line per rule
+    QString summary() const;
+
+private:
+    enum Op : quint8 { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, Contains, NotContains, Exists, Missing };
+    enum Source : quint8 { IdToken, AccessToken, SourceCount };
+    enum LiteralKind : quint8 { NoLiteral, NumberLiteral, StringLiteral, BareLiteral };
+
+    static const int NOW_SLOT = -2;
+    static const int NO_SLOT = -1;
+
+    struct Instruction
+    {
+        Source source;
+        Op op;
+        int left;
+        int right;              // subtracted from left, NO_SLOT if unused
+        LiteralKind literalKind;
+        double number;
+        QString text;
+        QByteArray bare;
+    };
+
+    struct Slice
+    {
+        int offset = 0;
+        int length = 0;
+        quint8 type = 0;        // JsonType
+    };
+
+    int slotFor(Source source, const QString& claim);
+    bool check(const Instruction& instruction, const QByteArray& payload, const Slice* slices, qint64 now) const;
+
+    QVector<Instruction> m_program;
+    QStringList m_ruleText;
+    QVector<QByteArray> m_claimNames[SourceCount];
+    std::unique_ptr<std::atomic<quint64>[]> m_violations;
+    mutable std::atomic<quint64> m_evaluated;
+};
+
+#endif // CLAIMRULES_H
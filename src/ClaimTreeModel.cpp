@@ -0,0 +1,221 @@
+#include "ClaimTreeModel.h"
+#include "JWTDecoder.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QStringList>
+#include <QFont>
+
+int ClaimTreeModel::Node::totalChildren() const
+{
+    if (value.isObject()) return value.toObject().size();
+    if (value.isArray()) return value.toArray().size();
+    return 0;
+}
+
+ClaimTreeModel::ClaimTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_root(new Node)
+{
+}
+
+ClaimTreeModel::~ClaimTreeModel() = default;
+
+void ClaimTreeModel::setTokens(const QList<QPair<QString, QString>>& tokens)
+{
+    beginResetModel();
+    m_root.reset(new Node);
+
+    // Top-level rows are the tokens themselves, so they are built eagerly;
+    // everything below them is fetched on expansion
+    for (const QPair<QString, QString>& token : tokens) {
+        std::unique_ptr<Node> node(new Node);
+        node->parent = m_root.get();
+        node->row = int(m_root->children.size());
+        node->key = token.first;
+
+        QByteArray header;
+        QByteArray payload;
+        if (JWTDecoder::splitJWT(token.second, &header, &payload)) {
+            QJsonObject parts;
+            parts["header"] = QJsonDocument::fromJson(header).object();
+            parts["payload"] = QJsonDocument::fromJson(payload).object();
+            parts["signature"] = token.second.section('.', 2);
+            node->value = parts;
+        } else {
+            node->value = QString("Invalid JWT format");
+        }
+
+        m_root->children.push_back(std::move(node));
+    }
+
+    endResetModel();
+}
+
+void ClaimTreeModel::clear()
+{
+    setTokens({});
+}
+
+ClaimTreeModel::Node* ClaimTreeModel::nodeFor(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : m_root.get();
+}
+
+QModelIndex ClaimTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    Node* parentNode = nodeFor(parent);
+    if (row < 0 || row >= int(parentNode->children.size()) || column < 0 || column >= ColumnCount) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, parentNode->children[row].get());
+}
+
+QModelIndex ClaimTreeModel::parent(const QModelIndex& child) const
+{
+    Node* node = nodeFor(child);
+    if (!child.isValid() || node->parent == m_root.get()) {
+        return QModelIndex();
+    }
+    return createIndex(node->parent->row, 0, node->parent);
+}
+
+int ClaimTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) return 0;
+    return int(nodeFor(parent)->children.size());
+}
+
+int ClaimTreeModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+bool ClaimTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) return false;
+    Node* node = nodeFor(parent);
+    return !node->children.empty() || node->totalChildren() > 0;
+}
+
+bool ClaimTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid() || parent.column() > 0) return false;
+    Node* node = nodeFor(parent);
+    return int(node->children.size()) < node->totalChildren();
+}
+
+void ClaimTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) return;
+
+    Node* node = nodeFor(parent);
+    const int first = int(node->children.size());
+    const int last = qMin(node->totalChildren(), first + FETCH_BATCH) - 1;
+
+    beginInsertRows(parent, first, last);
+    if (node->value.isObject()) {
+        // Random-access iterator: no keys() list for objects with many members
+        const QJsonObject object = node->value.toObject();
+        for (int i = first; i <= last; ++i) {
+            QJsonObject::const_iterator it = object.constBegin() + i;
+            std::unique_ptr<Node> child(new Node);
+            child->parent = node;
+            child->row = i;
+            child->key = it.key();
+            child->value = it.value();
+            node->children.push_back(std::move(child));
+        }
+    } else {
+        const QJsonArray array = node->value.toArray();
+        for (int i = first; i <= last; ++i) {
+            std::unique_ptr<Node> child(new Node);
+            child->parent = node;
+            child->row = i;
+            child->key = QString("[%1]").arg(i);
+            child->value = array.at(i);
+            node->children.push_back(std::move(child));
+        }
+    }
+    endInsertRows();
+}
+
+QString ClaimTreeModel::displayValue(const Node* node)
+{
+    const QJsonValue& value = node->value;
+    switch (value.type()) {
+    case QJsonValue::String:
+        return QString("\"%1\"").arg(value.toString());
+    case QJsonValue::Double: {
+        QString text = QString::number(value.toDouble(), 'g', 17);
+        static const QStringList timeClaims = {"exp", "iat", "nbf", "auth_time"};
+        if (timeClaims.contains(node->key)) {
+            QDateTime time = QDateTime::fromSecsSinceEpoch(qint64(value.toDouble()), QTimeZone::utc());
+            text += QString(" (%1)").arg(time.toString("yyyy-MM-dd hh:mm:ss 'UTC'"));
+        }
+        return text;
+    }
+    case QJsonValue::Bool:
+        return value.toBool() ? "true" : "false";
+    case QJsonValue::Null:
+        return "null";
+    case QJsonValue::Array:
+        return QString("[%1 items]").arg(value.toArray().size());
+    case QJsonValue::Object:
+        return QString("{%1 members}").arg(value.toObject().size());
+    default:
+        return QString();
+    }
+}
+
+QString ClaimTreeModel::typeName(const QJsonValue& value)
+{
+    switch (value.type()) {
+    case QJsonValue::String: return "string";
+    case QJsonValue::Double: return "number";
+    case QJsonValue::Bool: return "boolean";
+    case QJsonValue::Null: return "null";
+    case QJsonValue::Array: return "array";
+    case QJsonValue::Object: return "object";
+    default: return QString();
+    }
+}
+
+QVariant ClaimTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+
+    const Node* node = nodeFor(index);
+    const bool isToken = node->parent == m_root.get();
+
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
+        switch (index.column()) {
+        case KeyColumn:
+            return node->key;
+        case ValueColumn:
+            return isToken && node->value.isObject() ? QString() : displayValue(node);
+        case TypeColumn:
+            return isToken ? QString() : typeName(node->value);
+        }
+    } else if (role == Qt::FontRole && isToken) {
+        QFont font;
+        font.setBold(true);
+        return font;
+    }
+    return QVariant();
+}
+
+QVariant ClaimTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+
+    switch (section) {
+    case KeyColumn: return "Claim";
+    case ValueColumn: return "Value";
+    case TypeColumn: return "Type";
+    }
+    return QVariant();
+}
@@ -0,0 +1,61 @@
+#ifndef CLAIMTREEMODEL_H
+#define CLAIMTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QJsonValue>
+#include <QList>
+#include <QPair>
+#include <memory>
+#include <vector>
+
+// Tree of decoded JWT header and payload claims for the Tokens tab. Nothing
+// is formatted up front: a node only creates its children when the view
+// expands it, and large arrays or objects are fetched in batches as the
+// view scrolls, so a token with thousands of groups opens instantly and
+// only the rows the user has reached cost memory.
+class ClaimTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { KeyColumn, ValueColumn, TypeColumn, ColumnCount };
+
+    explicit ClaimTreeModel(QObject *parent = nullptr);
+    ~ClaimTreeModel();
+
+    // (label, raw token) pairs; tokens that are not JWTs show as such
+    void setTokens(const QList<QPair<QString, QString>>& tokens);
+    void clear();
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Node
+    {
+        Node* parent = nullptr;
+        int row = 0;
+        QString key;
+        QJsonValue value;
+        std::vector<std::unique_ptr<Node>> children;
+
+        int totalChildren() const;
+    };
+
+    static const int FETCH_BATCH = 256;
+
+    Node* nodeFor(const QModelIndex& index) const;
+    static QString displayValue(const Node* node);
+    static QString typeName(const QJsonValue& value);
+
+    std::unique_ptr<Node> m_root;
+};
+
+#endif // CLAIMTREEMODEL_H
@@ -0,0 +1,247 @@
+#include "ClientAssertion.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+
+static const QByteArray::Base64Options BASE64URL = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+static const char* const ASSERTION_TYPE = "JWT";
+static const int JTI_BYTES = 16;
+
+ClientAssertionPool::ClientAssertionPool(int capacity, int lifetimeSeconds)
+    : m_keyGeneration(0)
+    , m_capacity(qMax(1, capacity))
+    , m_lifetimeSeconds(qMax(2, lifetimeSeconds))
+    , m_taken(0)
+    , m_signedInline(0)
+    , m_expired(0)
+{
+    m_refillThread.setMaxThreadCount(1);
+}
+
+ClientAssertionPool::~ClientAssertionPool()
+{
+    m_refillThread.waitForDone();
+}
+
+ClientAssertionPool* ClientAssertionPool::shared()
+{
+    static ClientAssertionPool pool;
+    return &pool;
+}
+
+bool ClientAssertionPool::setKey(const QString& keyPath, const QString& keyId, QString* error)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_signer && keyPath == m_keyPath && keyId == m_keyId) {
+            return true;
+        }
+    }
+
+    QSharedPointer<JwsSigner> signer(new JwsSigner);
+    if (!signer->loadFile(keyPath, ASSERTION_TYPE, keyId, error)) {
+        return false;
+    }
+
+    // Assertions of the previous key are dropped; a batch in flight notices the new generation
+    QMutexLocker locker(&m_mutex);
+    m_signer = signer;
+    m_keyPath = keyPath;
+    m_keyId = keyId;
+    ++m_keyGeneration;
+    m_ready.clear();
+    return true;
+}
+
+bool ClientAssertionPool::hasKey()
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_signer.isNull();
+}
+
+QString ClientAssertionPool::algorithm()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_signer ? m_signer->algorithm() : QString();
+}
+
+QByteArray ClientAssertionPool::take(const QString& clientID, const QString& audience)
+{
+    const QString poolKey = clientID + '\n' + audience;
+    const qint64 minimumExpiryMs = QDateTime::currentMSecsSinceEpoch() + m_lifetimeSeconds * 1000 / 2;
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_signer) return QByteArray();
+    ++m_taken;
+
+    QQueue<Assertion>& ready = m_ready[poolKey];
+    while (!ready.isEmpty()) {
+        Assertion assertion = ready.dequeue();
+        if (assertion.expiresMs < minimumExpiryMs) {
+            ++m_expired;
+            continue;
+        }
+        if (ready.size() < m_capacity / 2) {
+            scheduleRefill(poolKey);
+        }
+        return assertion.token;
+    }
+
+    // Empty pool: the request pays for one signature
+    ++m_signedInline;
+    QSharedPointer<const JwsSigner> signer = m_signer;
+    scheduleRefill(poolKey);
+    locker.unlock();
+
+    QElapsedTimer wait;
+    wait.start();
+    LatencyHistogram signing;
+    QList<Assertion> batch = signBatch(*signer, poolKey, 1, m_lifetimeSeconds, &signing);
+    const qint64 waitUs = wait.nsecsElapsed() / 1000;
+
+    locker.relock();
+    m_signing.merge(signing);
+    m_inlineWait.record(waitUs);
+    return batch.isEmpty() ? QByteArray() : batch.first().token;
+}
+
+void ClientAssertionPool::prefill(const QString& clientID, const QString& audience)
+{
+    const QString poolKey = clientID + '\n' + audience;
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_signer) return;
+    const int missing = m_capacity - m_ready.value(poolKey).size();
+    if (missing <= 0) return;
+    QSharedPointer<const JwsSigner> signer = m_signer;
+    const quint64 generation = m_keyGeneration;
+    locker.unlock();
+
+    LatencyHistogram signing;
+    QList<Assertion> batch = signBatch(*signer, poolKey, missing, m_lifetimeSeconds, &signing);
+
+    locker.relock();
+    m_signing.merge(signing);
+    if (generation == m_keyGeneration) {
+        m_ready[poolKey].append(batch);
+    }
+}
+
+void ClientAssertionPool::scheduleRefill(const QString& poolKey)
+{
+    // Called with m_mutex held
+    if (m_refillPending.contains(poolKey)) return;
+    m_refillPending.insert(poolKey);
+
+    m_refillThread.start([this, poolKey]() {
+        // Small batches keep the queue fed while a high-rate run drains it
+        static const int REFILL_BATCH = 8;
+
+        forever {
+            QSharedPointer<const JwsSigner> signer;
+            quint64 generation;
+            int missing;
+            {
+                QMutexLocker locker(&m_mutex);
+                missing = m_capacity - m_ready.value(poolKey).size();
+                if (missing <= 0 || !m_signer) {
+                    m_refillPending.remove(poolKey);
+                    return;
+                }
+                signer = m_signer;
+                generation = m_keyGeneration;
+            }
+
+            LatencyHistogram signing;
+            QList<Assertion> batch = signBatch(*signer, poolKey, qMin(missing, REFILL_BATCH),
+                                               m_lifetimeSeconds, &signing);
+
+            QMutexLocker locker(&m_mutex);
+            m_signing.merge(signing);
+            if (generation == m_keyGeneration) {
+                m_ready[poolKey].append(batch);
+            }
+        }
+    });
+}
+
+QByteArray ClientAssertionPool::assertionPayload(const QString& clientID, const QString& audience,
+                                                 const QByteArray& jti, qint64 issuedAt, int lifetimeSeconds)
+{
+    QJsonObject payload;
+    payload["iss"] = clientID;
+    payload["sub"] = clientID;
+    payload["aud"] = audience;
+    payload["jti"] = QString::fromLatin1(jti);
+    payload["iat"] = issuedAt;
+    payload["exp"] = issuedAt + lifetimeSeconds;
+    return QJsonDocument(payload).toJson(QJsonDocument::Compact);
+}
+
+QList<ClientAssertionPool::Assertion> ClientAssertionPool::signBatch(const JwsSigner& signer, const QString& poolKey,
+                                                                   int count, int lifetimeSeconds,
+                                                                   LatencyHistogram* signing)
+{
+    const QString clientID = poolKey.section('\n', 0, 0);
+    const QString audience = poolKey.section('\n', 1);
+
+    // One CSPRNG draw for every jti of the batch
+    QByteArray random(count * JTI_BYTES, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(random.data()),
+                                          random.size() / int(sizeof(quint32)));
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QList<Assertion> batch;
+    batch.reserve(count);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < count; ++i) {
+        const QByteArray jti = random.mid(i * JTI_BYTES, JTI_BYTES).toBase64(BASE64URL);
+
+        timer.start();
+        Assertion assertion;
+        assertion.token = signer.signToken(assertionPayload(clientID, audience, jti, nowMs / 1000, lifetimeSeconds));
+        assertion.expiresMs = (nowMs / 1000 + lifetimeSeconds) * 1000;
+        signing->record(timer.nsecsElapsed() / 1000);
+
+        if (!assertion.token.isEmpty()) {
+            batch.append(assertion);
+        }
+    }
+    return batch;
+}
+
+void ClientAssertionPool::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_taken = 0;
+    m_signedInline = 0;
+    m_expired = 0;
+    m_signing.reset();
+    m_inlineWait.reset();
+}
+
+QString ClientAssertionPool::summary()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QString result = QString("Client assertions (%1): %2 used, %3 pre-signed, %4 signed inline, %5 expired unused; "
+                             "signing p50 %6 ms, p99 %7 ms")
+        .arg(m_signer ? m_signer->algorithm() : QString("no key"))
+        .arg(m_taken)
+        .arg(m_taken - m_signedInline)
+        .arg(m_signedInline)
+        .arg(m_expired)
+        .arg(m_signing.percentile(50) / 1000.0, 0, 'f', 2)
+        .arg(m_signing.percentile(99) / 1000.0, 0, 'f', 2);
+
+    if (m_inlineWait.count() > 0) {
+        result += QString("; inline signing added %1 ms per request on average")
+            .arg(m_inlineWait.mean() / 1000.0, 0, 'f', 2);
+    }
+    return result;
+}
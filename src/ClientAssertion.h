@@ -0,0 +1,76 @@
+#ifndef CLIENTASSERTION_H
+#define CLIENTASSERTION_H
+
+#include "JwsSigner.h"
+#include "LatencyHistogram.h"
+#include <QString>
+#include <QHash>
+#include <QQueue>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include <QSharedPointer>
+
+// private_key_jwt client authentication (RFC 7523, OIDC Core 9). Every token
+// endpoint request needs a fresh assertion with a unique jti, and an RSA
+// signature costs about a millisecond. The pool signs assertions ahead of
+// time on a background thread, per client and audience, so a request only
+// pops one; it signs inline only when the pool is empty. Assertions are valid
+// for a short lifetime and are dropped once less than half of it is left.
+class ClientAssertionPool
+{
+public:
+    explicit ClientAssertionPool(int capacity = 64, int lifetimeSeconds = 60);
+    ~ClientAssertionPool();
+
+    // Process-wide pool shared by all OIDCManager instances
+    static ClientAssertionPool* shared();
+
+    // Parses the key once; loading the same path and kid again is a no-op
+    bool setKey(const QString& keyPath, const QString& keyId, QString* error);
+    bool hasKey();
+    QString algorithm();
+
+    // Signed assertion for client_assertion; empty if no key is loaded
+    QByteArray take(const QString& clientID, const QString& audience);
+
+    // Synchronously fills the pool for one client and audience
+    void prefill(const QString& clientID, const QString& audience);
+
+    void resetStatistics();
+    QString summary();
+
+    // iss = sub = client, aud, jti, iat, exp; compact JSON ready for signing
+    static QByteArray assertionPayload(const QString& clientID, const QString& audience,
+                                       const QByteArray& jti, qint64 issuedAt, int lifetimeSeconds);
+
+private:
+    struct Assertion
+    {
+        QByteArray token;
+        qint64 expiresMs = 0;
+    };
+
+    static QList<Assertion> signBatch(const JwsSigner& signer, const QString& poolKey, int count,
+                                      int lifetimeSeconds, LatencyHistogram* signing);
+    void scheduleRefill(const QString& poolKey);
+
+    QMutex m_mutex;
+    QSharedPointer<const JwsSigner> m_signer;
+    QString m_keyPath;
+    QString m_keyId;
+    quint64 m_keyGeneration;
+    QHash<QString, QQueue<Assertion>> m_ready;
+    QSet<QString> m_refillPending;
+    QThreadPool m_refillThread;
+    int m_capacity;
+    int m_lifetimeSeconds;
+
+    quint64 m_taken;
+    quint64 m_signedInline;
+    quint64 m_expired;
+    LatencyHistogram m_signing;
+    LatencyHistogram m_inlineWait;
+};
+
+#endif // CLIENTASSERTION_H
@@ -0,0 +1,123 @@
+#include "DiscoveryCache.h"
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+
+static const char* ISSUER_PROPERTY = "issuerURL";
+
+DiscoveryCache::DiscoveryCache(QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_maxAgeMs(60 * 60 * 1000)
+{
+}
+
+QString DiscoveryCache::normalize(const QString& issuerURL)
+{
+    QString issuer = issuerURL.trimmed();
+    while (issuer.endsWith('/')) {
+        issuer.chop(1);
+    }
+    return issuer;
+}
+
+const DiscoveryCache::Entry* DiscoveryCache::freshEntry(const QString& issuerURL) const
+{
+    auto it = m_entries.constFind(normalize(issuerURL));
+    if (it == m_entries.constEnd() || it->age.hasExpired(m_maxAgeMs)) {
+        return nullptr;
+    }
+    return &it.value();
+}
+
+void DiscoveryCache::prefetch(const QStringList& issuerURLs)
+{
+    for (const QString& issuerURL : issuerURLs) {
+        QString issuer = normalize(issuerURL);
+        if (issuer.isEmpty() || freshEntry(issuer) || m_inFlight.contains(issuer)) {
+            continue;
+        }
+
+        m_inFlight[issuer].start();
+        QNetworkReply* reply = m_networkManager->get(QNetworkRequest(QUrl(issuer + "/.well-known/openid-configuration")));
+        reply->setProperty(ISSUER_PROPERTY, issuer);
+        connect(reply, &QNetworkReply::finished, this, &DiscoveryCache::onDiscoveryFinished);
+    }
+}
+
+void DiscoveryCache::onDiscoveryFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+
+    reply->deleteLater();
+    QString issuer = reply->property(ISSUER_PROPERTY).toString();
+
+    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+    if (reply->error() != QNetworkReply::NoError || !doc.isObject()) {
+        qint64 elapsedMs = m_inFlight.take(issuer).elapsed();
+        emit logMessage(QString("Discovery prefetch failed for %1: %2").arg(issuer, reply->errorString()));
+        emit prefetchFinished(issuer, false, elapsedMs);
+        return;
+    }
+
+    store(issuer, doc.object());
+
+    QString jwksURI = doc.object()["jwks_uri"].toString();
+    if (jwksURI.isEmpty()) {
+        qint64 elapsedMs = m_inFlight.take(issuer).elapsed();
+        emit prefetchFinished(issuer, true, elapsedMs);
+        return;
+    }
+
+    QNetworkReply* jwksReply = m_networkManager->get(QNetworkRequest(QUrl(jwksURI)));
+    jwksReply->setProperty(ISSUER_PROPERTY, issuer);
+    connect(jwksReply, &QNetworkReply::finished, this, &DiscoveryCache::onJwksFinished);
+}
+
+void DiscoveryCache::onJwksFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+
+    reply->deleteLater();
+    QString issuer = reply->property(ISSUER_PROPERTY).toString();
+    qint64 elapsedMs = m_inFlight.take(issuer).elapsed();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        emit logMessage(QString("JWKS prefetch failed for %1: %2").arg(issuer, reply->errorString()));
+        emit prefetchFinished(issuer, false, elapsedMs);
+        return;
+    }
+
+    if (m_entries.contains(issuer)) {
+        m_entries[issuer].jwks = reply->readAll();
+    }
+
+    emit logMessage(QString("Prefetched discovery and JWKS for %1 in %2 ms").arg(issuer).arg(elapsedMs));
+    emit prefetchFinished(issuer, true, elapsedMs);
+}
+
+bool DiscoveryCache::lookup(const QString& issuerURL, QJsonObject* document) const
+{
+    const Entry* entry = freshEntry(issuerURL);
+    if (!entry) return false;
+
+    if (document) {
+        *document = entry->discovery;
+    }
+    return true;
+}
+
+QByteArray DiscoveryCache::jwks(const QString& issuerURL) const
+{
+    const Entry* entry = freshEntry(issuerURL);
+    return entry ? entry->jwks : QByteArray();
+}
+
+void DiscoveryCache::store(const QString& issuerURL, const QJsonObject& document)
+{
+    Entry& entry = m_entries[normalize(issuerURL)];
+    entry.discovery = document;
+    entry.age.start();
+}
@@ -0,0 +1,61 @@
+#ifndef DISCOVERYCACHE_H
+#define DISCOVERYCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QJsonObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+
+// Discovery documents and JWKS keyed by issuer URL. prefetch() issues all
+// discovery requests at once and chains each JWKS fetch off its discovery
+// reply, so a dozen issuers cost roughly one round trip pair instead of a
+// dozen. Entries expire after maxAgeMs. Not thread-safe; use from the thread
+// that owns it.
+class DiscoveryCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DiscoveryCache(QObject *parent = nullptr);
+
+    void prefetch(const QStringList& issuerURLs);
+
+    bool lookup(const QString& issuerURL, QJsonObject* document) const;
+    QByteArray jwks(const QString& issuerURL) const;
+
+    // Stores a document fetched elsewhere (e.g. by a flow that missed)
+    void store(const QString& issuerURL, const QJsonObject& document);
+    void clear() { m_entries.clear(); }
+
+    void setMaxAge(qint64 maxAgeMs) { m_maxAgeMs = maxAgeMs; }
+
+signals:
+    void prefetchFinished(const QString& issuerURL, bool success, qint64 elapsedMs);
+    void logMessage(const QString& message);
+
+private slots:
+    void onDiscoveryFinished();
+    void onJwksFinished();
+
+private:
+    struct Entry
+    {
+        QJsonObject discovery;
+        QByteArray jwks;
+        QElapsedTimer age;
+    };
+
+    static QString normalize(const QString& issuerURL);
+    const Entry* freshEntry(const QString& issuerURL) const;
+
+    QNetworkAccessManager* m_networkManager;
+    QHash<QString, Entry> m_entries;
+    QHash<QString, QElapsedTimer> m_inFlight;
+    qint64 m_maxAgeMs;
+};
+
+#endif // DISCOVERYCACHE_H
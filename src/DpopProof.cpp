@@ -0,0 +1,74 @@
+#include "DpopProof.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+
+static const QByteArray::Base64Options BASE64URL = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+static const int JTI_WORDS = 4;   // 128-bit jti
+
+bool DpopProofFactory::generateKey(QString* error)
+{
+    m_thumbprint.clear();
+    if (!m_signer.generateP256("dpop+jwt", error)) {
+        return false;
+    }
+    m_thumbprint = m_signer.jwkThumbprint();
+    return true;
+}
+
+QString DpopProofFactory::serverOf(const QUrl& url)
+{
+    return url.adjusted(QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment | QUrl::RemoveUserInfo).toString();
+}
+
+void DpopProofFactory::setNonce(const QUrl& url, const QByteArray& nonce)
+{
+    m_nonces.insert(serverOf(url), nonce);
+}
+
+QByteArray DpopProofFactory::nonce(const QUrl& url) const
+{
+    return m_nonces.value(serverOf(url));
+}
+
+QByteArray DpopProofFactory::proof(const QByteArray& method, const QUrl& url, const QString& accessToken)
+{
+    if (!hasKey()) return QByteArray();
+
+    quint32 random[JTI_WORDS];
+    QRandomGenerator::system()->fillRange(random);
+    const QByteArray jti = QByteArray(reinterpret_cast<const char*>(random), sizeof(random)).toBase64(BASE64URL);
+
+    return m_signer.signToken(payload(method, url, QDateTime::currentSecsSinceEpoch(), jti, nonce(url), accessToken));
+}
+
+QByteArray DpopProofFactory::payload(const QByteArray& method, const QUrl& url, qint64 issuedAt,
+                                     const QByteArray& jti, const QByteArray& nonce, const QString& accessToken)
+{
+    // htm and htu (the URL without query and fragment) only vary per endpoint
+    const QString endpoint = QString::fromLatin1(method) + ' ' + url.toString(QUrl::RemoveQuery | QUrl::RemoveFragment);
+    QByteArray& prefix = m_payloadPrefixes[endpoint];
+    if (prefix.isEmpty()) {
+        QJsonObject fixed;
+        fixed["htm"] = QString::fromLatin1(method);
+        fixed["htu"] = url.toString(QUrl::RemoveQuery | QUrl::RemoveFragment | QUrl::FullyEncoded);
+        prefix = QJsonDocument(fixed).toJson(QJsonDocument::Compact);
+        prefix.chop(1);   // closing brace
+    }
+
+    // jti, nonce and ath are base64url or RFC 9449 NQCHAR, so they need no JSON escaping
+    QByteArray result = prefix;
+    result += ",\"iat\":" + QByteArray::number(issuedAt) + ",\"jti\":\"" + jti + '"';
+    if (!nonce.isEmpty()) {
+        result += ",\"nonce\":\"" + nonce + '"';
+    }
+    if (!accessToken.isEmpty()) {
+        result += ",\"ath\":\"" + QCryptographicHash::hash(accessToken.toLatin1(), QCryptographicHash::Sha256)
+                                      .toBase64(BASE64URL) + '"';
+    }
+    result += '}';
+    return result;
+}
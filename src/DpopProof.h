@@ -0,0 +1,47 @@
+#ifndef DPOPPROOF_H
+#define DPOPPROOF_H
+
+#include "JwsSigner.h"
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QUrl>
+
+// DPoP proofs (RFC 9449) from one ephemeral P-256 key. The protected header
+// (typ, alg, jwk) is encoded once per key and the fixed payload part once per
+// method and URL, so each proof costs a jti draw, one small base64 encode and
+// one ES256 signature. Not thread-safe; each OIDCManager keeps its own.
+class DpopProofFactory
+{
+public:
+    DpopProofFactory() = default;
+
+    // New key; tokens bound to the previous one can no longer be used
+    bool generateKey(QString* error);
+    bool hasKey() const { return !m_signer.isNull(); }
+
+    // jkt: thumbprint of the public key, for dpop_jkt in authorization requests
+    QByteArray thumbprint() const { return m_thumbprint; }
+
+    // Proof for one request; with an access token also its ath hash (resource
+    // requests). Includes the latest nonce of the URL's server, if any.
+    QByteArray proof(const QByteArray& method, const QUrl& url, const QString& accessToken = QString());
+
+    // DPoP-Nonce values are per server (scheme, host and port)
+    void setNonce(const QUrl& url, const QByteArray& nonce);
+    QByteArray nonce(const QUrl& url) const;
+
+    // Payload with the given claims, as proof() builds it
+    QByteArray payload(const QByteArray& method, const QUrl& url, qint64 issuedAt,
+                       const QByteArray& jti, const QByteArray& nonce, const QString& accessToken);
+
+private:
+    static QString serverOf(const QUrl& url);
+
+    JwsSigner m_signer;
+    QByteArray m_thumbprint;
+    QHash<QString, QByteArray> m_payloadPrefixes;
+    QHash<QString, QByteArray> m_nonces;
+};
+
+#endif // DPOPPROOF_H
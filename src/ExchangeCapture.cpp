@@ -0,0 +1,121 @@
+#include "ExchangeCapture.h"
+#include <QMutexLocker>
+
+static const quint32 CAPTURE_MAGIC = 0x4F434150; // "OCAP"
+static const quint16 CAPTURE_VERSION = 1;
+
+// Bodies above this size are stored zlib-compressed
+static const int COMPRESS_THRESHOLD = 256;
+
+static void writeBody(QDataStream& stream, const QByteArray& body)
+{
+    bool compress = body.size() > COMPRESS_THRESHOLD;
+    stream << quint8(compress ? 1 : 0) << (compress ? qCompress(body) : body);
+}
+
+static QByteArray readBody(QDataStream& stream)
+{
+    quint8 compressed;
+    QByteArray body;
+    stream >> compressed >> body;
+    return compressed ? qUncompress(body) : body;
+}
+
+ExchangeRecorder::ExchangeRecorder()
+    : m_count(0)
+{
+}
+
+ExchangeRecorder::~ExchangeRecorder()
+{
+    close();
+}
+
+bool ExchangeRecorder::open(const QString& path, QString* error)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *error = QString("Failed to open capture file %1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(QDataStream::Qt_6_0);
+    m_stream << CAPTURE_MAGIC << CAPTURE_VERSION;
+
+    m_count = 0;
+    m_clock.start();
+    return true;
+}
+
+void ExchangeRecorder::close()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_file.isOpen()) {
+        m_file.close();
+        m_stream.setDevice(nullptr);
+    }
+}
+
+void ExchangeRecorder::record(const CapturedExchange& exchange)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_file.isOpen()) return;
+
+    m_stream << quint8(exchange.kind)
+             << exchange.startOffsetMs
+             << exchange.durationMs
+             << exchange.method
+             << exchange.url;
+    writeBody(m_stream, exchange.requestBody);
+    m_stream << exchange.status << exchange.contentType;
+    writeBody(m_stream, exchange.responseBody);
+
+    // Keep the file usable if the process dies mid-run
+    m_file.flush();
+    ++m_count;
+}
+
+bool ExchangeRecorder::load(const QString& path, QList<CapturedExchange>* exchanges, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Failed to open capture file %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic;
+    quint16 version;
+    stream >> magic >> version;
+    if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION) {
+        *error = QString("%1 is not an OIDC Tester capture file (or has an unsupported version)").arg(path);
+        return false;
+    }
+
+    exchanges->clear();
+    while (!stream.atEnd()) {
+        CapturedExchange exchange;
+        quint8 kind;
+        stream >> kind >> exchange.startOffsetMs >> exchange.durationMs >> exchange.method >> exchange.url;
+        exchange.requestBody = readBody(stream);
+        stream >> exchange.status >> exchange.contentType;
+        exchange.responseBody = readBody(stream);
+
+        if (stream.status() != QDataStream::Ok) {
+            // A truncated trailing record is expected if the recording process was killed
+            break;
+        }
+
+        exchange.kind = static_cast<CapturedExchange::Kind>(kind);
+        exchanges->append(exchange);
+    }
+
+    return true;
+}
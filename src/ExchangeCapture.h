@@ -0,0 +1,62 @@
+#ifndef EXCHANGECAPTURE_H
+#define EXCHANGECAPTURE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QFile>
+#include <QDataStream>
+#include <QMutex>
+#include <QElapsedTimer>
+
+// One HTTP exchange performed (or, for callbacks, received) during a flow
+struct CapturedExchange
+{
+    enum Kind : quint8 {
+        Discovery = 0,
+        Callback = 1,
+        Token = 2
+    };
+
+    Kind kind = Discovery;
+    qint64 startOffsetMs = 0;   // since the capture was opened
+    qint32 durationMs = 0;      // request sent -> response finished (authorize -> callback for
+                                // scripted callbacks, 0 for browser callbacks)
+    QByteArray method;
+    QByteArray url;
+    QByteArray requestBody;
+    qint32 status = 0;
+    QByteArray contentType;
+    QByteArray responseBody;
+};
+
+// Append-only binary capture file of the exchanges OIDCManager performs.
+// Records are written as they happen; large bodies are zlib-compressed.
+// Safe to share between managers on different threads.
+class ExchangeRecorder
+{
+public:
+    ExchangeRecorder();
+    ~ExchangeRecorder();
+
+    bool open(const QString& path, QString* error);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // Milliseconds since the capture was opened, for CapturedExchange::startOffsetMs
+    qint64 elapsedMs() const { return m_clock.elapsed(); }
+
+    void record(const CapturedExchange& exchange);
+    int recordedCount() const { return m_count; }
+
+    static bool load(const QString& path, QList<CapturedExchange>* exchanges, QString* error);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+    int m_count;
+};
+
+#endif // EXCHANGECAPTURE_H
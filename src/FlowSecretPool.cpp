@@ -0,0 +1,129 @@
+#include "FlowSecretPool.h"
+#include <QRandomGenerator>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+
+// Random bytes consumed per tuple: 8 for state, 16 for nonce, 32 for the PKCE verifier
+static const int STATE_BYTES = 8;
+static const int NONCE_BYTES = 16;
+static const int VERIFIER_BYTES = 32;
+static const int TUPLE_BYTES = STATE_BYTES + NONCE_BYTES + VERIFIER_BYTES;
+
+static_assert(TUPLE_BYTES % sizeof(quint32) == 0, "tuple must be a whole number of 32-bit words");
+
+FlowSecretPool::FlowSecretPool(int capacity, int batchSize)
+    : m_refillPending(false)
+    , m_capacity(qMax(1, capacity))
+    , m_batchSize(qBound(1, batchSize, m_capacity))
+{
+    m_refillThread.setMaxThreadCount(1);
+}
+
+FlowSecretPool::~FlowSecretPool()
+{
+    m_refillThread.waitForDone();
+}
+
+FlowSecretPool* FlowSecretPool::shared()
+{
+    static FlowSecretPool pool;
+    return &pool;
+}
+
+FlowSecrets FlowSecretPool::take()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_ready.isEmpty()) {
+        // Cold pool: pay for one batch inline rather than waiting on the refill thread
+        locker.unlock();
+        QList<FlowSecrets> batch = generateBatch(m_batchSize);
+        locker.relock();
+        m_ready.append(batch);
+    }
+
+    FlowSecrets secrets = m_ready.dequeue();
+
+    if (m_ready.size() < m_capacity / 2) {
+        scheduleRefill();
+    }
+
+    return secrets;
+}
+
+void FlowSecretPool::prefill()
+{
+    int missing;
+    {
+        QMutexLocker locker(&m_mutex);
+        missing = m_capacity - m_ready.size();
+    }
+    if (missing <= 0) return;
+
+    QList<FlowSecrets> batch = generateBatch(missing);
+
+    QMutexLocker locker(&m_mutex);
+    m_ready.append(batch);
+}
+
+int FlowSecretPool::available()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_ready.size();
+}
+
+void FlowSecretPool::scheduleRefill()
+{
+    // Called with m_mutex held
+    if (m_refillPending) return;
+    m_refillPending = true;
+
+    m_refillThread.start([this]() {
+        forever {
+            int missing;
+            {
+                QMutexLocker locker(&m_mutex);
+                missing = m_capacity - m_ready.size();
+                if (missing <= 0) {
+                    m_refillPending = false;
+                    return;
+                }
+            }
+
+            QList<FlowSecrets> batch = generateBatch(qMin(missing, m_batchSize));
+
+            QMutexLocker locker(&m_mutex);
+            m_ready.append(batch);
+        }
+    });
+}
+
+QList<FlowSecrets> FlowSecretPool::generateBatch(int count)
+{
+    // One CSPRNG draw for the whole batch
+    QByteArray random(count * TUPLE_BYTES, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(random.data()),
+                                          random.size() / int(sizeof(quint32)));
+
+    QList<FlowSecrets> batch;
+    batch.reserve(count);
+
+    const QByteArray::Base64Options base64URL = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+    for (int i = 0; i < count; ++i) {
+        const char* tuple = random.constData() + i * TUPLE_BYTES;
+
+        FlowSecrets secrets;
+        secrets.state = QString::fromLatin1(QByteArray(tuple, STATE_BYTES).toHex());
+        secrets.nonce = QString::fromLatin1(QByteArray(tuple + STATE_BYTES, NONCE_BYTES).toBase64(base64URL));
+
+        QByteArray verifier = QByteArray(tuple + STATE_BYTES + NONCE_BYTES, VERIFIER_BYTES).toBase64(base64URL);
+        secrets.codeVerifier = QString::fromLatin1(verifier);
+        secrets.codeChallenge = QString::fromLatin1(
+            QCryptographicHash::hash(verifier, QCryptographicHash::Sha256).toBase64(base64URL));
+
+        batch.append(secrets);
+    }
+
+    return batch;
+}
@@ -0,0 +1,51 @@
+#ifndef FLOWSECRETPOOL_H
+#define FLOWSECRETPOOL_H
+
+#include <QString>
+#include <QList>
+#include <QQueue>
+#include <QMutex>
+#include <QThreadPool>
+
+// Per-flow random values: CSRF state, ID token nonce and the PKCE pair
+struct FlowSecrets
+{
+    QString state;
+    QString nonce;
+    QString codeVerifier;
+    QString codeChallenge;
+};
+
+// Thread-safe pool of ready FlowSecrets. Batches are generated from a single
+// CSPRNG draw and refilled on a background thread once the pool runs low, so
+// starting a flow is just a pop.
+class FlowSecretPool
+{
+public:
+    explicit FlowSecretPool(int capacity = 256, int batchSize = 64);
+    ~FlowSecretPool();
+
+    // Process-wide pool shared by all OIDCManager instances
+    static FlowSecretPool* shared();
+
+    FlowSecrets take();
+
+    // Synchronously fills the pool to capacity, e.g. before a load run
+    void prefill();
+
+    int available();
+
+    static QList<FlowSecrets> generateBatch(int count);
+
+private:
+    void scheduleRefill();
+
+    QMutex m_mutex;
+    QQueue<FlowSecrets> m_ready;
+    QThreadPool m_refillThread;
+    bool m_refillPending;
+    int m_capacity;
+    int m_batchSize;
+};
+
+#endif // FLOWSECRETPOOL_H
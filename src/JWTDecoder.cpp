@@ -19,6 +19,23 @@ QByteArray JWTDecoder::decodeBase64URLSafe(const QString& input)
     return QByteArray::fromBase64(base64.toUtf8());
 }
 
+bool JWTDecoder::splitJWT(const QString& token, QByteArray* header, QByteArray* payload)
+{
+    int first = token.indexOf('.');
+    int second = first < 0 ? -1 : token.indexOf('.', first + 1);
+    if (second < 0 || token.indexOf('.', second + 1) >= 0) {
+        return false;
+    }
+
+    if (header) {
+        *header = decodeBase64URLSafe(token.left(first));
+    }
+    if (payload) {
+        *payload = decodeBase64URLSafe(token.mid(first + 1, second - first - 1));
+    }
+    return true;
+}
+
 QString JWTDecoder::decodeJWT(const QString& token)
 {
     QStringList segments = token.split('.');
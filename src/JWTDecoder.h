@@ -9,9 +9,12 @@ class JWTDecoder
 public:
     static QString decodeJWT(const QString& token);
     static QString formatTokenDetails(const QString& token);
+    static QByteArray decodeBase64URLSafe(const QString& input);
+
+    // Decodes the header and payload segments; false if not a three-part JWT
+    static bool splitJWT(const QString& token, QByteArray* header, QByteArray* payload);
     
 private:
-    static QByteArray decodeBase64URLSafe(const QString& input);
     static QString formatJSON(const QJsonObject& json, const QString& indent = "  ");
 };
 
@@ -0,0 +1,314 @@
+#include "JsonScanner.h"
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <atomic>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static std::atomic<int> s_defaultBackend(JsonObjectView::QtBackend);
+
+int JsonScanner::skipString(const char* data, int pos, int size, bool* escaped)
+{
+    ++pos;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+#endif
+    while (pos < size) {
+#if defined(__SSE2__)
+        // Jump to the next quote or backslash 16 bytes at a time
+        while (pos + 16 <= size) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                      _mm_cmpeq_epi8(chunk, backslash)));
+            if (mask) {
+                pos += qCountTrailingZeroBits(quint32(mask));
+                break;
+            }
+            pos += 16;
+        }
+        if (pos >= size) break;
+#endif
+        if (data[pos] == '"') {
+            return pos + 1;
+        }
+        if (data[pos] == '\\') {
+            *escaped = true;
+            pos += 2;
+        } else {
+            ++pos;
+        }
+    }
+    return -1;
+}
+
+int JsonScanner::skipValue(const char* data, int pos, int size, JsonType* type)
+{
+    bool escaped = false;
+    switch (data[pos]) {
+    case '"':
+        *type = JsonType::String;
+        return skipString(data, pos, size, &escaped);
+    case '{':
+    case '[': {
+        *type = data[pos] == '{' ? JsonType::Object : JsonType::Array;
+#if defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i openBrace = _mm_set1_epi8('{');
+        const __m128i closeBrace = _mm_set1_epi8('}');
+        const __m128i openBracket = _mm_set1_epi8('[');
+        const __m128i closeBracket = _mm_set1_epi8(']');
+#endif
+        int depth = 0;
+        while (pos < size) {
+#if defined(__SSE2__)
+            // Only quotes and brackets matter inside a skipped container
+            while (pos + 16 <= size) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                         _mm_cmpeq_epi8(chunk, openBrace)),
+                                            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, closeBrace),
+                                                                      _mm_cmpeq_epi8(chunk, openBracket)),
+                                                         _mm_cmpeq_epi8(chunk, closeBracket)));
+                int mask = _mm_movemask_epi8(hits);
+                if (mask) {
+                    pos += qCountTrailingZeroBits(quint32(mask));
+                    break;
+                }
+                pos += 16;
+            }
+            if (pos >= size) break;
+#endif
+            char c = data[pos];
+            if (c == '"') {
+                pos = skipString(data, pos, size, &escaped);
+                if (pos < 0) return -1;
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return pos + 1;
+            }
+            ++pos;
+        }
+        return -1;
+    }
+    case 't':
+        *type = JsonType::Bool;
+        return skipLiteral(data, pos, size, "true", 4);
+    case 'f':
+        *type = JsonType::Bool;
+        return skipLiteral(data, pos, size, "false", 5);
+    case 'n':
+        *type = JsonType::Null;
+        return skipLiteral(data, pos, size, "null", 4);
+    default:
+        *type = JsonType::Number;
+        return skipNumber(data, pos, size);
+    }
+}
+
+int JsonScanner::skipLiteral(const char* data, int pos, int size, const char* literal, int length)
+{
+    if (size - pos < length || std::memcmp(data + pos, literal, length) != 0) return -1;
+    return pos + length;
+}
+
+int JsonScanner::skipNumber(const char* data, int pos, int size)
+{
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    auto isDigit = [data, size](int at) { return at < size && data[at] >= '0' && data[at] <= '9'; };
+
+    if (pos < size && data[pos] == '-') ++pos;
+    if (!isDigit(pos)) return -1;
+    if (data[pos] == '0') {
+        ++pos;
+    } else {
+        while (isDigit(pos)) ++pos;
+    }
+
+    if (pos < size && data[pos] == '.') {
+        ++pos;
+        if (!isDigit(pos)) return -1;
+        while (isDigit(pos)) ++pos;
+    }
+
+    if (pos < size && (data[pos] == 'e' || data[pos] == 'E')) {
+        ++pos;
+        if (pos < size && (data[pos] == '+' || data[pos] == '-')) ++pos;
+        if (!isDigit(pos)) return -1;
+        while (isDigit(pos)) ++pos;
+    }
+    return pos;
+}
+
+QString JsonScanner::unescape(const char* data, int length)
+{
+    const char* backslash = static_cast<const char*>(std::memchr(data, '\\', length));
+    if (!backslash) {
+        return QString::fromUtf8(data, length);
+    }
+
+    QString result;
+    result.reserve(length);
+    int runStart = 0;
+    int pos = int(backslash - data);
+    while (pos < length) {
+        if (data[pos] != '\\') {
+            ++pos;
+            continue;
+        }
+
+        result += QString::fromUtf8(data + runStart, pos - runStart);
+        if (pos + 1 >= length) break;
+
+        char escape = data[pos + 1];
+        pos += 2;
+        switch (escape) {
+        case 'b': result += QChar('\b'); break;
+        case 'f': result += QChar('\f'); break;
+        case 'n': result += QChar('\n'); break;
+        case 'r': result += QChar('\r'); break;
+        case 't': result += QChar('\t'); break;
+        case 'u':
+            // Surrogate pairs arrive as two escapes and combine naturally in UTF-16
+            if (pos + 4 <= length) {
+                bool ok = false;
+                ushort code = QByteArray::fromRawData(data + pos, 4).toUShort(&ok, 16);
+                if (ok) {
+                    result += QChar(code);
+                }
+                pos += 4;
+            }
+            break;
+        default:
+            result += QLatin1Char(escape);
+            break;
+        }
+        runStart = pos;
+    }
+    if (runStart < length) {
+        result += QString::fromUtf8(data + runStart, length - runStart);
+    }
+    return result;
+}
+
+JsonObjectView::Backend JsonObjectView::defaultBackend()
+{
+    return Backend(s_defaultBackend.load(std::memory_order_relaxed));
+}
+
+void JsonObjectView::setDefaultBackend(Backend backend)
+{
+    s_defaultBackend.store(backend, std::memory_order_relaxed);
+}
+
+JsonObjectView::JsonObjectView()
+    : m_onDemand(false)
+    , m_valid(false)
+{
+}
+
+JsonObjectView::JsonObjectView(const QByteArray& json)
+    : JsonObjectView(json, defaultBackend())
+{
+}
+
+JsonObjectView::JsonObjectView(const QByteArray& json, Backend backend)
+    : m_data(json)
+    , m_onDemand(backend == OnDemandBackend)
+    , m_valid(false)
+{
+    if (!m_onDemand) {
+        QJsonDocument doc = QJsonDocument::fromJson(json);
+        m_valid = doc.isObject();
+        m_object = doc.object();
+        return;
+    }
+
+    m_valid = JsonScanner::forEachMember(m_data.constData(), m_data.size(),
+        [this](int keyOffset, int keyLength, bool keyEscaped, int valueOffset, int valueLength, JsonType type) {
+            if (!keyEscaped) {
+                m_members.append({keyOffset, keyLength, valueOffset, valueLength, type});
+            }
+            return true;
+        });
+}
+
+JsonObjectView::JsonObjectView(const QJsonObject& object)
+    : m_object(object)
+    , m_onDemand(false)
+    , m_valid(true)
+{
+}
+
+const JsonObjectView::Member* JsonObjectView::find(QLatin1String key) const
+{
+    // Searched from the end: with duplicate names the last one wins, as in QJsonDocument
+    const char* data = m_data.constData();
+    for (int i = m_members.size() - 1; i >= 0; --i) {
+        const Member& member = m_members[i];
+        if (member.keyLength == key.size() && std::memcmp(data + member.keyOffset, key.data(), key.size()) == 0) {
+            return &member;
+        }
+    }
+    return nullptr;
+}
+
+bool JsonObjectView::contains(QLatin1String key) const
+{
+    return m_onDemand ? find(key) != nullptr : m_object.contains(key);
+}
+
+JsonType JsonObjectView::type(QLatin1String key) const
+{
+    if (m_onDemand) {
+        const Member* member = find(key);
+        return member ? member->type : JsonType::Missing;
+    }
+
+    switch (m_object.value(key).type()) {
+    case QJsonValue::String: return JsonType::String;
+    case QJsonValue::Double: return JsonType::Number;
+    case QJsonValue::Bool: return JsonType::Bool;
+    case QJsonValue::Null: return JsonType::Null;
+    case QJsonValue::Array: return JsonType::Array;
+    case QJsonValue::Object: return JsonType::Object;
+    default: return JsonType::Missing;
+    }
+}
+
+QString JsonObjectView::string(QLatin1String key) const
+{
+    if (!m_onDemand) {
+        return m_object.value(key).toString();
+    }
+
+    const Member* member = find(key);
+    if (!member || member->type != JsonType::String) return QString();
+    return JsonScanner::unescape(m_data.constData() + member->valueOffset + 1, member->valueLength - 2);
+}
+
+qint64 JsonObjectView::integer(QLatin1String key, qint64 defaultValue) const
+{
+    if (!m_onDemand) {
+        QJsonValue value = m_object.value(key);
+        return value.isDouble() ? qint64(value.toDouble()) : defaultValue;
+    }
+
+    const Member* member = find(key);
+    if (!member || member->type != JsonType::Number) return defaultValue;
+
+    bool ok = false;
+    double value = QByteArray::fromRawData(m_data.constData() + member->valueOffset, member->valueLength).toDouble(&ok);
+    return ok ? qint64(value) : defaultValue;
+}
+
+QJsonObject JsonObjectView::toJsonObject() const
+{
+    if (!m_onDemand) return m_object;
+    return QJsonDocument::fromJson(m_data).object();
+}
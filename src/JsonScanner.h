@@ -0,0 +1,135 @@
+#ifndef JSONSCANNER_H
+#define JSONSCANNER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QJsonObject>
+#include <QLatin1String>
+#include <QVarLengthArray>
+
+enum class JsonType : quint8 { Missing, String, Number, Bool, Null, Array, Object };
+
+// Forward-only JSON scanning primitives. Strings and nested containers are
+// skipped 16 bytes at a time with SSE2 where available; nothing is allocated.
+// Offsets are byte positions in the input, -1 signals malformed input.
+class JsonScanner
+{
+public:
+    static inline int skipWhitespace(const char* data, int pos, int size)
+    {
+        while (pos < size && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\n' || data[pos] == '\r')) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    // pos is on the opening quote; returns the index after the closing quote
+    static int skipString(const char* data, int pos, int size, bool* escaped);
+
+    // Skips one value of any kind and reports its type. Literals and numbers
+    // are checked against the JSON grammar; containers only for balance.
+    static int skipValue(const char* data, int pos, int size, JsonType* type);
+
+    // Decodes the contents of a string value (without the quotes)
+    static QString unescape(const char* data, int length);
+
+    // Walks the members of a top-level object, calling
+    // visit(keyStart, keyLength, keyEscaped, valueStart, valueLength, type)
+    // until it returns false. Returns false only for malformed input; once
+    // the visitor stops, the rest of the input is not checked.
+    template <typename Visitor>
+    static bool forEachMember(const char* data, int size, Visitor visit);
+
+private:
+    static int skipLiteral(const char* data, int pos, int size, const char* literal, int length);
+    static int skipNumber(const char* data, int pos, int size);
+};
+
+template <typename Visitor>
+bool JsonScanner::forEachMember(const char* data, int size, Visitor visit)
+{
+    int pos = skipWhitespace(data, 0, size);
+    if (pos >= size || data[pos] != '{') return false;
+    pos = skipWhitespace(data, pos + 1, size);
+    if (pos < size && data[pos] == '}') return skipWhitespace(data, pos + 1, size) == size;
+
+    while (pos < size) {
+        if (data[pos] != '"') return false;
+
+        bool escaped = false;
+        int keyStart = pos + 1;
+        int keyEnd = skipString(data, pos, size, &escaped);
+        if (keyEnd < 0) return false;
+
+        pos = skipWhitespace(data, keyEnd, size);
+        if (pos >= size || data[pos] != ':') return false;
+        pos = skipWhitespace(data, pos + 1, size);
+        if (pos >= size) return false;
+
+        JsonType type;
+        int valueEnd = skipValue(data, pos, size, &type);
+        if (valueEnd < 0) return false;
+
+        if (!visit(keyStart, keyEnd - 1 - keyStart, escaped, pos, valueEnd - pos, type)) {
+            return true;
+        }
+
+        pos = skipWhitespace(data, valueEnd, size);
+        if (pos >= size) return false;
+        if (data[pos] == '}') return skipWhitespace(data, pos + 1, size) == size;   // nothing may follow
+        if (data[pos] != ',') return false;
+        pos = skipWhitespace(data, pos + 1, size);
+    }
+    return false;
+}
+
+// Read-only access to the top-level members of a JSON object, backed either
+// by QJsonDocument or by an on-demand index of member slices built in one
+// JsonScanner pass (nested values are left unparsed until asked for). Hot
+// paths use this; GUI-only views keep using QJsonDocument directly. Member
+// names containing escapes are not matched by the on-demand backend.
+class JsonObjectView
+{
+public:
+    enum Backend { QtBackend, OnDemandBackend };
+
+    // Process-wide choice for views constructed without an explicit backend;
+    // QtBackend unless load mode selects the on-demand scanner
+    static Backend defaultBackend();
+    static void setDefaultBackend(Backend backend);
+
+    JsonObjectView();
+    explicit JsonObjectView(const QByteArray& json);
+    JsonObjectView(const QByteArray& json, Backend backend);
+    explicit JsonObjectView(const QJsonObject& object);
+
+    bool isValid() const { return m_valid; }
+
+    bool contains(QLatin1String key) const;
+    QString string(QLatin1String key) const;
+    qint64 integer(QLatin1String key, qint64 defaultValue = 0) const;
+    JsonType type(QLatin1String key) const;
+
+    // Builds a QJsonObject, parsing the whole input if needed
+    QJsonObject toJsonObject() const;
+
+private:
+    struct Member
+    {
+        int keyOffset;
+        int keyLength;
+        int valueOffset;
+        int valueLength;
+        JsonType type;
+    };
+
+    const Member* find(QLatin1String key) const;
+
+    QByteArray m_data;
+    QVarLengthArray<Member, 16> m_members;
+    QJsonObject m_object;
+    bool m_onDemand;
+    bool m_valid;
+};
+
+#endif // JSONSCANNER_H
@@ -0,0 +1,235 @@
+#include "JwsSigner.h"
+#include <QFile>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+static const QByteArray::Base64Options BASE64URL = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+// Size of each of r and s in an ES256 signature
+static const int P256_COORDINATE_BYTES = 32;
+
+// Fails encrypted keys instead of prompting on the terminal
+static int noPassphrase(char*, int, int, void*)
+{
+    return 0;
+}
+
+JwsSigner::JwsSigner()
+    : m_key(nullptr)
+{
+}
+
+JwsSigner::~JwsSigner()
+{
+    clear();
+}
+
+void JwsSigner::clear()
+{
+    EVP_PKEY_free(m_key);
+    m_key = nullptr;
+    m_algorithm.clear();
+    m_encodedHeader.clear();
+}
+
+bool JwsSigner::loadFile(const QString& path, const QString& type, const QString& keyId, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("Cannot open signing key %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    if (!loadPem(file.readAll(), type, keyId, error)) {
+        if (error) *error = QString("%1: %2").arg(path, *error);
+        return false;
+    }
+    return true;
+}
+
+bool JwsSigner::loadPem(const QByteArray& pem, const QString& type, const QString& keyId, QString* error)
+{
+    clear();
+
+    BIO* bio = BIO_new_mem_buf(pem.constData(), pem.size());
+    EVP_PKEY* key = bio ? PEM_read_bio_PrivateKey(bio, nullptr, noPassphrase, nullptr) : nullptr;
+    BIO_free(bio);
+    if (!key) {
+        if (error) *error = "no unencrypted PEM private key";
+        return false;
+    }
+
+    QString algorithm;
+    if (EVP_PKEY_get_base_id(key) == EVP_PKEY_RSA) {
+        algorithm = "RS256";
+    } else if (EVP_PKEY_get_base_id(key) == EVP_PKEY_EC) {
+        char group[64] = {};
+        size_t groupLength = 0;
+        if (EVP_PKEY_get_utf8_string_param(key, OSSL_PKEY_PARAM_GROUP_NAME, group, sizeof(group), &groupLength) == 1
+            && qstrcmp(group, "prime256v1") == 0) {
+            algorithm = "ES256";
+        }
+    }
+    if (algorithm.isEmpty()) {
+        EVP_PKEY_free(key);
+        if (error) *error = "only RSA (RS256) and P-256 (ES256) keys are supported";
+        return false;
+    }
+
+    QJsonObject header;
+    if (!type.isEmpty()) {
+        header["typ"] = type;
+    }
+    if (!keyId.isEmpty()) {
+        header["kid"] = keyId;
+    }
+    setKey(key, algorithm, header);
+    return true;
+}
+
+bool JwsSigner::generateP256(const QString& type, QString* error)
+{
+    clear();
+
+    EVP_PKEY* key = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+    if (!key) {
+        if (error) *error = "P-256 key generation failed";
+        return false;
+    }
+
+    QJsonObject header;
+    if (!type.isEmpty()) {
+        header["typ"] = type;
+    }
+    m_key = key;   // read by publicJwk()
+    header["jwk"] = publicJwk();
+    setKey(key, "ES256", header);
+    return true;
+}
+
+void JwsSigner::setKey(EVP_PKEY* key, const QString& algorithm, QJsonObject header)
+{
+    // The header never changes, so it is encoded once per key
+    header["alg"] = algorithm;
+    m_key = key;
+    m_algorithm = algorithm;
+    m_encodedHeader = QJsonDocument(header).toJson(QJsonDocument::Compact).toBase64(BASE64URL);
+}
+
+QJsonObject JwsSigner::publicJwk() const
+{
+    QJsonObject jwk;
+    if (!m_key) return jwk;
+
+    if (EVP_PKEY_get_base_id(m_key) == EVP_PKEY_EC) {
+        BIGNUM* x = nullptr;
+        BIGNUM* y = nullptr;
+        if (EVP_PKEY_get_bn_param(m_key, OSSL_PKEY_PARAM_EC_PUB_X, &x) == 1
+            && EVP_PKEY_get_bn_param(m_key, OSSL_PKEY_PARAM_EC_PUB_Y, &y) == 1) {
+            QByteArray coordinates(2 * P256_COORDINATE_BYTES, Qt::Uninitialized);
+            unsigned char* out = reinterpret_cast<unsigned char*>(coordinates.data());
+            BN_bn2binpad(x, out, P256_COORDINATE_BYTES);
+            BN_bn2binpad(y, out + P256_COORDINATE_BYTES, P256_COORDINATE_BYTES);
+            jwk["kty"] = "EC";
+            jwk["crv"] = "P-256";
+            jwk["x"] = QString::fromLatin1(coordinates.left(P256_COORDINATE_BYTES).toBase64(BASE64URL));
+            jwk["y"] = QString::fromLatin1(coordinates.mid(P256_COORDINATE_BYTES).toBase64(BASE64URL));
+        }
+        BN_free(x);
+        BN_free(y);
+    } else {
+        BIGNUM* n = nullptr;
+        BIGNUM* e = nullptr;
+        if (EVP_PKEY_get_bn_param(m_key, OSSL_PKEY_PARAM_RSA_N, &n) == 1
+            && EVP_PKEY_get_bn_param(m_key, OSSL_PKEY_PARAM_RSA_E, &e) == 1) {
+            QByteArray modulus(BN_num_bytes(n), Qt::Uninitialized);
+            QByteArray exponent(BN_num_bytes(e), Qt::Uninitialized);
+            BN_bn2bin(n, reinterpret_cast<unsigned char*>(modulus.data()));
+            BN_bn2bin(e, reinterpret_cast<unsigned char*>(exponent.data()));
+            jwk["kty"] = "RSA";
+            jwk["n"] = QString::fromLatin1(modulus.toBase64(BASE64URL));
+            jwk["e"] = QString::fromLatin1(exponent.toBase64(BASE64URL));
+        }
+        BN_free(n);
+        BN_free(e);
+    }
+    return jwk;
+}
+
+QByteArray JwsSigner::jwkThumbprint() const
+{
+    // RFC 7638: the required members only, sorted by name, no whitespace;
+    // QJsonObject already keeps its keys sorted
+    const QJsonObject jwk = publicJwk();
+    if (jwk.isEmpty()) return QByteArray();
+
+    QJsonObject required;
+    const QStringList members = jwk["kty"] == QLatin1String("EC") ? QStringList{"crv", "kty", "x", "y"}
+                                                                  : QStringList{"e", "kty", "n"};
+    for (const QString& member : members) {
+        required[member] = jwk[member];
+    }
+    return QCryptographicHash::hash(QJsonDocument(required).toJson(QJsonDocument::Compact),
+                                    QCryptographicHash::Sha256).toBase64(BASE64URL);
+}
+
+QByteArray JwsSigner::signToken(const QByteArray& payloadJson) const
+{
+    if (!m_key) return QByteArray();
+
+    QByteArray token = m_encodedHeader + '.' + payloadJson.toBase64(BASE64URL);
+    QByteArray signature = sign(token);
+    if (signature.isEmpty()) return QByteArray();
+
+    token += '.';
+    token += signature.toBase64(BASE64URL);
+    return token;
+}
+
+QByteArray JwsSigner::sign(const QByteArray& signingInput) const
+{
+    if (!m_key) return QByteArray();
+
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (!ctx) return QByteArray();
+
+    size_t length = 0;
+    QByteArray signature;
+    bool ok = EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, m_key) == 1
+           && EVP_DigestSign(ctx, nullptr, &length,
+                             reinterpret_cast<const unsigned char*>(signingInput.constData()), signingInput.size()) == 1;
+    if (ok) {
+        signature.resize(int(length));
+        ok = EVP_DigestSign(ctx, reinterpret_cast<unsigned char*>(signature.data()), &length,
+                            reinterpret_cast<const unsigned char*>(signingInput.constData()), signingInput.size()) == 1;
+        signature.resize(int(length));
+    }
+    EVP_MD_CTX_free(ctx);
+    if (!ok) return QByteArray();
+
+    if (m_algorithm != QLatin1String("ES256")) {
+        return signature;
+    }
+
+    // OpenSSL produces a DER ECDSA-Sig-Value; JWS wants fixed-size r||s (RFC 7518 3.4)
+    const unsigned char* der = reinterpret_cast<const unsigned char*>(signature.constData());
+    ECDSA_SIG* ecdsa = d2i_ECDSA_SIG(nullptr, &der, signature.size());
+    if (!ecdsa) return QByteArray();
+
+    const BIGNUM* r = nullptr;
+    const BIGNUM* s = nullptr;
+    ECDSA_SIG_get0(ecdsa, &r, &s);
+    QByteArray raw(2 * P256_COORDINATE_BYTES, Qt::Uninitialized);
+    unsigned char* out = reinterpret_cast<unsigned char*>(raw.data());
+    ok = BN_bn2binpad(r, out, P256_COORDINATE_BYTES) == P256_COORDINATE_BYTES
+      && BN_bn2binpad(s, out + P256_COORDINATE_BYTES, P256_COORDINATE_BYTES) == P256_COORDINATE_BYTES;
+    ECDSA_SIG_free(ecdsa);
+    return ok ? raw : QByteArray();
+}
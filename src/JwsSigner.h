@@ -0,0 +1,53 @@
+#ifndef JWSSIGNER_H
+#define JWSSIGNER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+typedef struct evp_pkey_st EVP_PKEY;
+
+// Compact JWS signing with an RSA (RS256) or P-256 (ES256) private key. The
+// key is parsed once and the encoded protected header is kept, so signing a
+// token is one payload encode plus one signature. sign() only reads the key
+// and may be called from several threads at once.
+class JwsSigner
+{
+public:
+    JwsSigner();
+    ~JwsSigner();
+
+    JwsSigner(const JwsSigner&) = delete;
+    JwsSigner& operator=(const JwsSigner&) = delete;
+
+    // Unencrypted PEM private key (PKCS#8 or traditional); the algorithm
+    // follows from the key type. typ and kid go into the protected header.
+    bool loadPem(const QByteArray& pem, const QString& type, const QString& keyId, QString* error);
+    bool loadFile(const QString& path, const QString& type, const QString& keyId, QString* error);
+
+    // Fresh ES256 key whose public JWK is embedded in the header (DPoP proofs)
+    bool generateP256(const QString& type, QString* error);
+
+    // Public key as a JWK, and its RFC 7638 SHA-256 thumbprint (base64url)
+    QJsonObject publicJwk() const;
+    QByteArray jwkThumbprint() const;
+
+    bool isNull() const { return m_key == nullptr; }
+    QString algorithm() const { return m_algorithm; }
+
+    // header.payload.signature for a compact-serialized JSON payload
+    QByteArray signToken(const QByteArray& payloadJson) const;
+
+    // JWS signature of the signing input: PKCS#1 v1.5 for RS256, r||s for ES256
+    QByteArray sign(const QByteArray& signingInput) const;
+
+private:
+    void clear();
+    void setKey(EVP_PKEY* key, const QString& algorithm, QJsonObject header);
+
+    EVP_PKEY* m_key;
+    QString m_algorithm;
+    QByteArray m_encodedHeader;
+};
+
+#endif // JWSSIGNER_H
@@ -0,0 +1,129 @@
+#include "LatencyHistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+#include <limits>
+
+static const int SUB_BUCKET_BITS = 6;
+static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;           // 64
+static const int LINEAR_LIMIT = 2 * SUB_BUCKETS;                // values below are exact
+static const int MAX_MSB = 47;                                  // 2^48 us is ~9 years
+static const int BUCKET_COUNT = LINEAR_LIMIT + (MAX_MSB - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+LatencyHistogram::LatencyHistogram()
+    : m_counts(BUCKET_COUNT, 0)
+    , m_count(0)
+    , m_min(std::numeric_limits<qint64>::max())
+    , m_max(0)
+    , m_sum(0.0)
+{
+}
+
+int LatencyHistogram::bucketIndex(qint64 valueUs)
+{
+    if (valueUs < LINEAR_LIMIT) {
+        return int(qMax<qint64>(0, valueUs));
+    }
+
+    int msb = 63 - int(qCountLeadingZeroBits(quint64(valueUs)));
+    if (msb > MAX_MSB) {
+        return BUCKET_COUNT - 1;
+    }
+
+    int shift = msb - SUB_BUCKET_BITS;
+    int subBucket = int(valueUs >> shift);   // in [64, 127]
+    return LINEAR_LIMIT + (shift - 1) * SUB_BUCKETS + (subBucket - SUB_BUCKETS);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < LINEAR_LIMIT) {
+        return index;
+    }
+
+    int offset = index - LINEAR_LIMIT;
+    int shift = offset / SUB_BUCKETS + 1;
+    qint64 subBucket = offset % SUB_BUCKETS + SUB_BUCKETS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 valueUs)
+{
+    if (valueUs < 0) return;
+
+    ++m_counts[bucketIndex(valueUs)];
+    ++m_count;
+    m_min = qMin(m_min, valueUs);
+    m_max = qMax(m_max, valueUs);
+    m_sum += valueUs;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (other.m_count == 0) return;
+
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_min = qMin(m_min, other.m_min);
+    m_max = qMax(m_max, other.m_max);
+    m_sum += other.m_sum;
+}
+
+void LatencyHistogram::reset()
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_min = std::numeric_limits<qint64>::max();
+    m_max = 0;
+    m_sum = 0.0;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+    if (m_count == 0) return 0;
+
+    qint64 target = qMax<qint64>(1, qint64(std::ceil(qBound(0.0, percent, 100.0) / 100.0 * m_count)));
+    qint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += qint64(m_counts[i]);
+        if (seen >= target) {
+            return qMin(bucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+QDataStream& operator<<(QDataStream& stream, const LatencyHistogram& histogram)
+{
+    // Sparse encoding: only non-empty buckets
+    quint32 used = 0;
+    for (quint64 count : histogram.m_counts) {
+        if (count) ++used;
+    }
+
+    stream << histogram.m_count << histogram.m_min << histogram.m_max << histogram.m_sum << used;
+    for (int i = 0; i < histogram.m_counts.size(); ++i) {
+        if (histogram.m_counts[i]) {
+            stream << quint32(i) << quint64(histogram.m_counts[i]);
+        }
+    }
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, LatencyHistogram& histogram)
+{
+    histogram.reset();
+
+    quint32 used;
+    stream >> histogram.m_count >> histogram.m_min >> histogram.m_max >> histogram.m_sum >> used;
+    for (quint32 i = 0; i < used && stream.status() == QDataStream::Ok; ++i) {
+        quint32 index;
+        quint64 count;
+        stream >> index >> count;
+        if (index < quint32(BUCKET_COUNT)) {
+            histogram.m_counts[int(index)] = count;
+        }
+    }
+    return stream;
+}
@@ -0,0 +1,42 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QVector>
+#include <QDataStream>
+
+// HDR-style log-linear histogram of microsecond latencies: exact below 128 us,
+// then 64 sub-buckets per power of two (~1.6% relative precision) up to ~9
+// years. Fixed layout, so histograms from different threads or processes can
+// be merged bucket by bucket.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 valueUs);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    qint64 count() const { return m_count; }
+    qint64 min() const { return m_count > 0 ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const { return m_count > 0 ? m_sum / m_count : 0.0; }
+
+    // Highest value equivalent to the given percentile (0-100)
+    qint64 percentile(double percent) const;
+
+    friend QDataStream& operator<<(QDataStream& stream, const LatencyHistogram& histogram);
+    friend QDataStream& operator>>(QDataStream& stream, LatencyHistogram& histogram);
+
+private:
+    static int bucketIndex(qint64 valueUs);
+    static qint64 bucketUpperBound(int index);
+
+    QVector<quint64> m_counts;
+    qint64 m_count;
+    qint64 m_min;
+    qint64 m_max;
+    double m_sum;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,317 @@
+#include "LoadCoordinator.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QTimer>
+#include <QCoreApplication>
+
+QDataStream& operator<<(QDataStream& stream, const WorkerAssignment& assignment)
+{
+    stream << assignment.index << assignment.flows << assignment.concurrency
+           << assignment.ratePerSecond << assignment.durationMs;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, WorkerAssignment& assignment)
+{
+    stream >> assignment.index >> assignment.flows >> assignment.concurrency
+           >> assignment.ratePerSecond >> assignment.durationMs;
+    return stream;
+}
+
+LoadCoordinator::LoadCoordinator(QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+    , m_connectTimer(new QTimer(this))
+    , m_expected(0)
+    , m_assigned(false)
+    , m_done(false)
+    , m_completed(0)
+    , m_failed(0)
+    , m_ruleViolations(0)
+    , m_duplicates(0)
+{
+    m_connectTimer->setSingleShot(true);
+    connect(m_server, &QLocalServer::newConnection, this, &LoadCoordinator::onNewConnection);
+    connect(m_connectTimer, &QTimer::timeout, this, &LoadCoordinator::onConnectTimeout);
+}
+
+LoadCoordinator::~LoadCoordinator()
+{
+    for (QProcess* process : m_processes) {
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+    qDeleteAll(m_workers);
+}
+
+bool LoadCoordinator::start(const QString& serverName, int spawnCount, int attachCount, QString* error)
+{
+    m_expected = spawnCount + attachCount;
+    if (m_expected <= 0) {
+        if (error) *error = "The coordinator needs at least one worker";
+        return false;
+    }
+
+    // A stale socket file from a crashed run would make listen() fail
+    QLocalServer::removeServer(serverName);
+    if (!m_server->listen(serverName)) {
+        if (error) *error = QString("Cannot listen on %1: %2").arg(serverName, m_server->errorString());
+        return false;
+    }
+
+    emit logMessage(QString("Coordinator listening on %1, waiting for %2 worker(s)")
+                   .arg(m_server->fullServerName()).arg(m_expected));
+    if (attachCount > 0) {
+        emit logMessage(QString("Attach workers with: %1 --worker %2 [--profile ...]")
+                       .arg(QCoreApplication::applicationFilePath(), m_server->fullServerName()));
+    }
+
+    for (int i = 0; i < spawnCount; ++i) {
+        QProcess* process = new QProcess(this);
+        const QString prefix = QString("[worker process %1] ").arg(i + 1);
+        process->setProcessChannelMode(QProcess::MergedChannels);
+
+        connect(process, &QProcess::readyReadStandardOutput, this, [this, process, prefix]() {
+            while (process->canReadLine()) {
+                emit logMessage(prefix + QString::fromUtf8(process->readLine()).trimmed());
+            }
+        });
+        connect(process, &QProcess::finished, this, [this, prefix](int exitCode) {
+            // Once the run has started, a worker that dies shows up as a
+            // socket closed without a result
+            if (!m_assigned) {
+                abort(prefix + QString("exited with code %1 before connecting").arg(exitCode));
+            }
+        });
+
+        process->start(QCoreApplication::applicationFilePath(),
+                       QStringList{"--worker", m_server->fullServerName()} + m_workerArguments);
+        m_processes.append(process);
+    }
+
+    m_connectTimer->start(CONNECT_TIMEOUT_MS);
+    return true;
+}
+
+void LoadCoordinator::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        if (m_assigned || m_done) {
+            // Late workers get no share; closing tells them so
+            socket->disconnectFromServer();
+            socket->deleteLater();
+            continue;
+        }
+
+        Worker* worker = new Worker;
+        worker->socket = socket;
+        m_workers.append(worker);
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, worker]() { readMessages(worker); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, worker]() {
+            if (!worker->reported && !worker->gone) {
+                worker->gone = true;
+                emit logMessage(QString("Worker %1 (pid %2) disconnected without a result")
+                               .arg(worker->index + 1).arg(worker->pid));
+                if (!m_assigned) {
+                    abort("A worker left before the run started");
+                    return;
+                }
+                checkFinished();
+            }
+        });
+    }
+}
+
+void LoadCoordinator::readMessages(Worker* worker)
+{
+    QDataStream in(worker->socket);
+    in.setVersion(CoordinatorProtocol::STREAM_VERSION);
+
+    for (;;) {
+        in.startTransaction();
+
+        quint8 type = 0;
+        in >> type;
+        if (type == CoordinatorProtocol::Hello) {
+            qint64 pid = 0;
+            in >> pid;
+            if (!in.commitTransaction()) return;
+
+            worker->pid = pid;
+            int connected = connectedWorkers();
+            emit logMessage(QString("Worker pid %1 connected (%2/%3)").arg(pid).arg(connected).arg(m_expected));
+            if (connected == m_expected) {
+                assignWork();
+            }
+        } else if (type == CoordinatorProtocol::Result) {
+            qint32 completed = 0;
+            qint32 failed = 0;
+            qint64 elapsedMs = 0;
+            quint64 ruleViolations = 0;
+            quint64 duplicates = 0;
+            LatencyHistogram histogram;
+            QString summary;
+            in >> completed >> failed >> elapsedMs >> ruleViolations >> duplicates >> histogram >> summary;
+            if (!in.commitTransaction()) return;
+
+            worker->reported = true;
+            worker->completed = completed;
+            worker->failed = failed;
+            worker->elapsedMs = elapsedMs;
+            worker->summary = summary;
+            m_completed += completed;
+            m_failed += failed;
+            m_ruleViolations += ruleViolations;
+            m_duplicates += duplicates;
+            m_merged.merge(histogram);
+            emit logMessage(QString("Worker %1 finished: %2 completed, %3 failed")
+                           .arg(worker->index + 1).arg(completed).arg(failed));
+            checkFinished();
+        } else {
+            if (!in.commitTransaction()) return;
+            emit logMessage(QString("Ignoring unknown message %1 from worker pid %2").arg(type).arg(worker->pid));
+        }
+    }
+}
+
+int LoadCoordinator::connectedWorkers() const
+{
+    int connected = 0;
+    for (const Worker* worker : m_workers) {
+        if (worker->pid != 0) ++connected;
+    }
+    return connected;
+}
+
+WorkerAssignment LoadCoordinator::share(const WorkerAssignment& totals, int index, int count)
+{
+    // Each busy worker needs at least one concurrent flow; the others get nothing
+    // rather than raising the total concurrency
+    WorkerAssignment assignment;
+    assignment.index = index;
+    const int busy = qBound(1, totals.concurrency, count);
+    if (index >= busy) {
+        assignment.flows = 0;
+        assignment.concurrency = 0;
+        return assignment;
+    }
+
+    // Integer totals are split as evenly as possible, the remainder going to the first workers
+    assignment.flows = totals.flows / busy + (index < totals.flows % busy ? 1 : 0);
+    assignment.concurrency = totals.concurrency / busy + (index < totals.concurrency % busy ? 1 : 0);
+    assignment.ratePerSecond = totals.ratePerSecond / busy;
+    assignment.durationMs = totals.durationMs;
+    return assignment;
+}
+
+void LoadCoordinator::assignWork()
+{
+    m_connectTimer->stop();
+    m_assigned = true;
+    m_runTimer.start();
+
+    // Sockets that never said Hello are not workers
+    for (int i = m_workers.size() - 1; i >= 0; --i) {
+        Worker* worker = m_workers[i];
+        if (worker->pid != 0) continue;
+        disconnect(worker->socket, nullptr, this, nullptr);
+        worker->socket->disconnectFromServer();
+        worker->socket->deleteLater();
+        delete m_workers.takeAt(i);
+    }
+
+    int count = m_workers.size();
+    for (int i = 0; i < count; ++i) {
+        Worker* worker = m_workers[i];
+        worker->index = i;
+        WorkerAssignment assignment = share(m_totals, i, count);
+
+        QByteArray message;
+        QDataStream out(&message, QIODevice::WriteOnly);
+        out.setVersion(CoordinatorProtocol::STREAM_VERSION);
+        out << quint8(CoordinatorProtocol::Assign) << assignment;
+        worker->socket->write(message);
+
+        emit logMessage(QString("Worker %1 (pid %2): %3 flows, concurrency %4%5")
+                       .arg(i + 1).arg(worker->pid)
+                       .arg(assignment.durationMs > 0 ? QString("%1 s of").arg(assignment.durationMs / 1000)
+                                                    : QString::number(assignment.flows))
+                       .arg(assignment.concurrency)
+                       .arg(assignment.ratePerSecond > 0 ? QString(", %1 flows/s").arg(assignment.ratePerSecond, 0, 'f', 2)
+                                                         : QString()));
+    }
+}
+
+void LoadCoordinator::onConnectTimeout()
+{
+    abort(QString("Only %1 of %2 worker(s) connected within %3 s")
+          .arg(connectedWorkers()).arg(m_expected).arg(CONNECT_TIMEOUT_MS / 1000));
+}
+
+void LoadCoordinator::abort(const QString& reason)
+{
+    if (m_done) return;
+
+    emit logMessage(reason);
+    m_done = true;
+    m_connectTimer->stop();
+    for (Worker* worker : m_workers) {
+        worker->socket->disconnectFromServer();
+    }
+    emit finished();
+}
+
+void LoadCoordinator::checkFinished()
+{
+    if (m_done) return;
+
+    for (Worker* worker : m_workers) {
+        if (!worker->reported && !worker->gone) return;
+    }
+
+    m_done = true;
+    emit finished();
+}
+
+int LoadCoordinator::lostWorkers() const
+{
+    int lost = m_expected - m_workers.size();
+    for (Worker* worker : m_workers) {
+        if (!worker->reported) ++lost;
+    }
+    return lost;
+}
+
+QString LoadCoordinator::summary() const
+{
+    double seconds = m_runTimer.isValid() ? m_runTimer.elapsed() / 1000.0 : 0.0;
+    double rate = seconds > 0 ? (m_completed + m_failed) / seconds : 0.0;
+
+    QString result = QString("Coordinator: %1 worker(s), %2 lost; flows: %3 completed, %4 failed in %5 s (%6 flows/s); "
+                             "%7 rule violation(s), %8 duplicate value(s)\n"
+                             "Merged flow latency mean %9 ms, p50 %10 ms, p95 %11 ms, p99 %12 ms, p99.9 %13 ms, max %14 ms")
+        .arg(m_workers.size())
+        .arg(lostWorkers())
+        .arg(m_completed)
+        .arg(m_failed)
+        .arg(seconds, 0, 'f', 2)
+        .arg(rate, 0, 'f', 1)
+        .arg(m_ruleViolations)
+        .arg(m_duplicates)
+        .arg(m_merged.mean() / 1000.0, 0, 'f', 1)
+        .arg(m_merged.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_merged.percentile(95) / 1000.0, 0, 'f', 1)
+        .arg(m_merged.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(m_merged.percentile(99.9) / 1000.0, 0, 'f', 1)
+        .arg(m_merged.max() / 1000.0, 0, 'f', 1);
+
+    for (const Worker* worker : m_workers) {
+        if (!worker->reported) continue;
+        result += QString("\n--- worker %1 (pid %2) ---\n%3").arg(worker->index + 1).arg(worker->pid).arg(worker->summary);
+    }
+    return result;
+}
@@ -0,0 +1,120 @@
+#ifndef LOADCOORDINATOR_H
+#define LOADCOORDINATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include "LatencyHistogram.h"
+
+class QLocalServer;
+class QLocalSocket;
+class QProcess;
+class QTimer;
+
+// Messages between the coordinator and its workers. Each is one QDataStream
+// record starting with its type:
+//   Hello   worker -> coordinator   qint64 pid
+//   Assign  coordinator -> worker   WorkerAssignment
+//   Result  worker -> coordinator   qint32 completed, qint32 failed, qint64 elapsedMs,
+//                                   quint64 ruleViolations, quint64 duplicates,
+//                                   LatencyHistogram flows, QString summary
+namespace CoordinatorProtocol
+{
+    enum MessageType : quint8 { Hello = 1, Assign = 2, Result = 3 };
+    const QDataStream::Version STREAM_VERSION = QDataStream::Qt_6_0;
+}
+
+// One worker's share of the run (or, for the coordinator, the totals)
+struct WorkerAssignment
+{
+    qint32 index = 0;
+    qint32 flows = 0;
+    qint32 concurrency = 1;
+    double ratePerSecond = 0.0;     // 0 = unpaced
+    qint64 durationMs = 0;          // when > 0, run for this long instead
+};
+
+QDataStream& operator<<(QDataStream& stream, const WorkerAssignment& assignment);
+QDataStream& operator>>(QDataStream& stream, WorkerAssignment& assignment);
+
+// Runs a load test across several processes: spawns local workers (the same
+// executable with --worker) and/or waits for ones started by hand, splits
+// flows, concurrency and rate between them once all have connected, and
+// merges the flow histograms and check totals they report into a single
+// result. With less concurrency than workers the extra ones run nothing. Workers on
+// other hosts run their own coordinator; local sockets do not leave the host.
+class LoadCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoadCoordinator(QObject *parent = nullptr);
+    ~LoadCoordinator();
+
+    void setTotals(const WorkerAssignment& totals) { m_totals = totals; }
+
+    // Passed to spawned workers after --worker <server>
+    void setWorkerArguments(const QStringList& arguments) { m_workerArguments = arguments; }
+
+    bool start(const QString& serverName, int spawnCount, int attachCount, QString* error);
+
+    int completedFlows() const { return m_completed; }
+    int failedFlows() const { return m_failed; }
+    quint64 ruleViolations() const { return m_ruleViolations; }
+    quint64 duplicateValues() const { return m_duplicates; }
+    int lostWorkers() const;
+    const LatencyHistogram& flowHistogram() const { return m_merged; }
+    QString summary() const;
+
+signals:
+    void logMessage(const QString& message);
+    void finished();
+
+private slots:
+    void onNewConnection();
+    void onConnectTimeout();
+
+private:
+    struct Worker
+    {
+        QLocalSocket* socket = nullptr;
+        qint64 pid = 0;
+        int index = -1;
+        bool reported = false;
+        bool gone = false;
+        int completed = 0;
+        int failed = 0;
+        qint64 elapsedMs = 0;
+        QString summary;
+    };
+
+    int connectedWorkers() const;
+    void readMessages(Worker* worker);
+    void assignWork();
+    void abort(const QString& reason);
+    void checkFinished();
+    static WorkerAssignment share(const WorkerAssignment& totals, int index, int count);
+
+    QLocalServer* m_server;
+    QTimer* m_connectTimer;
+    QList<Worker*> m_workers;
+    QList<QProcess*> m_processes;
+    WorkerAssignment m_totals;
+    QStringList m_workerArguments;
+    int m_expected;
+    bool m_assigned;
+    bool m_done;
+    int m_completed;
+    int m_failed;
+    quint64 m_ruleViolations;
+    quint64 m_duplicates;
+    LatencyHistogram m_merged;
+    QElapsedTimer m_runTimer;
+
+    static const int CONNECT_TIMEOUT_MS = 60 * 1000;
+};
+
+#endif // LOADCOORDINATOR_H
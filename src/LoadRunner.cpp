@@ -0,0 +1,525 @@
+#include "LoadRunner.h"
+#include "OIDCManager.h"
+#include "ScriptedAuthorizer.h"
+#include "FlowSecretPool.h"
+#include "ProfileStore.h"
+#include "ClaimRules.h"
+#include "UniquenessChecker.h"
+#include "TokenAnalytics.h"
+#include "ClaimExtractor.h"
+#include "Scenario.h"
+#include "RetryPolicy.h"
+#include "TlsSessionCache.h"
+#include "ClientAssertion.h"
+#include <QThread>
+#include <QTimer>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <limits>
+
+LoadConfig LoadConfig::fromProfile(const OIDCProfile& profile)
+{
+    LoadConfig config;
+
+    config.issuerURL = profile.issuerURL.trimmed();
+    config.clientID = profile.clientID.trimmed();
+    config.clientSecret = profile.clientSecret.trimmed();
+    config.scopes = profile.scopes.trimmed();
+    config.acrValue = profile.acrValue;
+    config.loginHint = profile.loginHint.trimmed();
+    config.promptLogin = profile.promptLogin;
+    config.responseType = profile.responseType;
+    config.extraParams = profile.extraParams.trimmed();
+    config.skipStateValidation = profile.skipStateValidation;
+    config.disablePKCE = profile.disablePKCE;
+    config.clientCertificate = profile.clientCertificate.trimmed();
+    config.clientKey = profile.clientKey.trimmed();
+    config.clientAssertionKey = profile.clientAssertionKey.trimmed();
+    config.clientAssertionKeyId = profile.clientAssertionKeyId.trimmed();
+    config.useDpop = profile.useDpop;
+    config.loginFormFields = profile.loginFormFields.trimmed();
+
+    return config;
+}
+
+LoadConfig LoadConfig::fromSettings(const QString& profileName)
+{
+    ProfileStore store;
+    store.load();
+    return fromProfile(profileName.isEmpty() ? store.current() : store.profile(profileName));
+}
+
+LoadRunner::LoadRunner(const LoadConfig& config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_sampleRing(nullptr)
+    , m_rules(nullptr)
+    , m_uniqueness(nullptr)
+    , m_tokenAnalytics(nullptr)
+    , m_results(nullptr)
+    , m_retryPolicy(nullptr)
+    , m_networkStats(nullptr)
+    , m_tlsSessionCache(nullptr)
+    , m_scenario(nullptr)
+    , m_started(0)
+    , m_completed(0)
+    , m_failed(0)
+    , m_running(false)
+{
+    int threadCount = qBound(1, m_config.threads, qMax(1, m_config.concurrency));
+    if (threadCount > 1) {
+        for (int i = 0; i < threadCount; ++i) {
+            QThread* thread = new QThread(this);
+            thread->setObjectName(QString("flow-worker-%1").arg(i));
+            m_threads.append(thread);
+        }
+    }
+
+    const int managerCount = qMax(1, m_config.concurrency);
+    m_reported.reset(new bool[managerCount]());
+    for (int i = 0; i < managerCount; ++i) {
+        OIDCManager* manager = new OIDCManager(m_threads.isEmpty() ? this : nullptr);
+
+        ScriptedAuthorizer* authorizer = new ScriptedAuthorizer();
+        authorizer->setFormFields(m_config.loginFormFields);
+        manager->setAuthorizer(authorizer);
+
+        if (!m_threads.isEmpty()) {
+            QThread* thread = m_threads[i % m_threads.size()];
+            manager->moveToThread(thread);
+            connect(thread, &QThread::finished, manager, &QObject::deleteLater);
+        }
+
+        // Published on the manager's own thread, then handed to this thread for bookkeeping
+        bool* reported = &m_reported[i];
+        connect(manager, &OIDCManager::tokensReceived, manager, [this, manager, reported]() {
+            publishFlow(manager, reported, true, QString());
+        }, Qt::DirectConnection);
+        connect(manager, &OIDCManager::errorOccurred, manager, [this, manager, reported](const QString& error) {
+            publishFlow(manager, reported, false, error);
+        }, Qt::DirectConnection);
+        connect(manager, &OIDCManager::tokensRevoked, manager, [this, manager, reported]() {
+            publishFlow(manager, reported, true, QString());
+        }, Qt::DirectConnection);
+
+        m_slots.insert(manager, i);
+        m_managers.append(manager);
+    }
+
+    for (QThread* thread : m_threads) {
+        thread->start();
+    }
+}
+
+LoadRunner::~LoadRunner()
+{
+    for (QThread* thread : m_threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void LoadRunner::setRecorder(ExchangeRecorder* recorder)
+{
+    for (OIDCManager* manager : m_managers) {
+        manager->setRecorder(recorder);
+    }
+}
+
+void LoadRunner::setRetryPolicy(RetryPolicy* policy)
+{
+    m_retryPolicy = policy;
+    for (OIDCManager* manager : m_managers) {
+        manager->setRetryPolicy(policy);
+    }
+}
+
+void LoadRunner::setNetworkTimingStats(NetworkTimingStats* stats)
+{
+    m_networkStats = stats;
+    for (OIDCManager* manager : m_managers) {
+        manager->setNetworkTimingStats(stats);
+    }
+}
+
+void LoadRunner::setTlsSessionCache(TlsSessionCache* cache)
+{
+    m_tlsSessionCache = cache;
+    for (OIDCManager* manager : m_managers) {
+        manager->setTlsSessionCache(cache);
+    }
+}
+
+void LoadRunner::setScenario(const Scenario* scenario)
+{
+    m_scenario = scenario && !scenario->isEmpty() ? scenario : nullptr;
+}
+
+void LoadRunner::start()
+{
+    if (m_running) return;
+
+    m_running = true;
+    m_started = 0;
+    m_completed = 0;
+    m_failed = 0;
+    m_flowHistogram.reset();
+    m_users.clear();
+    m_stepHistograms = QVector<LatencyHistogram>(m_scenario ? m_scenario->stepCount() : 0);
+    m_stepFailures = QVector<int>(m_stepHistograms.size(), 0);
+    if (m_rules) {
+        m_rules->resetCounters();
+    }
+    if (m_tokenAnalytics) {
+        m_tokenAnalytics->reset();
+    }
+    if (m_networkStats) {
+        m_networkStats->reset();
+    }
+    if (m_tlsSessionCache) {
+        m_tlsSessionCache->resetStatistics();
+    }
+    if (!m_config.clientAssertionKey.isEmpty()) {
+        ClientAssertionPool::shared()->resetStatistics();
+    }
+
+    // Keep per-flow random generation and hashing out of the measured latency
+    FlowSecretPool::shared()->prefill();
+
+    m_runTimer.start();
+    if (m_results) {
+        m_results->setRunStart(QDateTime::currentMSecsSinceEpoch());
+    }
+
+    if (m_scenario) {
+        emit logMessage(QString("Scenario \"%1\": %2 flow(s), %3 compiled step(s)")
+                       .arg(m_scenario->name()).arg(m_scenario->flowCount()).arg(m_scenario->stepCount()));
+    }
+
+    if (m_config.durationMs > 0) {
+        emit logMessage(QString("Running scripted flows against %1 for %2 s with concurrency %3 on %4 thread(s)")
+                       .arg(m_config.issuerURL).arg(m_config.durationMs / 1000).arg(m_managers.size())
+                       .arg(qMax(1, int(m_threads.size()))));
+    } else {
+        emit logMessage(QString("Starting %1 scripted flows against %2 with concurrency %3 on %4 thread(s)")
+                       .arg(m_config.flows).arg(m_config.issuerURL).arg(m_managers.size())
+                       .arg(qMax(1, int(m_threads.size()))));
+    }
+
+    for (OIDCManager* manager : m_managers) {
+        if (!wantsMoreFlows()) break;
+        launchFlow(manager);
+    }
+
+    if (m_started == 0) {
+        m_running = false;
+        emit finished();
+    }
+}
+
+void LoadRunner::stop()
+{
+    if (!m_running) return;
+
+    // Let in-flight flows finish; just stop issuing new ones
+    m_running = false;
+    if (m_completed + m_failed == m_started) {
+        emit finished();
+    }
+}
+
+bool LoadRunner::wantsMoreFlows() const
+{
+    if (m_config.durationMs > 0) {
+        return m_runTimer.elapsed() < m_config.durationMs;
+    }
+    return m_started < m_config.flows;
+}
+
+void LoadRunner::launchFlow(OIDCManager* manager)
+{
+    int index = m_started++;
+
+    // Paced runs start flow n no earlier than n / rate into the run; the
+    // concurrency limit still applies, so a slow provider lowers the rate
+    if (m_config.ratePerSecond > 0) {
+        qint64 dueMs = qint64(index * 1000.0 / m_config.ratePerSecond);
+        qint64 delayMs = dueMs - m_runTimer.elapsed();
+        if (delayMs > 0) {
+            m_active.insert(manager);
+            QTimer::singleShot(delayMs, this, [this, manager]() { startFlow(manager); });
+            return;
+        }
+    }
+
+    startFlow(manager);
+}
+
+void LoadRunner::startFlow(OIDCManager* manager)
+{
+    m_active.insert(manager);
+
+    if (m_scenario) {
+        VirtualUser& user = m_users[manager];
+        user.step = m_scenario->pickEntry();
+        user.busyUs = 0;
+        scheduleStep(manager);
+        return;
+    }
+
+    // Runs on the manager's thread (queued when that is a worker thread)
+    OIDCConfig config = m_config;
+    bool* reported = &m_reported[m_slots.value(manager)];
+    QMetaObject::invokeMethod(manager, [manager, config, reported]() {
+        *reported = false;
+        manager->startAuthentication(config);
+    }, Qt::QueuedConnection);
+}
+
+void LoadRunner::scheduleStep(OIDCManager* manager)
+{
+    const Scenario::Step& step = m_scenario->step(m_users[manager].step);
+    int thinkMs = step.thinkMaxMs > step.thinkMinMs
+        ? int(QRandomGenerator::global()->bounded(step.thinkMinMs, step.thinkMaxMs + 1))
+        : step.thinkMinMs;
+
+    if (thinkMs > 0) {
+        QTimer::singleShot(thinkMs, this, [this, manager]() { runStep(manager); });
+    } else {
+        runStep(manager);
+    }
+}
+
+void LoadRunner::runStep(OIDCManager* manager)
+{
+    VirtualUser& user = m_users[manager];
+    user.awaiting = true;
+
+    // Steps are looked up by index on the manager's thread; the table is immutable during a run
+    const Scenario* scenario = m_scenario;
+    int index = user.step;
+    bool* reported = &m_reported[m_slots.value(manager)];
+    QMetaObject::invokeMethod(manager, [manager, scenario, index, reported]() {
+        *reported = false;
+        const Scenario::Step& step = scenario->step(index);
+        switch (step.action) {
+        case Scenario::Login:
+        case Scenario::StepUp:
+            manager->startAuthentication(step.config);
+            break;
+        case Scenario::Refresh:
+            manager->refreshSession();
+            break;
+        case Scenario::Revoke:
+            manager->revokeSession(step.tokenTypeHint);
+            break;
+        }
+    }, Qt::QueuedConnection);
+}
+
+void LoadRunner::publishFlow(OIDCManager* manager, bool* reported, bool success, const QString& error)
+{
+    // Worker thread: the manager is idle until this thread asks for the next flow.
+    // Only the first outcome counts; a late error after tokens must not feed the
+    // ring, the rules or the token statistics a second time.
+    if (*reported) return;
+    *reported = true;
+
+    const FlowTimings& timings = manager->lastFlowTimings();
+
+    FlowSample sample;
+    sample.totalUs = manager->flowElapsedUs();
+    sample.finishedUs = m_runTimer.nsecsElapsed() / 1000;
+    sample.discoveryUs = timings.discoveryUs;
+    sample.authorizeUs = timings.authorizeUs;
+    sample.tokenUs = timings.tokenUs;
+    sample.success = success;
+
+    // Revocations issue no tokens; refreshes carry no new code or nonce
+    const OIDCManager::FlowKind kind = manager->lastFlowKind();
+    if (!success) {
+        // Classified by the first phase that did not complete
+        if (kind != OIDCManager::LoginFlow) {
+            sample.errorClass = FlowResult::SessionError;
+        } else if (timings.discoveryUs < 0) {
+            sample.errorClass = FlowResult::DiscoveryError;
+        } else if (timings.authorizeUs < 0) {
+            sample.errorClass = FlowResult::AuthorizeError;
+        } else {
+            sample.errorClass = FlowResult::TokenError;
+        }
+    }
+
+    if (success && kind != OIDCManager::RevokeFlow && (m_rules || m_uniqueness || m_tokenAnalytics || m_results)) {
+        const JsonObjectView& tokens = manager->lastTokenResponseView();
+        QString idToken = tokens.string(QLatin1String("id_token"));
+        QString accessToken = tokens.string(QLatin1String("access_token"));
+        QString refreshToken = tokens.string(QLatin1String("refresh_token"));
+        sample.tokenBytes = quint32(idToken.size() + accessToken.size() + refreshToken.size());
+
+        if (m_rules) {
+            m_rules->evaluate(idToken, accessToken);
+        }
+
+        if (m_uniqueness) {
+            ClaimSet claims;
+            ClaimExtractor::extractFromJWT(idToken, claimBit(Claim::Jti) | claimBit(Claim::Nonce), &claims);
+            m_uniqueness->observe(UniquenessChecker::Jti, claims.string(Claim::Jti).toUtf8());
+            if (kind == OIDCManager::LoginFlow) {
+                m_uniqueness->observe(UniquenessChecker::Code, manager->lastAuthorizationCode().toUtf8());
+                m_uniqueness->observe(UniquenessChecker::Nonce, claims.string(Claim::Nonce).toUtf8());
+            }
+
+            ClaimExtractor::extractFromJWT(accessToken, claimBit(Claim::Jti), &claims);
+            m_uniqueness->observe(UniquenessChecker::Jti, claims.string(Claim::Jti).toUtf8());
+        }
+
+        if (m_tokenAnalytics) {
+            m_tokenAnalytics->observe(TokenAnalytics::IdToken, idToken);
+            m_tokenAnalytics->observe(TokenAnalytics::AccessToken, accessToken);
+            m_tokenAnalytics->observe(TokenAnalytics::RefreshToken, refreshToken);
+        }
+    }
+
+    if (m_sampleRing) {
+        m_sampleRing->tryPush(sample);
+    }
+
+    QMetaObject::invokeMethod(this, [this, manager, sample, error]() {
+        finishFlow(manager, sample, error);
+    });
+}
+
+void LoadRunner::finishFlow(OIDCManager* manager, const FlowSample& sample, const QString& error)
+{
+    if (m_scenario) {
+        finishStep(manager, sample, error);
+        return;
+    }
+
+    // A flow reports exactly once; ignore late signals from an already finished one
+    if (!m_active.contains(manager)) return;
+    completeFlow(manager, sample, error);
+}
+
+void LoadRunner::finishStep(OIDCManager* manager, const FlowSample& sample, const QString& error)
+{
+    // A step reports exactly once; ignore late signals from an already finished one
+    VirtualUser& user = m_users[manager];
+    if (!user.awaiting) return;
+    user.awaiting = false;
+
+    const Scenario::Step& step = m_scenario->step(user.step);
+    if (sample.success) {
+        m_stepHistograms[user.step].record(sample.totalUs);
+    } else {
+        ++m_stepFailures[user.step];
+    }
+    user.busyUs += sample.totalUs;
+
+    // Stopping ends iterations at the next step boundary
+    if (sample.success && step.next >= 0 && m_running) {
+        user.step = step.next;
+        scheduleStep(manager);
+        return;
+    }
+
+    FlowSample iteration = sample;
+    iteration.totalUs = user.busyUs;
+    completeFlow(manager, iteration, error.isEmpty() ? error : QString("%1: %2").arg(step.label, error));
+}
+
+void LoadRunner::completeFlow(OIDCManager* manager, const FlowSample& sample, const QString& error)
+{
+    m_active.remove(manager);
+
+    qint64 elapsedMs = sample.totalUs / 1000;
+    if (sample.success) {
+        ++m_completed;
+        m_flowHistogram.record(sample.totalUs);
+    } else {
+        ++m_failed;
+        emit logMessage(QString("Flow failed after %1 ms: %2").arg(elapsedMs).arg(error));
+    }
+    emit flowFinished(sample.success, elapsedMs, error);
+
+    if (m_results) {
+        auto clampUs = [](qint64 valueUs) {
+            return qint32(qBound<qint64>(-1, valueUs, std::numeric_limits<qint32>::max()));
+        };
+        FlowResult row;
+        row.finishedUs = sample.finishedUs;
+        row.discoveryUs = clampUs(sample.discoveryUs);
+        row.authorizeUs = clampUs(sample.authorizeUs);
+        row.tokenUs = clampUs(sample.tokenUs);
+        row.totalUs = clampUs(sample.totalUs);
+        row.tokenBytes = sample.tokenBytes;
+        row.errorClass = sample.success ? FlowResult::NoError : sample.errorClass;
+        m_results->append(row);
+    }
+
+    if (m_running && wantsMoreFlows()) {
+        launchFlow(manager);
+    } else if (m_completed + m_failed == m_started) {
+        m_running = false;
+        emit finished();
+    }
+}
+
+quint64 LoadRunner::ruleViolations() const
+{
+    quint64 total = 0;
+    for (int rule = 0; m_rules && rule < m_rules->ruleCount(); ++rule) {
+        total += m_rules->violations(rule);
+    }
+    return total;
+}
+
+quint64 LoadRunner::duplicateValues() const
+{
+    return m_uniqueness ? m_uniqueness->totalDuplicates() : 0;
+}
+
+QString LoadRunner::summary() const
+{
+    double seconds = m_runTimer.isValid() ? m_runTimer.elapsed() / 1000.0 : 0.0;
+    double rate = seconds > 0 ? (m_completed + m_failed) / seconds : 0.0;
+
+    return QString("Flows: %1 completed, %2 failed in %3 s (%4 flows/s), "
+                   "flow latency mean %5 ms, p50 %6 ms, p95 %7 ms, p99 %8 ms, max %9 ms")
+        .arg(m_completed)
+        .arg(m_failed)
+        .arg(seconds, 0, 'f', 2)
+        .arg(rate, 0, 'f', 1)
+        .arg(m_flowHistogram.mean() / 1000.0, 0, 'f', 1)
+        .arg(m_flowHistogram.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_flowHistogram.percentile(95) / 1000.0, 0, 'f', 1)
+        .arg(m_flowHistogram.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(m_flowHistogram.max() / 1000.0, 0, 'f', 1)
+        + stepSummary()
+        + (m_rules && !m_rules->isEmpty() ? "\n" + m_rules->summary() : QString())
+        + (m_uniqueness ? "\n" + m_uniqueness->summary() : QString())
+        + (m_tokenAnalytics ? "\n" + m_tokenAnalytics->summary() : QString())
+        + (m_retryPolicy && m_retryPolicy->requests() > 0 ? "\n" + m_retryPolicy->summary() : QString())
+        + (m_networkStats ? "\n" + m_networkStats->summary() : QString())
+        + (m_tlsSessionCache ? "\n" + m_tlsSessionCache->summary() : QString())
+        + (!m_config.clientAssertionKey.isEmpty() ? "\n" + ClientAssertionPool::shared()->summary() : QString());
+}
+
+QString LoadRunner::stepSummary() const
+{
+    if (!m_scenario) return QString();
+
+    QString result = QString("\nScenario \"%1\" steps:").arg(m_scenario->name());
+    for (int i = 0; i < m_stepHistograms.size(); ++i) {
+        const LatencyHistogram& histogram = m_stepHistograms[i];
+        result += QString("\n  %1 %2 ok, %3 failed, p50 %4 ms, p95 %5 ms, max %6 ms")
+            .arg(m_scenario->step(i).label + ":", -32)
+            .arg(histogram.count())
+            .arg(m_stepFailures[i])
+            .arg(histogram.percentile(50) / 1000.0, 0, 'f', 1)
+            .arg(histogram.percentile(95) / 1000.0, 0, 'f', 1)
+            .arg(histogram.max() / 1000.0, 0, 'f', 1);
+    }
+    return result;
+}
@@ -0,0 +1,173 @@
+#ifndef LOADRUNNER_H
+#define LOADRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include "LatencyHistogram.h"
+#include "MetricsRing.h"
+#include "OIDCManager.h"
+#include "ResultsFile.h"
+
+class ExchangeRecorder;
+class QThread;
+
+// One finished flow, as published by the worker thread that ran it
+struct FlowSample
+{
+    qint64 finishedUs = 0;      // since the start of the run
+    qint64 discoveryUs = -1;
+    qint64 authorizeUs = -1;
+    qint64 tokenUs = -1;
+    qint64 totalUs = 0;
+    bool success = false;
+    FlowResult::ErrorClass errorClass = FlowResult::NoError;
+    quint32 tokenBytes = 0;     // only measured with a results writer
+};
+
+typedef MetricsRing<FlowSample, 65536> FlowSampleRing;
+
+struct OIDCProfile;
+class ClaimRules;
+class UniquenessChecker;
+class TokenAnalytics;
+class Scenario;
+class RetryPolicy;
+class TlsSessionCache;
+
+// Flow parameters plus run shape for unattended (scripted) flows
+struct LoadConfig : public OIDCConfig
+{
+    QString loginFormFields;
+
+    int flows = 100;
+    int concurrency = 1;
+    int threads = 1;         // worker threads the concurrent flows are spread over
+    qint64 durationMs = 0;   // when > 0, run for this long instead of a fixed flow count
+    double ratePerSecond = 0; // when > 0, cap flow starts at this rate
+
+    static LoadConfig fromProfile(const OIDCProfile& profile);
+
+    // Reads a profile persisted by the GUI (empty name = last used profile)
+    static LoadConfig fromSettings(const QString& profileName = QString());
+};
+
+// Repeats complete flows with the scripted authorizer, keeping up to
+// `concurrency` flows in flight until `flows` have finished. With threads > 1
+// the flows' OIDCManagers live on worker threads; each finished flow is
+// published from its worker into the optional sample ring.
+//
+// With a scenario, each OIDCManager is a virtual user walking the compiled
+// step table and a "flow" is one pass through a weighted pick of its flows;
+// every step is published as a sample and timed on its own.
+class LoadRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoadRunner(const LoadConfig& config, QObject *parent = nullptr);
+    ~LoadRunner();
+
+    void start();
+    void stop();
+
+    // Not owned; shared by all concurrent flows
+    void setRecorder(ExchangeRecorder* recorder);
+
+    // Not owned; must be set before start() and outlive the run
+    void setSampleRing(FlowSampleRing* ring) { m_sampleRing = ring; }
+
+    // Not owned; evaluated against every issued token on the flow's thread
+    void setRules(ClaimRules* rules) { m_rules = rules; }
+
+    // Not owned; fed the jti, authorization code and nonce of every flow
+    void setUniquenessChecker(UniquenessChecker* checker) { m_uniqueness = checker; }
+
+    // Not owned; fed every issued token, reset when a run starts
+    void setTokenAnalytics(TokenAnalytics* analytics) { m_tokenAnalytics = analytics; }
+
+    // Not owned; shared by all concurrent flows for their refresh requests
+    void setRetryPolicy(RetryPolicy* policy);
+
+    // Not owned; fed the connection timing breakdown of every request, reset when a run starts
+    void setNetworkTimingStats(NetworkTimingStats* stats);
+
+    // Not owned; session tickets shared by all managers, handshake statistics reset when a run starts
+    void setTlsSessionCache(TlsSessionCache* cache);
+
+    // Not owned; every finished flow is appended as one row
+    void setResultsWriter(ResultsWriter* writer) { m_results = writer; }
+
+    // Not owned; must be set before start() and outlive the run
+    void setScenario(const Scenario* scenario);
+
+    bool isRunning() const { return m_running; }
+    const LatencyHistogram& flowHistogram() const { return m_flowHistogram; }
+    int completedFlows() const { return m_completed; }
+    int failedFlows() const { return m_failed; }
+    qint64 elapsedMs() const { return m_runTimer.isValid() ? m_runTimer.elapsed() : 0; }
+
+    // Rule violations over all rules and repeated jti/code/nonce values; 0 when not checked
+    quint64 ruleViolations() const;
+    quint64 duplicateValues() const;
+
+    QString summary() const;
+    QString stepSummary() const;
+
+signals:
+    void flowFinished(bool success, qint64 elapsedMs, const QString& error);
+    void finished();
+    void logMessage(const QString& message);
+
+private:
+    bool wantsMoreFlows() const;
+    void launchFlow(OIDCManager* manager);
+    void startFlow(OIDCManager* manager);
+    void scheduleStep(OIDCManager* manager);
+    void runStep(OIDCManager* manager);
+    void publishFlow(OIDCManager* manager, bool* reported, bool success, const QString& error);
+    void finishFlow(OIDCManager* manager, const FlowSample& sample, const QString& error);
+    void finishStep(OIDCManager* manager, const FlowSample& sample, const QString& error);
+    void completeFlow(OIDCManager* manager, const FlowSample& sample, const QString& error);
+
+    // Scenario position of one virtual user (this thread only)
+    struct VirtualUser
+    {
+        int step = -1;
+        bool awaiting = false;
+        qint64 busyUs = 0;      // summed step latency, think time excluded
+    };
+
+    LoadConfig m_config;
+    QList<QThread*> m_threads;
+    QList<OIDCManager*> m_managers;
+    QSet<OIDCManager*> m_active;
+    QHash<OIDCManager*, int> m_slots;   // index into m_reported; fixed after construction
+    std::unique_ptr<bool[]> m_reported;   // touched only on the manager's thread
+    FlowSampleRing* m_sampleRing;
+    ClaimRules* m_rules;
+    UniquenessChecker* m_uniqueness;
+    TokenAnalytics* m_tokenAnalytics;
+    ResultsWriter* m_results;
+    RetryPolicy* m_retryPolicy;
+    NetworkTimingStats* m_networkStats;
+    TlsSessionCache* m_tlsSessionCache;
+    const Scenario* m_scenario;
+    QHash<OIDCManager*, VirtualUser> m_users;
+    QVector<LatencyHistogram> m_stepHistograms;
+    QVector<int> m_stepFailures;
+    QElapsedTimer m_runTimer;
+    LatencyHistogram m_flowHistogram;
+    int m_started;
+    int m_completed;
+    int m_failed;
+    bool m_running;
+};
+
+#endif // LOADRUNNER_H
@@ -0,0 +1,82 @@
+#include "LoadWorker.h"
+#include "LoadRunner.h"
+#include <QLocalSocket>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+
+LoadWorker::LoadWorker(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QLocalSocket(this))
+{
+}
+
+bool LoadWorker::connectToCoordinator(const QString& serverName, WorkerAssignment* assignment,
+                                      QString* error, int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+
+    m_socket->connectToServer(serverName);
+    if (!m_socket->waitForConnected(int(deadline.remainingTime()))) {
+        if (error) *error = QString("Cannot connect to coordinator %1: %2").arg(serverName, m_socket->errorString());
+        return false;
+    }
+
+    QByteArray hello;
+    QDataStream out(&hello, QIODevice::WriteOnly);
+    out.setVersion(CoordinatorProtocol::STREAM_VERSION);
+    out << quint8(CoordinatorProtocol::Hello) << qint64(QCoreApplication::applicationPid());
+    m_socket->write(hello);
+    m_socket->flush();
+
+    QDataStream in(m_socket);
+    in.setVersion(CoordinatorProtocol::STREAM_VERSION);
+
+    for (;;) {
+        in.startTransaction();
+        quint8 type = 0;
+        WorkerAssignment received;
+        in >> type >> received;
+        if (in.commitTransaction()) {
+            if (type != CoordinatorProtocol::Assign) {
+                if (error) *error = QString("Unexpected message %1 from coordinator").arg(type);
+                return false;
+            }
+            *assignment = received;
+            return true;
+        }
+
+        if (deadline.hasExpired() || !m_socket->waitForReadyRead(int(deadline.remainingTime()))) {
+            if (error) {
+                *error = m_socket->state() == QLocalSocket::ConnectedState
+                    ? QString("No assignment from coordinator within %1 s").arg(timeoutMs / 1000)
+                    : QString("Coordinator closed the connection before assigning work");
+            }
+            return false;
+        }
+    }
+}
+
+bool LoadWorker::sendResult(const LoadRunner& runner, QString* error)
+{
+    QByteArray result;
+    QDataStream out(&result, QIODevice::WriteOnly);
+    out.setVersion(CoordinatorProtocol::STREAM_VERSION);
+    out << quint8(CoordinatorProtocol::Result)
+        << qint32(runner.completedFlows())
+        << qint32(runner.failedFlows())
+        << runner.elapsedMs()
+        << runner.ruleViolations()
+        << runner.duplicateValues()
+        << runner.flowHistogram()
+        << runner.summary();
+
+    m_socket->write(result);
+    while (m_socket->bytesToWrite() > 0) {
+        if (!m_socket->waitForBytesWritten(10 * 1000)) {
+            if (error) *error = QString("Cannot send result to coordinator: %1").arg(m_socket->errorString());
+            return false;
+        }
+    }
+    m_socket->disconnectFromServer();
+    return true;
+}
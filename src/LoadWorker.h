@@ -0,0 +1,33 @@
+#ifndef LOADWORKER_H
+#define LOADWORKER_H
+
+#include <QObject>
+#include <QString>
+#include "LoadCoordinator.h"
+
+class QLocalSocket;
+class LoadRunner;
+
+// Worker side of LoadCoordinator: announces itself, receives its share of
+// the run and, once its LoadRunner has finished, sends back the counts,
+// check totals, flow histogram and summary.
+class LoadWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoadWorker(QObject *parent = nullptr);
+
+    // Blocks until the coordinator has sent this worker's assignment, which
+    // happens only once every expected worker has connected
+    bool connectToCoordinator(const QString& serverName, WorkerAssignment* assignment,
+                              QString* error, int timeoutMs = 120 * 1000);
+
+    // Blocks until the result has been written
+    bool sendResult(const LoadRunner& runner, QString* error = nullptr);
+
+private:
+    QLocalSocket* m_socket;
+};
+
+#endif // LOADWORKER_H
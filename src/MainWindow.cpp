@@ -1,11 +1,22 @@
 #include "MainWindow.h"
 #include "JWTDecoder.h"
+#include "Authorizer.h"
+#include "ScriptedAuthorizer.h"
+#include "MetricsChart.h"
+#include "ClaimTreeModel.h"
+#include "DiscoveryCache.h"
+#include "PostLoginInspector.h"
+#include "StartupTimer.h"
+#include "StallWatchdog.h"
+#include "TlsSessionCache.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QScrollArea>
-#include <QSettings>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QSignalBlocker>
 #include <QFont>
 #include <QFontMetrics>
 #include <QPalette>
@@ -15,22 +26,150 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_tabWidget(new QTabWidget(this))
-    , m_oidcManager(new OIDCManager(this))
+    , m_oidcManager(nullptr)
+    , m_discoveryCache(nullptr)
+    , m_postLoginInspector(nullptr)
+    , m_recorder(nullptr)
+    , m_metricsTimer(new QTimer(this))
+    , m_stallWatchdog(new StallWatchdog(100, this))
+    , m_loadRunner(nullptr)
+    , m_sampleRing(new FlowSampleRing())
+    , m_windowFlows(0)
+    , m_windowErrors(0)
     , m_isAuthenticating(false)
+    , m_tokensTabBuilt(false)
+    , m_logsTabBuilt(false)
+    , m_firstFrameShown(false)
 {
+    // Network objects (OIDC manager, discovery cache, post-login inspector)
+    // are created on first use; nothing touches the network before the
+    // first frame
+    connect(m_stallWatchdog, &StallWatchdog::stallDetected, this, &MainWindow::onStallDetected);
+
     setupUI();
+    StartupTimer::mark("UI built");
     loadSettings();
-
-    // Connect OIDC manager signals
-    connect(m_oidcManager, &OIDCManager::progressUpdated, this, &MainWindow::onProgressUpdated);
-    connect(m_oidcManager, &OIDCManager::errorOccurred, this, &MainWindow::onErrorOccurred);
-    connect(m_oidcManager, &OIDCManager::tokensReceived, this, &MainWindow::onTokensReceived);
-    connect(m_oidcManager, &OIDCManager::logMessage, this, &MainWindow::onLogMessage);
+    StartupTimer::mark("settings loaded");
 }
 
 MainWindow::~MainWindow()
 {
     saveSettings();
+
+    // Worker threads publish into the ring, so they must be gone before it is
+    delete m_loadRunner;
+    delete m_sampleRing;
+}
+
+void MainWindow::setRecorder(ExchangeRecorder* recorder)
+{
+    m_recorder = recorder;
+    if (m_oidcManager) {
+        m_oidcManager->setRecorder(recorder);
+    }
+}
+
+void MainWindow::setStallThreshold(int thresholdMs)
+{
+    m_stallWatchdog->setThresholdMs(thresholdMs);
+}
+
+OIDCManager* MainWindow::oidcManager()
+{
+    if (!m_oidcManager) {
+        m_oidcManager = new OIDCManager(this);
+        connect(m_oidcManager, &OIDCManager::progressUpdated, this, &MainWindow::onProgressUpdated);
+        connect(m_oidcManager, &OIDCManager::errorOccurred, this, &MainWindow::onErrorOccurred);
+        connect(m_oidcManager, &OIDCManager::tokensReceived, this, &MainWindow::onTokensReceived);
+        connect(m_oidcManager, &OIDCManager::logMessage, this, &MainWindow::onLogMessage);
+        m_oidcManager->setDiscoveryCache(discoveryCache());
+        m_oidcManager->setRecorder(m_recorder);
+        m_oidcManager->setTlsSessionCache(TlsSessionCache::shared());
+    }
+    return m_oidcManager;
+}
+
+DiscoveryCache* MainWindow::discoveryCache()
+{
+    if (!m_discoveryCache) {
+        m_discoveryCache = new DiscoveryCache(this);
+        connect(m_discoveryCache, &DiscoveryCache::logMessage, this, &MainWindow::onLogMessage);
+    }
+    return m_discoveryCache;
+}
+
+PostLoginInspector* MainWindow::postLoginInspector()
+{
+    if (!m_postLoginInspector) {
+        m_postLoginInspector = new PostLoginInspector(this);
+        connect(m_postLoginInspector, &PostLoginInspector::logMessage, this, &MainWindow::onLogMessage);
+        connect(m_postLoginInspector, &PostLoginInspector::finished, this, &MainWindow::onPostLoginChecksFinished);
+    }
+    return m_postLoginInspector;
+}
+
+void MainWindow::paintEvent(QPaintEvent* event)
+{
+    QMainWindow::paintEvent(event);
+
+    if (!m_firstFrameShown) {
+        m_firstFrameShown = true;
+        StartupTimer::mark("first frame");
+        QTimer::singleShot(0, this, &MainWindow::onFirstFrameShown);
+    }
+}
+
+void MainWindow::onFirstFrameShown()
+{
+    // Warm discovery and JWKS for every profile so the first flow skips them
+    discoveryCache()->prefetch(m_profileStore.issuerURLs());
+    StartupTimer::mark("deferred init");
+    m_stallWatchdog->start();
+
+    for (const QString& line : StartupTimer::report().split('\n')) {
+        onLogMessage(line.trimmed());
+    }
+    emit startupCompleted();
+}
+
+void MainWindow::onStallDetected(qint64 durationUs, const QString& phase)
+{
+    m_stallLabel->setText(m_stallWatchdog->summary());
+    onLogMessage(QString("GUI event loop stalled for %1 ms in %2").arg(durationUs / 1000.0, 0, 'f', 1).arg(phase));
+}
+
+void MainWindow::onTabChanged(int index)
+{
+    QWidget* tab = m_tabWidget->widget(index);
+    if (tab == m_tokensTab) {
+        ensureTokensTab();
+    } else if (tab == m_logsTab) {
+        ensureLogsTab();
+    }
+}
+
+void MainWindow::ensureTokensTab()
+{
+    if (m_tokensTabBuilt) return;
+    StallWatchdog::PhaseScope phase("build Tokens tab");
+    m_tokensTabBuilt = true;
+    createTokensTab();
+}
+
+void MainWindow::ensureLogsTab()
+{
+    if (m_logsTabBuilt) return;
+    StallWatchdog::PhaseScope phase("build Logs tab");
+    m_logsTabBuilt = true;
+    createLogsTab();
+
+    if (!m_pendingLogs.isEmpty()) {
+        m_logsList->addItems(m_pendingLogs);
+        m_logsList->scrollToBottom();
+        m_pendingLogs.clear();
+        m_logsEmptyWidget->hide();
+        m_logsContentWidget->show();
+    }
 }
 
 void MainWindow::setupUI()
@@ -50,8 +189,15 @@ void MainWindow::setupUI()
     
     createConfigTab();
     createAuthenticationTab();
-    createTokensTab();
-    createLogsTab();
+
+    // Tokens and Logs are filled in on first activation (or first content)
+    m_tokensTab = new QWidget();
+    m_tabWidget->addTab(m_tokensTab, "🔐 Tokens");
+    m_logsTab = new QWidget();
+    m_tabWidget->addTab(m_logsTab, "📄 Logs");
+
+    createMetricsTab();
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, &MainWindow::onTabChanged);
     
     setCentralWidget(m_tabWidget);
 }
@@ -105,6 +251,18 @@ void MainWindow::createConfigTab()
     
     QFormLayout* oidcLayout = new QFormLayout();
     oidcLayout->setSpacing(16);
+
+    m_profileCombo = new QComboBox();
+    connect(m_profileCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onProfileChanged);
+    QPushButton* saveProfileButton = new QPushButton("Save As...");
+    connect(saveProfileButton, &QPushButton::clicked, this, &MainWindow::onSaveProfileAs);
+    QPushButton* deleteProfileButton = new QPushButton("Delete");
+    connect(deleteProfileButton, &QPushButton::clicked, this, &MainWindow::onDeleteProfile);
+    QHBoxLayout* profileLayout = new QHBoxLayout();
+    profileLayout->addWidget(m_profileCombo, 1);
+    profileLayout->addWidget(saveProfileButton);
+    profileLayout->addWidget(deleteProfileButton);
+    oidcLayout->addRow("Profile:", profileLayout);
     
     m_issuerURLEdit = new QLineEdit();
     m_issuerURLEdit->setPlaceholderText("https://your-oidc-provider.com");
@@ -118,6 +276,22 @@ void MainWindow::createConfigTab()
     m_clientSecretEdit->setEchoMode(QLineEdit::Password);
     m_clientSecretEdit->setPlaceholderText("Enter client secret if required");
     oidcLayout->addRow("Client Secret (Optional):", m_clientSecretEdit);
+
+    m_clientCertificateEdit = new QLineEdit();
+    m_clientCertificateEdit->setPlaceholderText("PEM file for mutual TLS at the token endpoint");
+    oidcLayout->addRow("Client Certificate (Optional):", m_clientCertificateEdit);
+
+    m_clientKeyEdit = new QLineEdit();
+    m_clientKeyEdit->setPlaceholderText("PEM private key, if not in the certificate file");
+    oidcLayout->addRow("Client Key (Optional):", m_clientKeyEdit);
+
+    m_clientAssertionKeyEdit = new QLineEdit();
+    m_clientAssertionKeyEdit->setPlaceholderText("PEM RSA or P-256 key for private_key_jwt (replaces the secret)");
+    oidcLayout->addRow("Assertion Signing Key (Optional):", m_clientAssertionKeyEdit);
+
+    m_clientAssertionKeyIdEdit = new QLineEdit();
+    m_clientAssertionKeyIdEdit->setPlaceholderText("kid of the signing key as registered with the IdP");
+    oidcLayout->addRow("Assertion Key ID (Optional):", m_clientAssertionKeyIdEdit);
     
     m_acrValueCombo = new QComboBox();
     m_acrValueCombo->addItems({"None", "SSO (com:imprivata:oidc:epic:sso)", "EPCS (com:imprivata:oidc:epic:cw:epcs)"});
@@ -139,6 +313,8 @@ void MainWindow::createConfigTab()
     QVBoxLayout* securityLayout = new QVBoxLayout();
     securityLayout->addWidget(m_skipStateValidationCheck);
     securityLayout->addWidget(m_disablePKCECheck);
+    m_useDpopCheck = new QCheckBox("Request DPoP-bound tokens (RFC 9449)");
+    securityLayout->addWidget(m_useDpopCheck);
     securityLayout->setSpacing(4);
     oidcLayout->addRow("Security:", securityLayout);
 
@@ -170,6 +346,32 @@ void MainWindow::createConfigTab()
     m_extraParamsEdit->setPlaceholderText("key1=value1&key2=value2");
     oidcLayout->addRow("Extra Parameters (Optional):", m_extraParamsEdit);
 
+    m_authorizerCombo = new QComboBox();
+    m_authorizerCombo->addItems({"Browser (Chrome incognito)", "Scripted (no browser)"});
+    QLabel* authorizerHelp = new QLabel("Scripted follows redirects and submits the login form itself, so flows can repeat unattended");
+    authorizerHelp->setStyleSheet("QLabel { color: #888888; font-size: 10px; font-style: italic; }");
+    authorizerHelp->setWordWrap(true);
+    QVBoxLayout* authorizerLayout = new QVBoxLayout();
+    authorizerLayout->addWidget(m_authorizerCombo);
+    authorizerLayout->addWidget(authorizerHelp);
+    authorizerLayout->setSpacing(4);
+    oidcLayout->addRow("Authorizer:", authorizerLayout);
+
+    m_loginFormFieldsEdit = new QLineEdit();
+    m_loginFormFieldsEdit->setPlaceholderText("username=alice&password=secret");
+    oidcLayout->addRow("Login Form Fields (Scripted):", m_loginFormFieldsEdit);
+
+    m_useTokenCacheCheck = new QCheckBox("Reuse cached tokens while valid, refreshing when close to expiry");
+    QPushButton* clearTokenCacheButton = new QPushButton("Clear");
+    connect(clearTokenCacheButton, &QPushButton::clicked, this, &MainWindow::onClearTokenCache);
+    QHBoxLayout* tokenCacheLayout = new QHBoxLayout();
+    tokenCacheLayout->addWidget(m_useTokenCacheCheck, 1);
+    tokenCacheLayout->addWidget(clearTokenCacheButton);
+    oidcLayout->addRow("Token Cache:", tokenCacheLayout);
+
+    m_postLoginChecksCheck = new QCheckBox("Query userinfo, introspection and JWKS in parallel after login");
+    oidcLayout->addRow("Post-Login Checks:", m_postLoginChecksCheck);
+
     oidcGroup->setLayout(oidcLayout);
     scrollLayout->addWidget(oidcGroup);
 
@@ -370,8 +572,7 @@ void MainWindow::createAuthenticationTab()
 
 void MainWindow::createTokensTab()
 {
-    QWidget* tokensTab = new QWidget();
-    QVBoxLayout* mainLayout = new QVBoxLayout(tokensTab);
+    QVBoxLayout* mainLayout = new QVBoxLayout(m_tokensTab);
     mainLayout->setContentsMargins(32, 32, 32, 32);
     mainLayout->setSpacing(20);
 
@@ -467,15 +668,44 @@ void MainWindow::createTokensTab()
     decodedGroup->setStyleSheet("QGroupBox { color: #34C759; }");
     QVBoxLayout* decodedLayout = new QVBoxLayout();
 
-    m_decodedTokensText = new QTextEdit();
-    m_decodedTokensText->setReadOnly(true);
-    m_decodedTokensText->setFont(QFont("Monospace", 10));
-    m_decodedTokensText->setStyleSheet("QTextEdit { background-color: #F5F5F5; border-radius: 8px; padding: 16px; }");
-    decodedLayout->addWidget(m_decodedTokensText);
+    // Claims are expanded and fetched on demand; uniform rows keep scrolling
+    // through very large arrays cheap
+    m_claimTreeModel = new ClaimTreeModel(this);
+    m_decodedTokensView = new QTreeView();
+    m_decodedTokensView->setModel(m_claimTreeModel);
+    m_decodedTokensView->setUniformRowHeights(true);
+    m_decodedTokensView->setAlternatingRowColors(true);
+    m_decodedTokensView->setMinimumHeight(320);
+    m_decodedTokensView->setFont(QFont("Monospace", 10));
+    m_decodedTokensView->setStyleSheet("QTreeView { background-color: #F5F5F5; border-radius: 8px; padding: 8px; }");
+    m_decodedTokensView->header()->setSectionResizeMode(ClaimTreeModel::KeyColumn, QHeaderView::ResizeToContents);
+    m_decodedTokensView->header()->setSectionResizeMode(ClaimTreeModel::ValueColumn, QHeaderView::Stretch);
+    m_decodedTokensView->header()->setSectionResizeMode(ClaimTreeModel::TypeColumn, QHeaderView::ResizeToContents);
+    m_decodedTokensView->header()->setStretchLastSection(false);
+    decodedLayout->addWidget(m_decodedTokensView);
+
+    m_decodedTokensEmptyLabel = new QLabel("No JWT tokens to decode.");
+    m_decodedTokensEmptyLabel->hide();
+    decodedLayout->addWidget(m_decodedTokensEmptyLabel);
 
     decodedGroup->setLayout(decodedLayout);
     scrollLayout->addWidget(decodedGroup);
 
+    // Post-login checks group (shown once checks have run)
+    m_postLoginGroup = new QGroupBox("Post-Login Checks");
+    m_postLoginGroup->setStyleSheet("QGroupBox { color: #34C759; }");
+    QVBoxLayout* postLoginLayout = new QVBoxLayout();
+
+    m_postLoginText = new QTextEdit();
+    m_postLoginText->setReadOnly(true);
+    m_postLoginText->setFont(QFont("Monospace", 10));
+    m_postLoginText->setStyleSheet("QTextEdit { background-color: #F5F5F5; border-radius: 8px; padding: 16px; }");
+    postLoginLayout->addWidget(m_postLoginText);
+
+    m_postLoginGroup->setLayout(postLoginLayout);
+    m_postLoginGroup->hide();
+    scrollLayout->addWidget(m_postLoginGroup);
+
     scrollArea->setWidget(scrollWidget);
     contentLayout->addWidget(scrollArea);
 
@@ -483,14 +713,11 @@ void MainWindow::createTokensTab()
 
     mainLayout->addWidget(m_tokensEmptyWidget);
     mainLayout->addWidget(m_tokensContentWidget);
-
-    m_tabWidget->addTab(tokensTab, "🔐 Tokens");
 }
 
 void MainWindow::createLogsTab()
 {
-    QWidget* logsTab = new QWidget();
-    QVBoxLayout* mainLayout = new QVBoxLayout(logsTab);
+    QVBoxLayout* mainLayout = new QVBoxLayout(m_logsTab);
     mainLayout->setContentsMargins(32, 32, 32, 32);
     mainLayout->setSpacing(20);
 
@@ -593,8 +820,114 @@ void MainWindow::createLogsTab()
 
     // Initially hide content widget, show empty widget
     m_logsContentWidget->hide();
+}
+
+void MainWindow::createMetricsTab()
+{
+    QWidget* metricsTab = new QWidget();
+    QVBoxLayout* mainLayout = new QVBoxLayout(metricsTab);
+    mainLayout->setContentsMargins(32, 32, 32, 32);
+    mainLayout->setSpacing(20);
+
+    // Header
+    QHBoxLayout* headerLayout = new QHBoxLayout();
+    QLabel* iconLabel = new QLabel("📈");
+    QFont iconFont = iconLabel->font();
+    iconFont.setPointSize(24);
+    iconLabel->setFont(iconFont);
+
+    QLabel* titleLabel = new QLabel("Metrics");
+    QFont titleFont = titleLabel->font();
+    titleFont.setPointSize(20);
+    titleFont.setBold(true);
+    titleLabel->setFont(titleFont);
+
+    headerLayout->addWidget(iconLabel);
+    headerLayout->addWidget(titleLabel);
+    headerLayout->addStretch();
+    mainLayout->addLayout(headerLayout);
+
+    // Divider
+    QFrame* divider = new QFrame();
+    divider->setFrameShape(QFrame::HLine);
+    divider->setStyleSheet("background-color: rgba(90, 200, 250, 0.3);");
+    mainLayout->addWidget(divider);
 
-    m_tabWidget->addTab(logsTab, "📄 Logs");
+    // Load run controls
+    QGroupBox* loadGroup = new QGroupBox("Load Run");
+    loadGroup->setStyleSheet("QGroupBox { background-color: rgba(255, 255, 255, 150); color: #5AC8FA; }");
+    QHBoxLayout* loadLayout = new QHBoxLayout();
+    loadLayout->setSpacing(16);
+
+    m_loadFlowsSpin = new QSpinBox();
+    m_loadFlowsSpin->setRange(1, 10000000);
+    m_loadFlowsSpin->setValue(1000);
+    m_loadConcurrencySpin = new QSpinBox();
+    m_loadConcurrencySpin->setRange(1, 1024);
+    m_loadConcurrencySpin->setValue(4);
+    m_loadThreadsSpin = new QSpinBox();
+    m_loadThreadsSpin->setRange(1, 64);
+    m_loadThreadsSpin->setValue(1);
+
+    loadLayout->addWidget(new QLabel("Flows:"));
+    loadLayout->addWidget(m_loadFlowsSpin);
+    loadLayout->addWidget(new QLabel("Concurrency:"));
+    loadLayout->addWidget(m_loadConcurrencySpin);
+    loadLayout->addWidget(new QLabel("Threads:"));
+    loadLayout->addWidget(m_loadThreadsSpin);
+    loadLayout->addStretch();
+
+    m_loadStartButton = new QPushButton("Start Load Run");
+    m_loadStartButton->setMinimumHeight(32);
+    m_loadStartButton->setStyleSheet("QPushButton { background-color: #5AC8FA; color: white; "
+                                    "border-radius: 6px; padding: 6px 16px; font-weight: bold; }"
+                                    "QPushButton:hover { background-color: #3BAFE0; }");
+    connect(m_loadStartButton, &QPushButton::clicked, this, &MainWindow::onStartStopLoad);
+    loadLayout->addWidget(m_loadStartButton);
+
+    loadGroup->setLayout(loadLayout);
+    mainLayout->addWidget(loadGroup);
+
+    QLabel* loadHelp = new QLabel("Runs scripted (browserless) flows with the Config tab settings and Login Form Fields.");
+    loadHelp->setStyleSheet("QLabel { color: #888888; font-size: 10px; font-style: italic; }");
+    loadHelp->setWordWrap(true);
+    mainLayout->addWidget(loadHelp);
+
+    // Live metrics
+    QGroupBox* liveGroup = new QGroupBox("Live Metrics");
+    liveGroup->setStyleSheet("QGroupBox { background-color: rgba(255, 255, 255, 150); color: #5AC8FA; }");
+    QVBoxLayout* liveLayout = new QVBoxLayout();
+
+    m_metricsSummaryLabel = new QLabel("No load run yet");
+    m_metricsSummaryLabel->setFont(QFont("Monospace", 10));
+    liveLayout->addWidget(m_metricsSummaryLabel);
+
+    m_phaseLatencyLabel = new QLabel();
+    m_phaseLatencyLabel->setFont(QFont("Monospace", 10));
+    m_phaseLatencyLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    liveLayout->addWidget(m_phaseLatencyLabel);
+
+    m_stallLabel = new QLabel("No GUI stalls recorded");
+    m_stallLabel->setFont(QFont("Monospace", 10));
+    m_stallLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_stallLabel->setToolTip("Event loop latency of this window, measured by a heartbeat timer and a monitor thread");
+    liveLayout->addWidget(m_stallLabel);
+
+    m_throughputChart = new MetricsChart("Throughput", "per second");
+    m_throughputChart->setSeries({"flows/s", "errors/s"}, {QColor("#34C759"), QColor("#FF3B30")});
+    liveLayout->addWidget(m_throughputChart);
+
+    m_latencyChart = new MetricsChart("Flow latency", "ms");
+    m_latencyChart->setSeries({"p50", "p95", "p99"}, {QColor("#007AFF"), QColor("#FF9500"), QColor("#AF52DE")});
+    liveLayout->addWidget(m_latencyChart);
+
+    liveGroup->setLayout(liveLayout);
+    mainLayout->addWidget(liveGroup, 1);
+
+    m_metricsTimer->setInterval(250);
+    connect(m_metricsTimer, &QTimer::timeout, this, &MainWindow::onMetricsTick);
+
+    m_tabWidget->addTab(metricsTab, "📈 Metrics");
 }
 
 void MainWindow::onBeginAuthentication()
@@ -628,25 +961,41 @@ void MainWindow::onBeginAuthentication()
     // Extract response type from combo box (e.g., "code" from "code (Authorization Code Flow)")
     QString responseType = m_responseTypeCombo->currentText().split(" ").first();
 
+    if (m_authorizerCombo->currentIndex() == 1) {
+        ScriptedAuthorizer* authorizer = new ScriptedAuthorizer();
+        authorizer->setFormFields(m_loginFormFieldsEdit->text().trimmed());
+        oidcManager()->setAuthorizer(authorizer);
+    } else {
+        oidcManager()->setAuthorizer(new BrowserAuthorizer());
+    }
+    oidcManager()->setTokenCache(m_useTokenCacheCheck->isChecked() ? &m_tokenCache : nullptr);
+
     // Start authentication
-    m_oidcManager->startAuthentication(
-        m_issuerURLEdit->text().trimmed(),
-        m_clientIDEdit->text().trimmed(),
-        m_clientSecretEdit->text().trimmed(),
-        m_scopesEdit->text().trimmed(),
-        m_acrValueCombo->currentText(),
-        m_loginHintEdit->text().trimmed(),
-        m_promptLoginCheck->isChecked(),
-        responseType,
-        m_extraParamsEdit->text().trimmed(),
-        m_skipStateValidationCheck->isChecked(),
-        m_disablePKCECheck->isChecked()
-    );
+    OIDCConfig config;
+    config.issuerURL = m_issuerURLEdit->text().trimmed();
+    config.clientID = m_clientIDEdit->text().trimmed();
+    config.clientSecret = m_clientSecretEdit->text().trimmed();
+    config.scopes = m_scopesEdit->text().trimmed();
+    config.acrValue = m_acrValueCombo->currentText();
+    config.loginHint = m_loginHintEdit->text().trimmed();
+    config.promptLogin = m_promptLoginCheck->isChecked();
+    config.responseType = responseType;
+    config.extraParams = m_extraParamsEdit->text().trimmed();
+    config.skipStateValidation = m_skipStateValidationCheck->isChecked();
+    config.disablePKCE = m_disablePKCECheck->isChecked();
+    config.useDpop = m_useDpopCheck->isChecked();
+    config.clientCertificate = m_clientCertificateEdit->text().trimmed();
+    config.clientKey = m_clientKeyEdit->text().trimmed();
+    config.clientAssertionKey = m_clientAssertionKeyEdit->text().trimmed();
+    config.clientAssertionKeyId = m_clientAssertionKeyIdEdit->text().trimmed();
+    oidcManager()->startAuthentication(config);
 }
 
 void MainWindow::onCancelAuthentication()
 {
-    m_oidcManager->cancelAuthentication();
+    if (m_oidcManager) {
+        m_oidcManager->cancelAuthentication();
+    }
 
     m_isAuthenticating = false;
     m_authIdleWidget->show();
@@ -674,17 +1023,21 @@ void MainWindow::onErrorOccurred(const QString& error)
 
 void MainWindow::onTokensReceived(const QString& tokens)
 {
+    StallWatchdog::PhaseScope phase("onTokensReceived");
     m_currentTokens = tokens;
+    ensureTokensTab();
 
     // Update raw tokens
     m_rawTokensText->setPlainText(tokens);
 
     // Update decoded tokens
-    QString decoded = getDecodedTokenDetails();
+    QList<QPair<QString, QString>> decoded = getDecodedTokens();
+    m_claimTreeModel->setTokens(decoded);
+    m_decodedTokensView->setVisible(!decoded.isEmpty());
+    m_decodedTokensEmptyLabel->setVisible(decoded.isEmpty());
     if (!decoded.isEmpty()) {
-        m_decodedTokensText->setPlainText(decoded);
-    } else {
-        m_decodedTokensText->setPlainText("No JWT tokens to decode.");
+        // One level deep: header/payload/signature rows, claims still unfetched
+        m_decodedTokensView->expandToDepth(0);
     }
 
     // Show tokens content
@@ -700,10 +1053,44 @@ void MainWindow::onTokensReceived(const QString& tokens)
     m_authActiveWidget->hide();
     m_beginAuthButton->setEnabled(true);
     m_authBeginButton->setEnabled(true);
+
+    m_postLoginGroup->hide();
+    if (m_postLoginChecksCheck->isChecked()) {
+        QJsonObject discovery;
+        if (discoveryCache()->lookup(m_issuerURLEdit->text(), &discovery)) {
+            m_postLoginText->setPlainText("Running post-login checks...");
+            m_postLoginGroup->show();
+            const QJsonObject tokens = m_oidcManager->lastTokenResponse();
+            const bool dpopBound = tokens["token_type"].toString().compare("DPoP", Qt::CaseInsensitive) == 0;
+            postLoginInspector()->inspect(discovery,
+                                          discoveryCache()->jwks(m_issuerURLEdit->text()),
+                                          tokens["access_token"].toString(),
+                                          m_clientIDEdit->text().trimmed(),
+                                          m_clientSecretEdit->text().trimmed(),
+                                          m_oidcManager->usesClientAssertion(),
+                                          dpopBound ? m_oidcManager->dpopProofs() : nullptr);
+        } else {
+            onLogMessage("Post-login checks skipped: no discovery document available for this issuer");
+        }
+    }
+}
+
+void MainWindow::onPostLoginChecksFinished(const QList<InspectionCall>& calls, qint64 totalMs)
+{
+    StallWatchdog::PhaseScope phase("onPostLoginChecksFinished");
+    m_postLoginText->setPlainText(PostLoginInspector::formatReport(calls, totalMs));
+    m_postLoginGroup->show();
 }
 
 void MainWindow::onLogMessage(const QString& message)
 {
+    StallWatchdog::PhaseScope phase("onLogMessage");
+    // Buffered until the Logs tab is first opened
+    if (!m_logsTabBuilt) {
+        m_pendingLogs.append("● " + message);
+        return;
+    }
+
     // Add to logs list
     m_logsList->addItem("● " + message);
     m_logsList->scrollToBottom();
@@ -715,80 +1102,283 @@ void MainWindow::onLogMessage(const QString& message)
     }
 }
 
-QString MainWindow::getDecodedTokenDetails()
+LoadConfig MainWindow::currentLoadConfig() const
+{
+    LoadConfig config = LoadConfig::fromProfile(profileFromWidgets());
+    config.flows = m_loadFlowsSpin->value();
+    config.concurrency = m_loadConcurrencySpin->value();
+    config.threads = m_loadThreadsSpin->value();
+    return config;
+}
+
+void MainWindow::onStartStopLoad()
+{
+    if (m_loadRunner && m_loadRunner->isRunning()) {
+        m_loadRunner->stop();
+        m_loadStartButton->setText("Stopping...");
+        m_loadStartButton->setEnabled(false);
+        return;
+    }
+
+    LoadConfig config = currentLoadConfig();
+    if (config.issuerURL.isEmpty() || config.clientID.isEmpty()) {
+        m_metricsSummaryLabel->setText("Please enter an Issuer URL and Client ID on the Config tab");
+        return;
+    }
+
+    if (m_loadRunner) {
+        delete m_loadRunner;
+        m_loadRunner = nullptr;
+    }
+
+    // Drop anything a previous run left behind
+    FlowSample stale;
+    while (m_sampleRing->tryPop(stale)) {
+    }
+
+    m_loadRunner = new LoadRunner(config, this);
+    m_loadRunner->setSampleRing(m_sampleRing);
+    connect(m_loadRunner, &LoadRunner::logMessage, this, &MainWindow::onLogMessage);
+    connect(m_loadRunner, &LoadRunner::finished, this, &MainWindow::onLoadFinished);
+
+    m_windowTotal.reset();
+    m_windowDiscovery.reset();
+    m_windowAuthorize.reset();
+    m_windowToken.reset();
+    m_windowFlows = 0;
+    m_windowErrors = 0;
+    m_throughputChart->clear();
+    m_latencyChart->clear();
+    m_windowClock.start();
+    m_metricsTimer->start();
+
+    m_loadStartButton->setText("Stop Load Run");
+    m_loadRunner->start();
+}
+
+void MainWindow::onLoadFinished()
+{
+    StallWatchdog::PhaseScope phase("onLoadFinished");
+    onMetricsTick();
+    m_metricsTimer->stop();
+
+    m_loadStartButton->setText("Start Load Run");
+    m_loadStartButton->setEnabled(true);
+    m_stallLabel->setText(m_stallWatchdog->summary());
+    onLogMessage(m_loadRunner->summary());
+    onLogMessage(m_stallWatchdog->summary());
+}
+
+void MainWindow::onMetricsTick()
+{
+    StallWatchdog::PhaseScope phase("onMetricsTick");
+    FlowSample sample;
+    while (m_sampleRing->tryPop(sample)) {
+        ++m_windowFlows;
+        if (!sample.success) {
+            ++m_windowErrors;
+            continue;
+        }
+        m_windowTotal.record(sample.totalUs);
+        m_windowDiscovery.record(sample.discoveryUs);
+        m_windowAuthorize.record(sample.authorizeUs);
+        m_windowToken.record(sample.tokenUs);
+    }
+
+    if (!m_loadRunner) return;
+
+    m_metricsSummaryLabel->setText(QString("Completed: %1   Failed: %2   Dropped samples: %3")
+                                   .arg(m_loadRunner->completedFlows())
+                                   .arg(m_loadRunner->failedFlows())
+                                   .arg(m_sampleRing->droppedCount()));
+
+    // Charts and percentiles advance once per second
+    qint64 windowMs = m_windowClock.elapsed();
+    if (windowMs < 1000 && m_loadRunner->isRunning()) return;
+
+    double seconds = qMax<qint64>(1, windowMs) / 1000.0;
+    m_throughputChart->addPoint({m_windowFlows / seconds, m_windowErrors / seconds});
+    m_latencyChart->addPoint({m_windowTotal.percentile(50) / 1000.0,
+                              m_windowTotal.percentile(95) / 1000.0,
+                              m_windowTotal.percentile(99) / 1000.0});
+
+    auto phaseRow = [](const QString& name, const LatencyHistogram& histogram) {
+        return QString("%1 p50 %2  p95 %3  p99 %4 ms\n")
+            .arg(name, -10)
+            .arg(histogram.percentile(50) / 1000.0, 8, 'f', 1)
+            .arg(histogram.percentile(95) / 1000.0, 8, 'f', 1)
+            .arg(histogram.percentile(99) / 1000.0, 8, 'f', 1);
+    };
+    double errorRate = m_windowFlows > 0 ? 100.0 * m_windowErrors / m_windowFlows : 0.0;
+    m_phaseLatencyLabel->setText(QString("Last %1 s: %2 flows/s, error rate %3%\n")
+                                     .arg(seconds, 0, 'f', 1)
+                                     .arg(m_windowFlows / seconds, 0, 'f', 1)
+                                     .arg(errorRate, 0, 'f', 1) +
+                                 phaseRow("discovery", m_windowDiscovery) +
+                                 phaseRow("authorize", m_windowAuthorize) +
+                                 phaseRow("token", m_windowToken) +
+                                 phaseRow("total", m_windowTotal));
+
+    m_windowTotal.reset();
+    m_windowDiscovery.reset();
+    m_windowAuthorize.reset();
+    m_windowToken.reset();
+    m_windowFlows = 0;
+    m_windowErrors = 0;
+    m_windowClock.restart();
+}
+
+QList<QPair<QString, QString>> MainWindow::getDecodedTokens() const
 {
+    QList<QPair<QString, QString>> tokens;
     if (m_currentTokens.isEmpty()) {
-        return QString();
+        return tokens;
     }
 
-    QString result;
     QStringList lines = m_currentTokens.split('\n');
 
     for (const QString& line : lines) {
         if (line.startsWith("ID Token: ")) {
             QString tokenValue = line.mid(QString("ID Token: ").length()).trimmed();
             if (!tokenValue.isEmpty()) {
-                result += "=== ID TOKEN DETAILS ===\n";
-                result += JWTDecoder::formatTokenDetails(tokenValue);
-                result += "\n";
+                tokens.append(qMakePair(QString("ID Token"), tokenValue));
             }
         } else if (line.startsWith("Access Token: ")) {
             QString tokenValue = line.mid(QString("Access Token: ").length()).trimmed();
             if (!tokenValue.isEmpty()) {
-                result += "=== ACCESS TOKEN DETAILS ===\n";
-                result += JWTDecoder::formatTokenDetails(tokenValue);
-                result += "\n";
+                tokens.append(qMakePair(QString("Access Token"), tokenValue));
             }
         }
     }
 
-    return result;
+    return tokens;
 }
 
 void MainWindow::loadSettings()
 {
-    QSettings settings;
+    m_profileStore.load();
+    refreshProfileCombo();
+    applyProfile(m_profileStore.current());
+}
+
+void MainWindow::saveSettings()
+{
+    m_profileStore.setProfile(profileFromWidgets());
+    m_profileStore.save();
+}
 
-    m_issuerURLEdit->setText(settings.value("issuerURL", "").toString());
-    m_clientIDEdit->setText(settings.value("clientID", "").toString());
-    m_clientSecretEdit->setText(settings.value("clientSecret", "").toString());
-    m_acrValueCombo->setCurrentText(settings.value("acrValue", "None").toString());
-    m_loginHintEdit->setText(settings.value("loginHint", "").toString());
-    m_promptLoginCheck->setChecked(settings.value("promptLogin", false).toBool());
-    m_skipStateValidationCheck->setChecked(settings.value("skipStateValidation", false).toBool());
-    m_disablePKCECheck->setChecked(settings.value("disablePKCE", false).toBool());
-    m_scopesEdit->setText(settings.value("scopes", "openid profile email").toString());
+OIDCProfile MainWindow::profileFromWidgets() const
+{
+    OIDCProfile profile;
+    profile.name = m_profileStore.currentName();
+    profile.issuerURL = m_issuerURLEdit->text();
+    profile.clientID = m_clientIDEdit->text();
+    profile.clientSecret = m_clientSecretEdit->text();
+    profile.acrValue = m_acrValueCombo->currentText();
+    profile.loginHint = m_loginHintEdit->text();
+    profile.promptLogin = m_promptLoginCheck->isChecked();
+    profile.skipStateValidation = m_skipStateValidationCheck->isChecked();
+    profile.disablePKCE = m_disablePKCECheck->isChecked();
+    profile.useDpop = m_useDpopCheck->isChecked();
+    profile.clientCertificate = m_clientCertificateEdit->text();
+    profile.clientKey = m_clientKeyEdit->text();
+    profile.clientAssertionKey = m_clientAssertionKeyEdit->text();
+    profile.clientAssertionKeyId = m_clientAssertionKeyIdEdit->text();
+    profile.scopes = m_scopesEdit->text();
 
-    // Load response type and find matching combo item
-    QString savedResponseType = settings.value("responseType", "code").toString();
+    // Save just the response type value (e.g., "code" from "code (Authorization Code Flow)")
+    profile.responseType = m_responseTypeCombo->currentText().split(" ").first();
+
+    profile.extraParams = m_extraParamsEdit->text();
+    profile.authorizer = m_authorizerCombo->currentIndex() == 1 ? "scripted" : "browser";
+    profile.loginFormFields = m_loginFormFieldsEdit->text();
+    profile.useTokenCache = m_useTokenCacheCheck->isChecked();
+    profile.postLoginChecks = m_postLoginChecksCheck->isChecked();
+    return profile;
+}
+
+void MainWindow::applyProfile(const OIDCProfile& profile)
+{
+    m_issuerURLEdit->setText(profile.issuerURL);
+    m_clientIDEdit->setText(profile.clientID);
+    m_clientSecretEdit->setText(profile.clientSecret);
+    m_acrValueCombo->setCurrentText(profile.acrValue);
+    m_loginHintEdit->setText(profile.loginHint);
+    m_promptLoginCheck->setChecked(profile.promptLogin);
+    m_skipStateValidationCheck->setChecked(profile.skipStateValidation);
+    m_disablePKCECheck->setChecked(profile.disablePKCE);
+    m_useDpopCheck->setChecked(profile.useDpop);
+    m_clientCertificateEdit->setText(profile.clientCertificate);
+    m_clientKeyEdit->setText(profile.clientKey);
+    m_clientAssertionKeyEdit->setText(profile.clientAssertionKey);
+    m_clientAssertionKeyIdEdit->setText(profile.clientAssertionKeyId);
+    m_scopesEdit->setText(profile.scopes);
+
+    // Find the combo item matching the saved response type
     for (int i = 0; i < m_responseTypeCombo->count(); ++i) {
-        if (m_responseTypeCombo->itemText(i).startsWith(savedResponseType + " ")) {
+        if (m_responseTypeCombo->itemText(i).startsWith(profile.responseType + " ")) {
             m_responseTypeCombo->setCurrentIndex(i);
             break;
         }
     }
 
-    m_extraParamsEdit->setText(settings.value("extraParams", "").toString());
+    m_extraParamsEdit->setText(profile.extraParams);
+    m_authorizerCombo->setCurrentIndex(profile.authorizer == "scripted" ? 1 : 0);
+    m_loginFormFieldsEdit->setText(profile.loginFormFields);
+    m_useTokenCacheCheck->setChecked(profile.useTokenCache);
+    m_postLoginChecksCheck->setChecked(profile.postLoginChecks);
 }
 
-void MainWindow::saveSettings()
+void MainWindow::refreshProfileCombo()
 {
-    QSettings settings;
+    QSignalBlocker blocker(m_profileCombo);
+    m_profileCombo->clear();
+    m_profileCombo->addItems(m_profileStore.names());
+    m_profileCombo->setCurrentText(m_profileStore.currentName());
+}
 
-    settings.setValue("issuerURL", m_issuerURLEdit->text());
-    settings.setValue("clientID", m_clientIDEdit->text());
-    settings.setValue("clientSecret", m_clientSecretEdit->text());
-    settings.setValue("acrValue", m_acrValueCombo->currentText());
-    settings.setValue("loginHint", m_loginHintEdit->text());
-    settings.setValue("promptLogin", m_promptLoginCheck->isChecked());
-    settings.setValue("skipStateValidation", m_skipStateValidationCheck->isChecked());
-    settings.setValue("disablePKCE", m_disablePKCECheck->isChecked());
-    settings.setValue("scopes", m_scopesEdit->text());
+void MainWindow::onProfileChanged(int index)
+{
+    if (index < 0) return;
 
-    // Save just the response type value (e.g., "code" from "code (Authorization Code Flow)")
-    QString responseType = m_responseTypeCombo->currentText().split(" ").first();
-    settings.setValue("responseType", responseType);
+    // Keep edits to the profile being left, then switch in memory
+    m_profileStore.setProfile(profileFromWidgets());
+    m_profileStore.setCurrentName(m_profileCombo->itemText(index));
+    applyProfile(m_profileStore.current());
+    m_configErrorLabel->hide();
 
-    settings.setValue("extraParams", m_extraParamsEdit->text());
+    discoveryCache()->prefetch({m_profileStore.current().issuerURL});
+}
+
+void MainWindow::onSaveProfileAs()
+{
+    bool ok = false;
+    QString name = QInputDialog::getText(this, "Save Profile", "Profile name:", QLineEdit::Normal,
+                                         m_profileStore.currentName(), &ok).trimmed();
+    if (!ok || name.isEmpty()) return;
+
+    OIDCProfile profile = profileFromWidgets();
+    profile.name = name;
+    m_profileStore.setProfile(profile);
+    m_profileStore.setCurrentName(name);
+    m_profileStore.save();
+    refreshProfileCombo();
+
+    discoveryCache()->prefetch({profile.issuerURL});
+}
+
+void MainWindow::onClearTokenCache()
+{
+    int count = m_tokenCache.size();
+    m_tokenCache.clear();
+    onLogMessage(QString("Cleared %1 cached token set(s)").arg(count));
+}
+
+void MainWindow::onDeleteProfile()
+{
+    m_profileStore.removeProfile(m_profileStore.currentName());
+    m_profileStore.save();
+    refreshProfileCombo();
+    applyProfile(m_profileStore.current());
 }
 
@@ -10,7 +10,24 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QListWidget>
+#include <QGroupBox>
+#include <QSpinBox>
+#include <QTimer>
+#include <QTreeView>
+#include <QElapsedTimer>
+#include <QStringList>
 #include "OIDCManager.h"
+#include "LoadRunner.h"
+#include "LatencyHistogram.h"
+#include "ProfileStore.h"
+#include "TokenCache.h"
+
+class MetricsChart;
+class ClaimTreeModel;
+class StallWatchdog;
+class DiscoveryCache;
+class PostLoginInspector;
+struct InspectionCall;
 
 class MainWindow : public QMainWindow
 {
@@ -20,6 +37,16 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    void setRecorder(ExchangeRecorder* recorder);
+    void setStallThreshold(int thresholdMs);
+
+signals:
+    // Emitted once deferred initialisation after the first frame is done
+    void startupCompleted();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
 private slots:
     void onBeginAuthentication();
     void onCancelAuthentication();
@@ -27,6 +54,17 @@ private slots:
     void onErrorOccurred(const QString& error);
     void onTokensReceived(const QString& tokens);
     void onLogMessage(const QString& message);
+    void onStartStopLoad();
+    void onLoadFinished();
+    void onMetricsTick();
+    void onProfileChanged(int index);
+    void onSaveProfileAs();
+    void onDeleteProfile();
+    void onClearTokenCache();
+    void onPostLoginChecksFinished(const QList<InspectionCall>& calls, qint64 totalMs);
+    void onTabChanged(int index);
+    void onFirstFrameShown();
+    void onStallDetected(qint64 durationUs, const QString& phase);
 
 private:
     void setupUI();
@@ -34,25 +72,50 @@ private:
     void createAuthenticationTab();
     void createTokensTab();
     void createLogsTab();
+    void createMetricsTab();
+    void ensureTokensTab();
+    void ensureLogsTab();
+    OIDCManager* oidcManager();
+    DiscoveryCache* discoveryCache();
+    PostLoginInspector* postLoginInspector();
+    LoadConfig currentLoadConfig() const;
+    OIDCProfile profileFromWidgets() const;
+    void applyProfile(const OIDCProfile& profile);
+    void refreshProfileCombo();
     void loadSettings();
     void saveSettings();
-    QString getDecodedTokenDetails();
+    QList<QPair<QString, QString>> getDecodedTokens() const;
     
     QTabWidget* m_tabWidget;
     OIDCManager* m_oidcManager;
+    DiscoveryCache* m_discoveryCache;
+    PostLoginInspector* m_postLoginInspector;
+    ExchangeRecorder* m_recorder;
+    ProfileStore m_profileStore;
+    TokenCache m_tokenCache;
     
     // Config tab widgets
+    QComboBox* m_profileCombo;
     QLineEdit* m_issuerURLEdit;
     QLineEdit* m_clientIDEdit;
     QLineEdit* m_clientSecretEdit;
+    QLineEdit* m_clientCertificateEdit;
+    QLineEdit* m_clientKeyEdit;
+    QLineEdit* m_clientAssertionKeyEdit;
+    QLineEdit* m_clientAssertionKeyIdEdit;
     QComboBox* m_acrValueCombo;
     QLineEdit* m_loginHintEdit;
     QCheckBox* m_promptLoginCheck;
     QCheckBox* m_skipStateValidationCheck;
     QCheckBox* m_disablePKCECheck;
+    QCheckBox* m_useDpopCheck;
     QLineEdit* m_scopesEdit;
     QComboBox* m_responseTypeCombo;
     QLineEdit* m_extraParamsEdit;
+    QComboBox* m_authorizerCombo;
+    QLineEdit* m_loginFormFieldsEdit;
+    QCheckBox* m_useTokenCacheCheck;
+    QCheckBox* m_postLoginChecksCheck;
     QLabel* m_redirectURILabel;
     QPushButton* m_beginAuthButton;
     QLabel* m_configErrorLabel;
@@ -66,19 +129,53 @@ private:
     QWidget* m_authIdleWidget;
     QWidget* m_authActiveWidget;
     
-    // Tokens tab widgets
+    // Tokens tab widgets (built on first activation)
+    QWidget* m_tokensTab;
     QTextEdit* m_rawTokensText;
-    QTextEdit* m_decodedTokensText;
+    QTreeView* m_decodedTokensView;
+    ClaimTreeModel* m_claimTreeModel;
+    QLabel* m_decodedTokensEmptyLabel;
+    QGroupBox* m_postLoginGroup;
+    QTextEdit* m_postLoginText;
     QWidget* m_tokensEmptyWidget;
     QWidget* m_tokensContentWidget;
     
-    // Logs tab widgets
+    // Logs tab widgets (built on first activation)
+    QWidget* m_logsTab;
     QListWidget* m_logsList;
     QWidget* m_logsEmptyWidget;
     QWidget* m_logsContentWidget;
     
+    // Metrics tab widgets
+    QSpinBox* m_loadFlowsSpin;
+    QSpinBox* m_loadConcurrencySpin;
+    QSpinBox* m_loadThreadsSpin;
+    QPushButton* m_loadStartButton;
+    QLabel* m_metricsSummaryLabel;
+    QLabel* m_phaseLatencyLabel;
+    QLabel* m_stallLabel;
+    MetricsChart* m_throughputChart;
+    MetricsChart* m_latencyChart;
+    QTimer* m_metricsTimer;
+    StallWatchdog* m_stallWatchdog;
+
+    // Load run state; the ring is drained by m_metricsTimer
+    LoadRunner* m_loadRunner;
+    FlowSampleRing* m_sampleRing;
+    LatencyHistogram m_windowTotal;
+    LatencyHistogram m_windowDiscovery;
+    LatencyHistogram m_windowAuthorize;
+    LatencyHistogram m_windowToken;
+    int m_windowFlows;
+    int m_windowErrors;
+    QElapsedTimer m_windowClock;
+
     bool m_isAuthenticating;
     QString m_currentTokens;
+    bool m_tokensTabBuilt;
+    bool m_logsTabBuilt;
+    QStringList m_pendingLogs;
+    bool m_firstFrameShown;
 };
 
 #endif // MAINWINDOW_H
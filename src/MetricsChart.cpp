@@ -0,0 +1,103 @@
+#include "MetricsChart.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QFontMetrics>
+
+MetricsChart::MetricsChart(const QString& title, const QString& unit, QWidget *parent)
+    : QWidget(parent)
+    , m_title(title)
+    , m_unit(unit)
+    , m_capacity(120)
+{
+    setMinimumHeight(180);
+}
+
+void MetricsChart::setSeries(const QStringList& names, const QList<QColor>& colors)
+{
+    m_names = names;
+    m_colors = colors;
+    clear();
+}
+
+void MetricsChart::addPoint(const QVector<double>& values)
+{
+    m_points.append(values);
+    while (m_points.size() > m_capacity) {
+        m_points.removeFirst();
+    }
+    update();
+}
+
+void MetricsChart::clear()
+{
+    m_points.clear();
+    update();
+}
+
+void MetricsChart::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(255, 255, 255, 200));
+
+    QFontMetrics metrics(font());
+    const int titleHeight = metrics.height() + 8;
+    const QRect plot = rect().adjusted(56, titleHeight, -12, -20);
+
+    // Title and legend
+    painter.setPen(QColor("#333333"));
+    painter.drawText(QPoint(8, metrics.ascent() + 4), QString("%1 (%2)").arg(m_title, m_unit));
+    int legendX = width() - 12;
+    for (int i = m_names.size() - 1; i >= 0; --i) {
+        int textWidth = metrics.horizontalAdvance(m_names[i]);
+        legendX -= textWidth;
+        painter.setPen(m_colors.value(i, Qt::black));
+        painter.drawText(QPoint(legendX, metrics.ascent() + 4), m_names[i]);
+        legendX -= 16;
+    }
+
+    double maxValue = 0.0;
+    for (const QVector<double>& point : m_points) {
+        for (double value : point) {
+            maxValue = qMax(maxValue, value);
+        }
+    }
+    if (maxValue <= 0.0) {
+        maxValue = 1.0;
+    }
+    maxValue *= 1.1;
+
+    // Axes and grid
+    painter.setPen(QColor(128, 128, 128, 80));
+    for (int i = 0; i <= 4; ++i) {
+        int y = plot.bottom() - plot.height() * i / 4;
+        painter.drawLine(plot.left(), y, plot.right(), y);
+        painter.drawText(QRect(0, y - metrics.height() / 2, plot.left() - 6, metrics.height()),
+                         Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(maxValue * i / 4, 'f', maxValue < 10 ? 1 : 0));
+    }
+
+    if (m_points.size() < 2) {
+        return;
+    }
+
+    const double stepX = double(plot.width()) / (m_capacity - 1);
+    const double startX = plot.right() - stepX * (m_points.size() - 1);
+
+    for (int series = 0; series < m_names.size(); ++series) {
+        QPainterPath path;
+        for (int i = 0; i < m_points.size(); ++i) {
+            double value = m_points[i].value(series);
+            QPointF point(startX + stepX * i, plot.bottom() - plot.height() * (value / maxValue));
+            if (i == 0) {
+                path.moveTo(point);
+            } else {
+                path.lineTo(point);
+            }
+        }
+        painter.setPen(QPen(m_colors.value(series, Qt::black), 2));
+        painter.drawPath(path);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef METRICSCHART_H
+#define METRICSCHART_H
+
+#include <QWidget>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QColor>
+
+// Lightweight scrolling line chart: one point per series per tick, the last
+// `capacity` ticks are kept and the Y axis autoscales to what is visible.
+class MetricsChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsChart(const QString& title, const QString& unit, QWidget *parent = nullptr);
+
+    void setSeries(const QStringList& names, const QList<QColor>& colors);
+    void addPoint(const QVector<double>& values);
+    void clear();
+
+    QSize sizeHint() const override { return QSize(480, 200); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    QString m_title;
+    QString m_unit;
+    QStringList m_names;
+    QList<QColor> m_colors;
+    QList<QVector<double>> m_points;
+    int m_capacity;
+};
+
+#endif // METRICSCHART_H
@@ -0,0 +1,89 @@
+#ifndef METRICSRING_H
+#define METRICSRING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free MPSC ring (Vyukov's sequence-numbered cells). Producers on
+// any thread push without blocking; when the consumer falls behind, pushes
+// fail and the caller counts a drop instead of stalling the flow.
+template <typename T, size_t Capacity>
+class MetricsRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MetricsRing()
+        : m_cells(new Cell[Capacity])
+        , m_enqueuePos(0)
+        , m_dequeuePos(0)
+        , m_dropped(0)
+    {
+        for (size_t i = 0; i < Capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MetricsRing(const MetricsRing&) = delete;
+    MetricsRing& operator=(const MetricsRing&) = delete;
+
+    // Safe from any number of threads
+    bool tryPush(const T& value)
+    {
+        Cell* cell;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & (Capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Single consumer only
+    bool tryPop(T& value)
+    {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = &m_cells[pos & (Capacity - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (intptr_t(sequence) - intptr_t(pos + 1) < 0) {
+            return false;
+        }
+
+        value = cell->value;
+        cell->sequence.store(pos + Capacity, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+    alignas(64) std::atomic<quint64> m_dropped;
+};
+
+#endif // METRICSRING_H
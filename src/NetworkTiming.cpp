@@ -0,0 +1,208 @@
+#include "NetworkTiming.h"
+#include <QNetworkReply>
+#include <QMutexLocker>
+#include <QStringList>
+
+static QString formatUs(qint64 valueUs)
+{
+    return valueUs < 0 ? QString("-") : QString("%1 ms").arg(valueUs / 1000.0, 0, 'f', 1);
+}
+
+QString RequestTimings::toString() const
+{
+    return QString("dns %1, connect%2 %3, send %4, ttfb %5, transfer %6, total %7 (%8 connection%9)")
+        .arg(formatUs(dnsUs))
+        .arg(encrypted ? "+tls" : "")
+        .arg(formatUs(connectUs))
+        .arg(formatUs(sendUs))
+        .arg(formatUs(ttfbUs))
+        .arg(formatUs(transferUs))
+        .arg(formatUs(totalUs))
+        .arg(connectionReused ? "reused" : "new")
+        .arg(encrypted ? (connectionReused ? ", TLS session kept" : ", TLS handshake") : "");
+}
+
+ReplyTimer::ReplyTimer(QNetworkReply* reply)
+    : QObject(reply)
+    , m_connectingNs(-1)
+    , m_encryptedNs(-1)
+    , m_sentNs(-1)
+    , m_firstByteNs(-1)
+    , m_finishedNs(-1)
+    , m_encrypted(false)
+{
+    m_clock.start();
+
+    // socketStartedConnecting and requestSent appeared in Qt 6.3; older
+    // versions leave dns and send at -1
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this]() {
+        m_connectingNs = m_clock.nsecsElapsed();
+    });
+    connect(reply, &QNetworkReply::requestSent, this, [this]() {
+        m_sentNs = m_clock.nsecsElapsed();
+    });
+#endif
+    connect(reply, &QNetworkReply::encrypted, this, [this]() {
+        m_encryptedNs = m_clock.nsecsElapsed();
+        m_encrypted = true;
+    });
+
+    // Headers (metaDataChanged) normally arrive first; a bare readyRead also counts
+    auto firstByte = [this]() {
+        if (m_firstByteNs < 0) {
+            m_firstByteNs = m_clock.nsecsElapsed();
+        }
+    };
+    connect(reply, &QNetworkReply::metaDataChanged, this, firstByte);
+    connect(reply, &QNetworkReply::readyRead, this, firstByte);
+    connect(reply, &QNetworkReply::finished, this, [this]() {
+        m_finishedNs = m_clock.nsecsElapsed();
+    });
+}
+
+void ReplyTimer::attach(QNetworkReply* reply)
+{
+    new ReplyTimer(reply);
+}
+
+RequestTimings ReplyTimer::timingsOf(QNetworkReply* reply)
+{
+    ReplyTimer* timer = reply ? reply->findChild<ReplyTimer*>(QString(), Qt::FindDirectChildrenOnly) : nullptr;
+    if (!timer) return RequestTimings();
+
+    RequestTimings timings = timer->timings();
+    if (reply->url().scheme() == QLatin1String("https")) {
+        timings.encrypted = true;
+    }
+    return timings;
+}
+
+RequestTimings ReplyTimer::timings() const
+{
+    RequestTimings timings;
+
+    // Called from the manager's finished() slot; fall back to now if that ran first
+    const qint64 finishedNs = m_finishedNs >= 0 ? m_finishedNs : m_clock.nsecsElapsed();
+    timings.totalUs = finishedNs / 1000;
+    timings.connectionReused = m_connectingNs < 0 && m_encryptedNs < 0;
+    timings.encrypted = m_encrypted;
+
+    // Each phase ends where the next observed one starts
+    qint64 phaseStartNs = 0;
+    if (m_connectingNs >= 0) {
+        timings.dnsUs = m_connectingNs / 1000;
+        phaseStartNs = m_connectingNs;
+
+        qint64 connectedNs = m_encryptedNs >= 0 ? m_encryptedNs : m_sentNs;
+        if (connectedNs >= 0) {
+            timings.connectUs = (connectedNs - phaseStartNs) / 1000;
+            phaseStartNs = connectedNs;
+        }
+    } else if (m_encryptedNs >= 0) {
+        // Before Qt 6.3 only the handshake is seen; connect then includes the lookup
+        timings.connectUs = m_encryptedNs / 1000;
+        phaseStartNs = m_encryptedNs;
+    }
+    if (m_sentNs >= 0) {
+        timings.sendUs = (m_sentNs - phaseStartNs) / 1000;
+        phaseStartNs = m_sentNs;
+    }
+    if (m_firstByteNs >= 0) {
+        timings.ttfbUs = (m_firstByteNs - phaseStartNs) / 1000;
+        phaseStartNs = m_firstByteNs;
+    }
+    timings.transferUs = (finishedNs - phaseStartNs) / 1000;
+    return timings;
+}
+
+NetworkTimingStats::NetworkTimingStats()
+{
+}
+
+QString NetworkTimingStats::endpointName(Endpoint endpoint)
+{
+    switch (endpoint) {
+    case Discovery: return "discovery";
+    case Token: return "token";
+    case Refresh: return "refresh";
+    case Revoke: return "revoke";
+    case EndpointCount: break;
+    }
+    return QString();
+}
+
+QString NetworkTimingStats::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Dns: return "dns";
+    case Connect: return "connect";
+    case Send: return "send";
+    case Ttfb: return "ttfb";
+    case Transfer: return "transfer";
+    case Total: return "total";
+    case PhaseCount: break;
+    }
+    return QString();
+}
+
+void NetworkTimingStats::record(Endpoint endpoint, const RequestTimings& timings)
+{
+    if (!timings.isValid()) return;
+
+    QMutexLocker locker(&m_mutex);
+    EndpointStats& stats = m_endpoints[endpoint];
+    ++stats.requests;
+    if (!timings.connectionReused) {
+        ++stats.newConnections;
+    }
+
+    // LatencyHistogram::record() ignores the -1 of phases that did not happen
+    stats.phases[Dns].record(timings.dnsUs);
+    stats.phases[Connect].record(timings.connectUs);
+    stats.phases[Send].record(timings.sendUs);
+    stats.phases[Ttfb].record(timings.ttfbUs);
+    stats.phases[Transfer].record(timings.transferUs);
+    stats.phases[Total].record(timings.totalUs);
+}
+
+void NetworkTimingStats::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    for (EndpointStats& stats : m_endpoints) {
+        stats = EndpointStats();
+    }
+}
+
+quint64 NetworkTimingStats::requests(Endpoint endpoint) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_endpoints[endpoint].requests;
+}
+
+QString NetworkTimingStats::summary() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QStringList lines;
+    lines << "Network timing per endpoint (p50 / p99 ms; dns and connect only on new connections):";
+    for (int endpoint = 0; endpoint < EndpointCount; ++endpoint) {
+        const EndpointStats& stats = m_endpoints[endpoint];
+        if (stats.requests == 0) continue;
+
+        QStringList phases;
+        for (int phase = 0; phase < PhaseCount; ++phase) {
+            const LatencyHistogram& histogram = stats.phases[phase];
+            if (histogram.count() == 0) continue;
+            phases << QString("%1 %2 / %3").arg(phaseName(Phase(phase)))
+                                           .arg(histogram.percentile(50) / 1000.0, 0, 'f', 1)
+                                           .arg(histogram.percentile(99) / 1000.0, 0, 'f', 1);
+        }
+        lines << QString("  %1: %2 requests, %3% new connections; %4")
+                 .arg(endpointName(Endpoint(endpoint)))
+                 .arg(stats.requests)
+                 .arg(100.0 * stats.newConnections / stats.requests, 0, 'f', 1)
+                 .arg(phases.join(", "));
+    }
+    return lines.join("\n");
+}
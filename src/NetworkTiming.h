@@ -0,0 +1,91 @@
+#ifndef NETWORKTIMING_H
+#define NETWORKTIMING_H
+
+#include "LatencyHistogram.h"
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QElapsedTimer>
+
+class QNetworkReply;
+
+// Where the time of one HTTP request went, in microseconds (-1 = did not
+// happen, e.g. no connect on a reused connection). QNetworkAccessManager
+// resolves the host before it starts connecting, so dnsUs also holds any wait
+// for a free connection. It does not report the moment TCP connects, so
+// connectUs is TCP connect plus TLS handshake for https. Qt before 6.3 has no
+// connecting or sent signals: dnsUs and sendUs stay -1, connectUs runs from
+// the start to the TLS handshake, and new plain http connections look reused.
+struct RequestTimings
+{
+    qint64 dnsUs = -1;          // request queued -> socket starts connecting
+    qint64 connectUs = -1;      // -> connected (and TLS established)
+    qint64 sendUs = -1;         // -> request fully written
+    qint64 ttfbUs = -1;         // -> response headers
+    qint64 transferUs = -1;     // -> body complete
+    qint64 totalUs = -1;
+    bool connectionReused = false;
+    bool encrypted = false;
+
+    bool isValid() const { return totalUs >= 0; }
+    QString toString() const;
+};
+
+// Timestamps the progress signals of one reply. Attach right after get() /
+// post(), before connecting to finished(), so the timer sees every signal.
+class ReplyTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void attach(QNetworkReply* reply);
+
+    // Timings of a reply with a timer attached; invalid otherwise
+    static RequestTimings timingsOf(QNetworkReply* reply);
+
+private:
+    explicit ReplyTimer(QNetworkReply* reply);
+
+    RequestTimings timings() const;
+
+    QElapsedTimer m_clock;
+    qint64 m_connectingNs;
+    qint64 m_encryptedNs;
+    qint64 m_sentNs;
+    qint64 m_firstByteNs;
+    qint64 m_finishedNs;
+    bool m_encrypted;
+};
+
+// Per-endpoint histograms of each phase, shared by all managers of a run and
+// safe to feed from any thread
+class NetworkTimingStats
+{
+public:
+    enum Endpoint { Discovery, Token, Refresh, Revoke, EndpointCount };
+    enum Phase { Dns, Connect, Send, Ttfb, Transfer, Total, PhaseCount };
+
+    NetworkTimingStats();
+
+    void record(Endpoint endpoint, const RequestTimings& timings);
+    void reset();
+
+    quint64 requests(Endpoint endpoint) const;
+    QString summary() const;
+
+    static QString endpointName(Endpoint endpoint);
+    static QString phaseName(Phase phase);
+
+private:
+    struct EndpointStats
+    {
+        quint64 requests = 0;
+        quint64 newConnections = 0;
+        LatencyHistogram phases[PhaseCount];
+    };
+
+    mutable QMutex m_mutex;
+    EndpointStats m_endpoints[EndpointCount];
+};
+
+#endif // NETWORKTIMING_H
@@ -1,26 +1,48 @@
 #include "OIDCManager.h"
+#include "Authorizer.h"
+#include "FlowSecretPool.h"
+#include "ExchangeCapture.h"
+#include "DiscoveryCache.h"
+#include "TokenCache.h"
+#include "RetryPolicy.h"
+#include "TlsSessionCache.h"
+#include "ClientAssertion.h"
+#include "ClaimExtractor.h"
 #include <QNetworkRequest>
+#include <QTimer>
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QUrlQuery>
-#include <QDesktopServices>
 #include <QTcpSocket>
 #include <QDateTime>
-#include <QRandomGenerator>
-#include <QCryptographicHash>
-#include <QProcess>
+#include <QFile>
+#include <QSslConfiguration>
 
 OIDCManager::OIDCManager(QObject *parent)
     : QObject(parent)
     , m_networkManager(new QNetworkAccessManager(this))
+    , m_clientAuthNetworkManager(nullptr)
     , m_callbackServer(new QTcpServer(this))
-    , m_promptLogin(false)
-    , m_skipStateValidation(false)
-    , m_disablePKCE(false)
+    , m_authorizer(nullptr)
+    , m_recorder(nullptr)
+    , m_discoveryCache(nullptr)
+    , m_tokenCache(nullptr)
+    , m_retryPolicy(nullptr)
+    , m_hedgeTimer(new QTimer(this))
+    , m_networkStats(nullptr)
+    , m_tlsSessionCache(nullptr)
+    , m_flowKind(LoginFlow)
+    , m_exchangeStartMs(0)
+    , m_hedgeReply(nullptr)
+    , m_refreshAttempts(0)
+    , m_refreshGeneration(0)
 {
     m_redirectURI = QString("http://localhost:%1/callback").arg(CALLBACK_PORT);
     connect(m_callbackServer, &QTcpServer::newConnection, this, &OIDCManager::onNewConnection);
+    m_hedgeTimer->setSingleShot(true);
+    connect(m_hedgeTimer, &QTimer::timeout, this, &OIDCManager::onHedgeTimeout);
+    setAuthorizer(new BrowserAuthorizer());
 }
 
 OIDCManager::~OIDCManager()
@@ -30,58 +52,79 @@ OIDCManager::~OIDCManager()
     }
 }
 
-void OIDCManager::startAuthentication(const QString& issuerURL,
-                                     const QString& clientID,
-                                     const QString& clientSecret,
-                                     const QString& scopes,
-                                     const QString& acrValue,
-                                     const QString& loginHint,
-                                     bool promptLogin,
-                                     const QString& responseType,
-                                     const QString& extraParams,
-                                     bool skipStateValidation,
-                                     bool disablePKCE)
-{
-    m_issuerURL = issuerURL;
-    m_clientID = clientID;
-    m_clientSecret = clientSecret;
-    m_scopes = scopes;
-    m_acrValue = acrValue;
-    m_loginHint = loginHint;
-    m_promptLogin = promptLogin;
-    m_responseType = responseType;
-    m_extraParams = extraParams;
-    m_skipStateValidation = skipStateValidation;
-    m_disablePKCE = disablePKCE;
-    
-    // Generate state for CSRF protection
-    m_state = QString::number(QRandomGenerator::global()->generate64(), 16);
+void OIDCManager::startAuthentication(const OIDCConfig& config)
+{
+    m_config = config;
     
-    // Generate PKCE code verifier and challenge
-    QByteArray verifierBytes;
-    for (int i = 0; i < 32; ++i) {
-        verifierBytes.append(static_cast<char>(QRandomGenerator::global()->bounded(256)));
+    m_flowKind = LoginFlow;
+    m_flowTimer.start();
+    m_timings = FlowTimings();
+
+    if (!loadClientCertificate()) {
+        return;
     }
-    m_codeVerifier = verifierBytes.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
-    
-    QByteArray challengeBytes = QCryptographicHash::hash(m_codeVerifier.toUtf8(), QCryptographicHash::Sha256);
-    m_codeChallenge = challengeBytes.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    if (usesClientAssertion()) {
+        // Parsed once per process; later flows with the same key skip this
+        QString error;
+        if (!ClientAssertionPool::shared()->setKey(m_config.clientAssertionKey, m_config.clientAssertionKeyId, &error)) {
+            emit errorOccurred(QString("Cannot load client assertion key: %1").arg(error));
+            return;
+        }
+    }
+    if (m_config.useDpop && !m_dpop.hasKey()) {
+        QString error;
+        if (!m_dpop.generateKey(&error)) {
+            emit errorOccurred(QString("Cannot create DPoP key: %1").arg(error));
+            return;
+        }
+        emit logMessage(QString("DPoP key created (jkt %1)").arg(QString::fromLatin1(m_dpop.thumbprint())));
+    }
+
+    // State, nonce and PKCE pair come pre-generated from the pool
+    FlowSecrets secrets = FlowSecretPool::shared()->take();
+    m_state = secrets.state;
+    m_nonce = secrets.nonce;
+    m_codeVerifier = secrets.codeVerifier;
+    m_codeChallenge = secrets.codeChallenge;
     
-    emit progressUpdated("Fetching OIDC discovery document...");
     emit logMessage(QString("Started OIDC authentication at %1").arg(QDateTime::currentDateTime().toString()));
+
+    // Forcing a login prompt or recording always needs the real flow
+    m_pendingRefreshToken.clear();
+    m_tokenCacheKey.clear();
+    m_lastTokenResponse = JsonObjectView();
+    m_lastAuthorizationCode.clear();
+    // Cached tokens may be bound to another manager's DPoP key
+    if (m_tokenCache && !m_config.promptLogin && !m_recorder && !m_config.useDpop) {
+        m_tokenCacheKey = TokenCache::cacheKey(m_config.issuerURL, m_config.clientID, m_config.scopes, m_config.acrValue);
+
+        CachedTokens cached;
+        if (m_tokenCache->lookup(m_tokenCacheKey, &cached)) {
+            if (cached.remainingMs() > REFRESH_MARGIN_MS) {
+                emit logMessage(QString("Using cached tokens (expire in %1 s)").arg(cached.remainingMs() / 1000));
+                m_lastTokenResponse = JsonObjectView(cached.response);
+                emit tokensReceived(formatTokenResponse(cached.response));
+                return;
+            }
+            m_pendingRefreshToken = cached.refreshToken();
+        }
+    }
+
+    emit progressUpdated("Fetching OIDC discovery document...");
     
-    // Start callback server
-    if (!m_callbackServer->listen(QHostAddress::LocalHost, CALLBACK_PORT)) {
-        emit errorOccurred(QString("Failed to start callback server on port %1").arg(CALLBACK_PORT));
+    QJsonObject cachedDiscovery;
+    if (m_discoveryCache && !m_recorder && m_discoveryCache->lookup(m_config.issuerURL, &cachedDiscovery)) {
+        emit logMessage("Using prefetched discovery document");
+        m_timings.discoveryUs = 0;
+        applyDiscoveryDocument(JsonObjectView(cachedDiscovery));
         return;
     }
-    
-    emit logMessage(QString("Callback server listening on port %1").arg(CALLBACK_PORT));
-    
+
     // Fetch discovery document
-    QString discoveryURL = issuerURL + "/.well-known/openid-configuration";
+    QString discoveryURL = m_config.issuerURL + "/.well-known/openid-configuration";
     QNetworkRequest request(discoveryURL);
-    QNetworkReply* reply = m_networkManager->get(request);
+    beginExchange();
+    QNetworkReply* reply = sendRequest(request, nullptr, false);
     connect(reply, &QNetworkReply::finished, this, &OIDCManager::onDiscoveryFinished);
 }
 
@@ -90,34 +133,80 @@ void OIDCManager::cancelAuthentication()
     if (m_callbackServer->isListening()) {
         m_callbackServer->close();
     }
+    m_authorizer->cancel();
     emit logMessage("Authentication cancelled by user");
 }
 
+void OIDCManager::setAuthorizer(Authorizer* authorizer)
+{
+    if (m_authorizer == authorizer) return;
+
+    if (m_authorizer) {
+        m_authorizer->cancel();
+        delete m_authorizer;
+    }
+
+    m_authorizer = authorizer;
+    m_authorizer->setParent(this);
+    connect(m_authorizer, &Authorizer::callbackCaptured, this, &OIDCManager::onCallbackCaptured);
+    connect(m_authorizer, &Authorizer::errorOccurred, this, &OIDCManager::errorOccurred);
+    connect(m_authorizer, &Authorizer::logMessage, this, &OIDCManager::logMessage);
+}
+
 void OIDCManager::onDiscoveryFinished()
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) return;
     
     reply->deleteLater();
+    m_timings.discoveryUs = m_exchangeTimer.nsecsElapsed() / 1000;
+    reportRequestTimings(reply, NetworkTimingStats::Discovery);
+
+    QByteArray data = reply->readAll();
+
+    if (m_recorder) {
+        CapturedExchange exchange;
+        exchange.kind = CapturedExchange::Discovery;
+        exchange.method = "GET";
+        exchange.url = reply->url().toEncoded();
+        exchange.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        exchange.contentType = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+        exchange.responseBody = data;
+        recordExchange(exchange);
+    }
     
     if (reply->error() != QNetworkReply::NoError) {
         emit errorOccurred(QString("Failed to fetch discovery document: %1").arg(reply->errorString()));
         emit logMessage(QString("Discovery error: %1").arg(reply->errorString()));
         return;
     }
+    JsonObjectView json(data);
     
-    QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    
-    if (doc.isNull() || !doc.isObject()) {
+    if (!json.isValid()) {
         emit errorOccurred("Failed to parse discovery document.");
         emit logMessage("Failed to parse discovery document.");
         return;
     }
     
-    QJsonObject json = doc.object();
-    m_authorizationEndpoint = json["authorization_endpoint"].toString();
-    m_tokenEndpoint = json["token_endpoint"].toString();
+    if (m_discoveryCache) {
+        m_discoveryCache->store(m_config.issuerURL, json.toJsonObject());
+    }
+
+    applyDiscoveryDocument(json);
+}
+
+void OIDCManager::applyDiscoveryDocument(const JsonObjectView& json)
+{
+    m_authorizationEndpoint = json.string(QLatin1String("authorization_endpoint"));
+    m_tokenEndpoint = json.string(QLatin1String("token_endpoint"));
+    m_revocationEndpoint = json.string(QLatin1String("revocation_endpoint"));
+
+    // RFC 8705 section 5: mTLS clients use the aliases where the IdP publishes them
+    if (!m_clientCertificate.isNull() && json.contains(QLatin1String("mtls_endpoint_aliases"))) {
+        const QJsonObject aliases = json.toJsonObject().value("mtls_endpoint_aliases").toObject();
+        m_tokenEndpoint = aliases.value("token_endpoint").toString(m_tokenEndpoint);
+        m_revocationEndpoint = aliases.value("revocation_endpoint").toString(m_revocationEndpoint);
+    }
     
     if (m_authorizationEndpoint.isEmpty() || m_tokenEndpoint.isEmpty()) {
         emit errorOccurred("Discovery document missing required endpoints.");
@@ -128,30 +217,41 @@ void OIDCManager::onDiscoveryFinished()
     emit logMessage(QString("Fetched discovery document - Auth endpoint: %1, Token endpoint: %2")
                    .arg(m_authorizationEndpoint, m_tokenEndpoint));
     
+    if (!m_pendingRefreshToken.isEmpty()) {
+        refreshTokens(m_pendingRefreshToken);
+        return;
+    }
+
+    startAuthorization();
+}
+
+void OIDCManager::startAuthorization()
+{
+    // Start callback server, unless the authorizer captures the redirect itself
+    if (!m_authorizer->capturesCallback()) {
+        if (!m_callbackServer->listen(QHostAddress::LocalHost, CALLBACK_PORT)) {
+            emit errorOccurred(QString("Failed to start callback server on port %1").arg(CALLBACK_PORT));
+            return;
+        }
+
+        emit logMessage(QString("Callback server listening on port %1").arg(CALLBACK_PORT));
+    }
+
     emit progressUpdated("Building authorization URL...");
     
     QUrl authURL = buildAuthorizationURL(m_authorizationEndpoint);
     
     emit logMessage(QString("Starting authentication with URL: %1").arg(authURL.toString()));
-    emit progressUpdated("Opening browser for authentication...");
-
-    // Open browser in incognito mode
-    QString url = authURL.toString();
-    QProcess* browserProcess = new QProcess();
-    browserProcess->setProgram("google-chrome");
-    browserProcess->setArguments({"--incognito", url});
-
-    if (!browserProcess->startDetached()) {
-        // Fallback to default browser if Chrome fails
-        emit logMessage("Failed to launch Chrome incognito, trying default browser...");
-        if (!QDesktopServices::openUrl(authURL)) {
-            emit errorOccurred("Failed to open browser.");
-            emit logMessage("Failed to open browser.");
-            delete browserProcess;
-            return;
-        }
+    if (m_authorizer->capturesCallback()) {
+        emit progressUpdated("Performing scripted authorization...");
+    } else {
+        emit progressUpdated("Opening browser for authentication...");
+    }
+
+    beginExchange();
+    if (!m_authorizer->authorize(authURL, m_redirectURI)) {
+        return;
     }
-    delete browserProcess;
     
     emit progressUpdated("Waiting for authentication completion...");
 }
@@ -161,48 +261,53 @@ QUrl OIDCManager::buildAuthorizationURL(const QString& authEndpoint)
     QUrl url(authEndpoint);
     QUrlQuery query;
 
-    query.addQueryItem("client_id", m_clientID);
+    query.addQueryItem("client_id", m_config.clientID);
     query.addQueryItem("redirect_uri", m_redirectURI);
-    query.addQueryItem("response_type", m_responseType);
-    query.addQueryItem("scope", m_scopes);
+    query.addQueryItem("response_type", m_config.responseType);
+    query.addQueryItem("scope", m_config.scopes);
     query.addQueryItem("state", m_state);
 
     // Only add PKCE for authorization code flow (unless disabled)
-    if (m_responseType.contains("code") && !m_disablePKCE) {
+    if (m_config.responseType.contains("code") && !m_config.disablePKCE) {
         query.addQueryItem("code_challenge", m_codeChallenge);
         query.addQueryItem("code_challenge_method", "S256");
     }
 
+    // Binds the authorization code to the DPoP key (RFC 9449 section 10)
+    if (m_config.useDpop && m_config.responseType.contains("code")) {
+        query.addQueryItem("dpop_jkt", QString::fromLatin1(m_dpop.thumbprint()));
+    }
+
     // For implicit/hybrid flow, add nonce and use form_post
-    if (m_responseType.contains("token") || m_responseType.contains("id_token")) {
-        query.addQueryItem("nonce", m_state); // Reuse state as nonce for simplicity
+    if (m_config.responseType.contains("token") || m_config.responseType.contains("id_token")) {
+        query.addQueryItem("nonce", m_nonce);
         query.addQueryItem("response_mode", "form_post");
     }
 
-    if (m_acrValue != "None" && !m_acrValue.isEmpty()) {
+    if (m_config.acrValue != "None" && !m_config.acrValue.isEmpty()) {
         // Extract ACR value from display string if needed
-        QString acrRaw = m_acrValue;
-        if (m_acrValue.contains("(")) {
-            int start = m_acrValue.indexOf('(') + 1;
-            int end = m_acrValue.indexOf(')');
+        QString acrRaw = m_config.acrValue;
+        if (m_config.acrValue.contains("(")) {
+            int start = m_config.acrValue.indexOf('(') + 1;
+            int end = m_config.acrValue.indexOf(')');
             if (start > 0 && end > start) {
-                acrRaw = m_acrValue.mid(start, end - start);
+                acrRaw = m_config.acrValue.mid(start, end - start);
             }
         }
         query.addQueryItem("acr_values", acrRaw);
     }
 
-    if (!m_loginHint.isEmpty()) {
-        query.addQueryItem("login_hint", m_loginHint);
+    if (!m_config.loginHint.isEmpty()) {
+        query.addQueryItem("login_hint", m_config.loginHint);
     }
 
-    if (m_promptLogin) {
+    if (m_config.promptLogin) {
         query.addQueryItem("prompt", "login");
     }
 
     // Add extra parameters
-    if (!m_extraParams.isEmpty()) {
-        QStringList pairs = m_extraParams.split('&');
+    if (!m_config.extraParams.isEmpty()) {
+        QStringList pairs = m_config.extraParams.split('&');
         for (const QString& pair : pairs) {
             QStringList kv = pair.split('=');
             if (kv.size() == 2) {
@@ -226,27 +331,55 @@ void OIDCManager::onReadyRead()
     QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
     if (!socket) return;
 
-    QString request = QString::fromUtf8(socket->readAll());
+    QString fullURL = parseCallbackRequest(socket->readAll(), CALLBACK_PORT);
+    if (fullURL.isEmpty()) {
+        socket->close();
+        socket->deleteLater();
+        return;
+    }
+
+    // Send HTTP response
+    QString response = "HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/html\r\n"
+                      "\r\n"
+                      "<html><body>"
+                      "<h1>Authentication Complete</h1>"
+                      "<p>You can close this window and return to the OIDC Tester application.</p>"
+                      "</body></html>";
+
+    socket->write(response.toUtf8());
+    socket->flush();
+    socket->close();
+    socket->deleteLater();
+
+    // Stop listening for more connections
+    m_callbackServer->close();
+
+    // Handle the callback
+    emit logMessage(QString("Authentication complete. Parsing tokens from callback URL: %1").arg(fullURL));
+    emit progressUpdated("Authentication complete. Parsing tokens...");
+    handleAuthCallback(QUrl(fullURL));
+}
+
+QString OIDCManager::parseCallbackRequest(const QByteArray& requestData, int port)
+{
+    QString request = QString::fromUtf8(requestData);
 
     // Parse the HTTP request to get the callback URL
     QStringList lines = request.split("\r\n");
     if (lines.isEmpty()) {
-        socket->close();
-        socket->deleteLater();
-        return;
+        return QString();
     }
 
     QString firstLine = lines[0];
     QStringList parts = firstLine.split(' ');
     if (parts.size() < 2) {
-        socket->close();
-        socket->deleteLater();
-        return;
+        return QString();
     }
 
     QString method = parts[0];
     QString path = parts[1];
-    QString fullURL = QString("http://localhost:%1%2").arg(CALLBACK_PORT).arg(path);
+    QString fullURL = QString("http://localhost:%1%2").arg(port).arg(path);
 
     // For POST requests (form_post mode), extract form data from body
     if (method == "POST") {
@@ -261,47 +394,45 @@ void OIDCManager::onReadyRead()
         }
     }
 
-    // Send HTTP response
-    QString response = "HTTP/1.1 200 OK\r\n"
-                      "Content-Type: text/html\r\n"
-                      "\r\n"
-                      "<html><body>"
-                      "<h1>Authentication Complete</h1>"
-                      "<p>You can close this window and return to the OIDC Tester application.</p>"
-                      "</body></html>";
-
-    socket->write(response.toUtf8());
-    socket->flush();
-    socket->close();
-    socket->deleteLater();
-
-    // Stop listening for more connections
-    m_callbackServer->close();
+    return fullURL;
+}
 
-    // Handle the callback
-    emit logMessage(QString("Authentication complete. Parsing tokens from callback URL: %1").arg(fullURL));
+void OIDCManager::onCallbackCaptured(const QUrl& url)
+{
+    emit logMessage(QString("Authentication complete. Parsing tokens from callback URL: %1").arg(url.toString()));
     emit progressUpdated("Authentication complete. Parsing tokens...");
-    handleAuthCallback(QUrl(fullURL));
+    handleAuthCallback(url);
 }
 
 void OIDCManager::handleAuthCallback(const QUrl& url)
 {
+    m_timings.authorizeUs = m_exchangeTimer.nsecsElapsed() / 1000;
+
+    if (m_recorder) {
+        CapturedExchange exchange;
+        exchange.kind = CapturedExchange::Callback;
+        exchange.method = "GET";
+        exchange.url = url.toEncoded();
+        recordExchange(exchange);
+    }
+
     QUrlQuery query(url);
 
     QString code = query.queryItemValue("code");
+    m_lastAuthorizationCode = code;
     QString idToken = query.queryItemValue("id_token");
     QString accessToken = query.queryItemValue("access_token");
     QString error = query.queryItemValue("error");
     QString state = query.queryItemValue("state");
 
     // Verify state (unless skipped for testing/demo)
-    if (!m_skipStateValidation && state != m_state) {
+    if (!m_config.skipStateValidation && state != m_state) {
         emit errorOccurred("State mismatch - possible CSRF attack");
         emit logMessage(QString("State mismatch in callback - expected: %1, received: %2").arg(m_state, state));
         return;
     }
 
-    if (m_skipStateValidation && state != m_state) {
+    if (m_config.skipStateValidation && state != m_state) {
         emit logMessage(QString("⚠️ State validation skipped - expected: %1, received: %2").arg(m_state, state));
     }
 
@@ -321,6 +452,19 @@ void OIDCManager::handleAuthCallback(const QUrl& url)
         if (!accessToken.isEmpty()) {
             result += QString("Access Token: %1\n").arg(accessToken);
         }
+        QJsonObject response;
+        for (const char* name : {"id_token", "access_token", "token_type", "expires_in"}) {
+            if (query.hasQueryItem(name)) {
+                response[name] = query.queryItemValue(name);
+            }
+        }
+        m_lastTokenResponse = JsonObjectView(response);
+        if (m_tokenCache && !m_tokenCacheKey.isEmpty()) {
+            m_tokenCache->store(m_tokenCacheKey, response);
+        }
+        if (!idToken.isEmpty()) {
+            logIdTokenProblems(idToken);
+        }
         emit tokensReceived(result);
         emit logMessage("Direct tokens received from callback");
         return;
@@ -339,34 +483,62 @@ void OIDCManager::handleAuthCallback(const QUrl& url)
 
 void OIDCManager::exchangeCodeForTokens(const QString& code, const QString& tokenEndpoint)
 {
-    QNetworkRequest request(tokenEndpoint);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
     QUrlQuery postData;
     postData.addQueryItem("grant_type", "authorization_code");
     postData.addQueryItem("code", code);
-    postData.addQueryItem("client_id", m_clientID);
+    postData.addQueryItem("client_id", m_config.clientID);
     postData.addQueryItem("redirect_uri", m_redirectURI);
 
     // Only send code_verifier if PKCE is enabled
-    if (!m_disablePKCE) {
+    if (!m_config.disablePKCE) {
         postData.addQueryItem("code_verifier", m_codeVerifier);
     }
 
-    if (!m_clientSecret.isEmpty()) {
-        postData.addQueryItem("client_secret", m_clientSecret);
-    }
+    m_tokenExchangeParameters = postData;
+    m_tokenExchangeEndpoint = tokenEndpoint;
 
     emit logMessage(QString("Exchanging authorization code at token endpoint: %1").arg(tokenEndpoint));
-    if (m_disablePKCE) {
-        emit logMessage(QString("Token exchange parameters: grant_type=authorization_code, client_id=%1, redirect_uri=%2, client_secret=%3 (PKCE disabled)")
-                       .arg(m_clientID, m_redirectURI, m_clientSecret.isEmpty() ? "(none)" : "***"));
+    const QString clientAuthentication = usesClientAssertion()
+        ? QString("client_assertion=*** (private_key_jwt, %1)").arg(ClientAssertionPool::shared()->algorithm())
+        : QString("client_secret=%1").arg(m_config.clientSecret.isEmpty() ? "(none)" : "***");
+    if (m_config.disablePKCE) {
+        emit logMessage(QString("Token exchange parameters: grant_type=authorization_code, client_id=%1, redirect_uri=%2, %3 (PKCE disabled)")
+                       .arg(m_config.clientID, m_redirectURI, clientAuthentication));
     } else {
-        emit logMessage(QString("Token exchange parameters: grant_type=authorization_code, client_id=%1, redirect_uri=%2, code_verifier=%3, client_secret=%4")
-                       .arg(m_clientID, m_redirectURI, m_codeVerifier, m_clientSecret.isEmpty() ? "(none)" : "***"));
+        emit logMessage(QString("Token exchange parameters: grant_type=authorization_code, client_id=%1, redirect_uri=%2, code_verifier=%3, %4")
+                       .arg(m_config.clientID, m_redirectURI, m_codeVerifier, clientAuthentication));
     }
 
-    QNetworkReply* reply = m_networkManager->post(request, postData.toString(QUrl::FullyEncoded).toUtf8());
+    beginExchange();
+    postTokenExchange();
+}
+
+void OIDCManager::postTokenExchange()
+{
+    // Client authentication and DPoP proof are fresh on every send
+    QUrlQuery postData = m_tokenExchangeParameters;
+    addClientAuthentication(postData, m_tokenExchangeEndpoint);
+
+    QNetworkRequest request(m_tokenExchangeEndpoint);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    if (m_config.useDpop) {
+        request.setRawHeader("DPoP", m_dpop.proof("POST", request.url()));
+    }
+
+    if (m_recorder) {
+        // Never write the client secret or a still valid assertion into capture files
+        QUrlQuery redacted = postData;
+        for (const char* secret : {"client_secret", "client_assertion"}) {
+            if (redacted.hasQueryItem(secret)) {
+                redacted.removeAllQueryItems(secret);
+                redacted.addQueryItem(secret, "***");
+            }
+        }
+        m_tokenRequestBody = redacted.toString(QUrl::FullyEncoded).toUtf8();
+    }
+
+    const QByteArray body = postData.toString(QUrl::FullyEncoded).toUtf8();
+    QNetworkReply* reply = sendRequest(request, &body, true);
     connect(reply, &QNetworkReply::finished, this, &OIDCManager::onTokenExchangeFinished);
 }
 
@@ -376,12 +548,33 @@ void OIDCManager::onTokenExchangeFinished()
     if (!reply) return;
 
     reply->deleteLater();
+    m_timings.tokenUs = m_exchangeTimer.nsecsElapsed() / 1000;
 
     int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     emit logMessage(QString("Token endpoint response status: %1").arg(statusCode));
+    reportRequestTimings(reply, NetworkTimingStats::Token);
+
+    if (acceptDpopNonce(reply)) {
+        // The code is still unused: the server rejected the proof before redeeming it
+        emit logMessage("Token endpoint requires a DPoP nonce, resending with it");
+        postTokenExchange();
+        return;
+    }
 
     QByteArray data = reply->readAll();
 
+    if (m_recorder) {
+        CapturedExchange exchange;
+        exchange.kind = CapturedExchange::Token;
+        exchange.method = "POST";
+        exchange.url = reply->url().toEncoded();
+        exchange.requestBody = m_tokenRequestBody;
+        exchange.status = statusCode;
+        exchange.contentType = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+        exchange.responseBody = data;
+        recordExchange(exchange);
+    }
+
     if (reply->error() != QNetworkReply::NoError) {
         emit errorOccurred(QString("Token exchange error: %1").arg(reply->errorString()));
         emit logMessage(QString("Token exchange error: %1").arg(reply->errorString()));
@@ -389,45 +582,556 @@ void OIDCManager::onTokenExchangeFinished()
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
+    JsonObjectView json(data);
 
-    if (doc.isNull() || !doc.isObject()) {
+    if (!json.isValid()) {
         emit errorOccurred("Failed to parse token response.");
         emit logMessage("Failed to parse token response.");
         return;
     }
 
-    QJsonObject json = doc.object();
-    QString result;
+    QString result = formatTokenResponse(json);
 
-    if (json.contains("access_token")) {
-        result += QString("Access Token: %1\n").arg(json["access_token"].toString());
+    if (json.contains(QLatin1String("access_token"))) {
         emit logMessage("Access token received");
     }
 
-    if (json.contains("id_token")) {
-        result += QString("ID Token: %1\n").arg(json["id_token"].toString());
+    if (json.contains(QLatin1String("id_token"))) {
         emit logMessage("ID token received");
+        logIdTokenProblems(json.string(QLatin1String("id_token")));
     }
 
-    if (json.contains("refresh_token")) {
-        result += QString("Refresh Token: %1\n").arg(json["refresh_token"].toString());
+    if (json.contains(QLatin1String("refresh_token"))) {
         emit logMessage("Refresh token received");
     }
 
-    if (json.contains("token_type")) {
-        result += QString("Token Type: %1\n").arg(json["token_type"].toString());
-    }
-
-    if (json.contains("expires_in")) {
-        result += QString("Expires In: %1 seconds\n").arg(json["expires_in"].toInt());
-    }
-
     if (result.isEmpty()) {
         emit tokensReceived("No tokens found in response.");
     } else {
+        m_lastTokenResponse = json;
+        if (m_tokenCache && !m_tokenCacheKey.isEmpty()) {
+            m_tokenCache->store(m_tokenCacheKey, json.toJsonObject());
+        }
         emit tokensReceived(result);
         emit logMessage("Token exchange completed successfully");
     }
 }
 
+void OIDCManager::refreshTokens(const QString& refreshToken)
+{
+    QUrlQuery postData;
+    postData.addQueryItem("grant_type", "refresh_token");
+    postData.addQueryItem("refresh_token", refreshToken);
+    postData.addQueryItem("client_id", m_config.clientID);
+
+    emit progressUpdated("Refreshing tokens...");
+    emit logMessage(QString("Refreshing tokens at token endpoint: %1").arg(m_tokenEndpoint));
+
+    m_refreshBody = postData.toString(QUrl::FullyEncoded).toUtf8();
+    m_refreshAttempts = 0;
+    m_hedgeReply = nullptr;
+    ++m_refreshGeneration;
+
+    beginExchange();
+    sendRefreshAttempt(false);
+}
+
+void OIDCManager::sendRefreshAttempt(bool hedge)
+{
+    QNetworkRequest request(m_tokenEndpoint);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    // Each attempt gets its own assertion: the IdP rejects a reused jti
+    QUrlQuery authentication;
+    addClientAuthentication(authentication, m_tokenEndpoint);
+    QByteArray body = m_refreshBody;
+    if (!authentication.isEmpty()) {
+        body += '&' + authentication.toString(QUrl::FullyEncoded).toUtf8();
+    }
+
+    if (m_config.useDpop) {
+        request.setRawHeader("DPoP", m_dpop.proof("POST", request.url()));
+    }
+
+    QNetworkReply* reply = sendRequest(request, &body, true);
+    reply->setProperty("startedNs", m_exchangeTimer.nsecsElapsed());
+    connect(reply, &QNetworkReply::finished, this, &OIDCManager::onRefreshFinished);
+    m_refreshReplies.append(reply);
+
+    if (hedge) {
+        m_hedgeReply = reply;
+        return;
+    }
+    ++m_refreshAttempts;
+
+    // At most one hedge in flight, armed with the current estimate
+    if (m_retryPolicy && m_retryPolicy->hedging() && !m_hedgeReply) {
+        qint64 delayUs = m_retryPolicy->hedgeDelayUs();
+        if (delayUs >= 0) {
+            m_hedgeTimer->start(int(qMax<qint64>(1, delayUs / 1000)));
+        }
+    }
+}
+
+void OIDCManager::onHedgeTimeout()
+{
+    if (m_refreshReplies.isEmpty() || m_hedgeReply) return;
+
+    m_retryPolicy->countHedge();
+    emit logMessage("Refresh slower than the hedge delay, sending a hedged request");
+    sendRefreshAttempt(true);
+}
+
+void OIDCManager::onRefreshFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply || !m_refreshReplies.removeOne(reply)) return;
+    reportRequestTimings(reply, NetworkTimingStats::Refresh);
+
+    // Cleared now: the reply is deleted below and a later one may reuse its address
+    const bool hedge = reply == m_hedgeReply;
+    if (hedge) {
+        m_hedgeReply = nullptr;
+    }
+
+    // A nonce challenge is not a failed attempt: resend in its place
+    if (acceptDpopNonce(reply)) {
+        emit logMessage("Token endpoint requires a DPoP nonce, resending the refresh with it");
+        if (!hedge) {
+            --m_refreshAttempts;
+        }
+        reply->deleteLater();
+        sendRefreshAttempt(hedge);
+        return;
+    }
+
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool succeeded = reply->error() == QNetworkReply::NoError && statusCode >= 200 && statusCode < 300;
+
+    if (m_retryPolicy) {
+        qint64 attemptUs = (m_exchangeTimer.nsecsElapsed() - reply->property("startedNs").toLongLong()) / 1000;
+        m_retryPolicy->recordAttempt(attemptUs, succeeded);
+
+        if (!succeeded) {
+            // The other attempt may still succeed
+            if (!m_refreshReplies.isEmpty()) {
+                reply->deleteLater();
+                return;
+            }
+
+            if (RetryPolicy::isRetryable(reply->error(), statusCode) && m_refreshAttempts < m_retryPolicy->maxAttempts()) {
+                int delayMs = m_retryPolicy->backoffMs(m_refreshAttempts);
+                m_retryPolicy->countRetry();
+                emit logMessage(QString("Token refresh attempt %1 failed (status %2), retrying in %3 ms")
+                               .arg(m_refreshAttempts).arg(statusCode).arg(delayMs));
+                m_hedgeTimer->stop();
+                reply->deleteLater();
+
+                quint64 generation = m_refreshGeneration;
+                QTimer::singleShot(delayMs, this, [this, generation]() {
+                    if (generation == m_refreshGeneration) {
+                        sendRefreshAttempt(false);
+                    }
+                });
+                return;
+            }
+        }
+
+        m_retryPolicy->recordRequest(m_exchangeTimer.nsecsElapsed() / 1000, succeeded, succeeded && hedge);
+    }
+
+    // First outcome wins; whatever is still in flight is cancelled
+    m_hedgeTimer->stop();
+    for (QNetworkReply* pending : m_refreshReplies) {
+        if (m_retryPolicy) {
+            m_retryPolicy->recordCancelledAttempt(
+                (m_exchangeTimer.nsecsElapsed() - pending->property("startedNs").toLongLong()) / 1000);
+        }
+        disconnect(pending, &QNetworkReply::finished, this, &OIDCManager::onRefreshFinished);
+        pending->abort();
+        pending->deleteLater();
+    }
+    m_refreshReplies.clear();
+    m_hedgeReply = nullptr;
+
+    finishRefresh(reply);
+}
+
+void OIDCManager::finishRefresh(QNetworkReply* reply)
+{
+    reply->deleteLater();
+    m_timings.tokenUs = m_exchangeTimer.nsecsElapsed() / 1000;
+    m_pendingRefreshToken.clear();
+
+    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+    bool failed = reply->error() != QNetworkReply::NoError || !doc.isObject() || !doc.object().contains("access_token");
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (m_tokenCacheKey.isEmpty()) {
+        // Explicit refreshSession(): report the outcome as is
+        if (failed) {
+            emit errorOccurred(QString("Token refresh failed (status %1)").arg(statusCode));
+            return;
+        }
+
+        // Keep the previous refresh token when the IdP does not rotate it
+        QJsonObject response = doc.object();
+        QString previousRefreshToken = m_lastTokenResponse.string(QLatin1String("refresh_token"));
+        if (!response.contains("refresh_token") && !previousRefreshToken.isEmpty()) {
+            response["refresh_token"] = previousRefreshToken;
+        }
+        m_lastTokenResponse = JsonObjectView(response);
+        emit logMessage("Tokens refreshed");
+        emit tokensReceived(formatTokenResponse(m_lastTokenResponse));
+        return;
+    }
+
+    if (failed) {
+        // Revoked or expired refresh token: drop it and log in interactively
+        emit logMessage(QString("Token refresh failed (status %1), falling back to interactive login").arg(statusCode));
+        m_tokenCache->remove(m_tokenCacheKey);
+        startAuthorization();
+        return;
+    }
+
+    m_tokenCache->store(m_tokenCacheKey, doc.object());
+
+    CachedTokens refreshed;
+    m_tokenCache->lookup(m_tokenCacheKey, &refreshed);
+    m_lastTokenResponse = JsonObjectView(refreshed.response);
+    emit logMessage("Cached tokens refreshed");
+    emit tokensReceived(formatTokenResponse(refreshed.response));
+}
+
+void OIDCManager::refreshSession()
+{
+    QString refreshToken = m_lastTokenResponse.string(QLatin1String("refresh_token"));
+    if (refreshToken.isEmpty() || m_tokenEndpoint.isEmpty()) {
+        emit errorOccurred("No refresh token from a previous flow to refresh with");
+        return;
+    }
+
+    m_flowKind = RefreshFlow;
+    m_flowTimer.start();
+    m_timings = FlowTimings();
+    m_tokenCacheKey.clear();
+    m_lastAuthorizationCode.clear();
+    refreshTokens(refreshToken);
+}
+
+void OIDCManager::revokeSession(const QString& tokenTypeHint)
+{
+    QString token = m_lastTokenResponse.string(QLatin1String(tokenTypeHint == "access_token" ? "access_token" : "refresh_token"));
+    if (token.isEmpty()) {
+        emit errorOccurred(QString("No %1 from a previous flow to revoke").arg(tokenTypeHint));
+        return;
+    }
+    if (m_revocationEndpoint.isEmpty()) {
+        emit errorOccurred("Discovery document has no revocation_endpoint");
+        return;
+    }
+
+    m_flowKind = RevokeFlow;
+    m_flowTimer.start();
+    m_timings = FlowTimings();
+
+    QNetworkRequest request(m_revocationEndpoint);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    QUrlQuery postData;
+    postData.addQueryItem("token", token);
+    postData.addQueryItem("token_type_hint", tokenTypeHint);
+    postData.addQueryItem("client_id", m_config.clientID);
+    addClientAuthentication(postData, m_revocationEndpoint);
+
+    emit logMessage(QString("Revoking %1 at %2").arg(tokenTypeHint, m_revocationEndpoint));
+
+    beginExchange();
+    const QByteArray body = postData.toString(QUrl::FullyEncoded).toUtf8();
+    QNetworkReply* reply = sendRequest(request, &body, true);
+    connect(reply, &QNetworkReply::finished, this, &OIDCManager::onRevokeFinished);
+}
+
+void OIDCManager::onRevokeFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+
+    reply->deleteLater();
+    m_timings.tokenUs = m_exchangeTimer.nsecsElapsed() / 1000;
+    reportRequestTimings(reply, NetworkTimingStats::Revoke);
+
+    // RFC 7009: 200 whether or not the token was still valid
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError || statusCode != 200) {
+        emit errorOccurred(QString("Token revocation failed (status %1): %2").arg(statusCode).arg(reply->errorString()));
+        return;
+    }
+
+    m_lastTokenResponse = JsonObjectView();
+    emit logMessage("Tokens revoked");
+    emit tokensRevoked();
+}
+
+void OIDCManager::reportRequestTimings(QNetworkReply* reply, NetworkTimingStats::Endpoint endpoint)
+{
+    RequestTimings timings = ReplyTimer::timingsOf(reply);
+    if (!timings.isValid()) return;
+
+    emit logMessage(QString("%1 request timing: %2").arg(NetworkTimingStats::endpointName(endpoint), timings.toString()));
+    if (m_networkStats) {
+        m_networkStats->record(endpoint, timings);
+    }
+
+    // Keep the newest ticket for the next connection, from whichever manager makes it
+    if (m_tlsSessionCache && timings.encrypted && reply->error() == QNetworkReply::NoError) {
+        // Only set on the request whose TLS configuration created the connection
+        const QVariant ticketOffered = reply->property("tlsTicketOffered");
+        if (!timings.connectionReused && ticketOffered.isValid()) {
+            m_tlsSessionCache->recordHandshake(timings.connectUs, ticketOffered.toBool());
+        }
+        const QSslConfiguration ssl = reply->sslConfiguration();
+        const QString certificatePath = reply->property("tlsClientAuth").toBool() ? m_loadedCertificatePath : QString();
+        m_tlsSessionCache->store(TlsSessionCache::key(reply->url(), certificatePath),
+                                 ssl.sessionTicket(), ssl.sessionTicketLifeTimeHint());
+    }
+}
+
+bool OIDCManager::acceptDpopNonce(QNetworkReply* reply)
+{
+    // Servers may hand out a new nonce on any response (RFC 9449 section 8)
+    if (!m_config.useDpop || !reply->hasRawHeader("DPoP-Nonce")) return false;
+
+    const QByteArray nonce = reply->rawHeader("DPoP-Nonce");
+    const bool changed = nonce != m_dpop.nonce(reply->url());
+    m_dpop.setNonce(reply->url(), nonce);
+
+    // Retry only with a nonce the rejected proof did not carry, so a
+    // misbehaving server cannot cause a loop
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return changed && statusCode == 400 && reply->peek(reply->bytesAvailable()).contains("use_dpop_nonce");
+}
+
+void OIDCManager::addClientAuthentication(QUrlQuery& postData, const QString& audience)
+{
+    if (usesClientAssertion()) {
+        postData.addQueryItem("client_assertion_type", "urn:ietf:params:oauth:client-assertion-type:jwt-bearer");
+        postData.addQueryItem("client_assertion",
+                              QString::fromLatin1(ClientAssertionPool::shared()->take(m_config.clientID, audience)));
+    } else if (!m_config.clientSecret.isEmpty()) {
+        postData.addQueryItem("client_secret", m_config.clientSecret);
+    }
+}
+
+QNetworkAccessManager* OIDCManager::clientAuthNetworkManager()
+{
+    // Separate from m_networkManager so a token request never rides on a
+    // connection opened without the certificate (e.g. by discovery)
+    if (!m_clientAuthNetworkManager) {
+        m_clientAuthNetworkManager = new QNetworkAccessManager(this);
+    }
+    return m_clientAuthNetworkManager;
+}
+
+QNetworkReply* OIDCManager::sendRequest(QNetworkRequest request, const QByteArray* body, bool clientAuthentication)
+{
+    const bool useCertificate = clientAuthentication && !m_clientCertificate.isNull();
+    QNetworkAccessManager* manager = useCertificate ? clientAuthNetworkManager() : m_networkManager;
+    bool ticketOffered = false;
+
+    if (request.url().scheme() == QLatin1String("https") && (useCertificate || m_tlsSessionCache)) {
+        QSslConfiguration ssl = request.sslConfiguration();
+        if (useCertificate) {
+            ssl.setLocalCertificate(m_clientCertificate);
+            ssl.setPrivateKey(m_clientKey);
+        }
+        if (m_tlsSessionCache) {
+            // Session persistence makes the ticket readable from the reply afterwards
+            ssl.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+            QByteArray ticket = m_tlsSessionCache->ticket(
+                TlsSessionCache::key(request.url(), useCertificate ? m_loadedCertificatePath : QString()));
+            if (!ticket.isEmpty()) {
+                ssl.setSessionTicket(ticket);
+                ticketOffered = true;
+            }
+        }
+        request.setSslConfiguration(ssl);
+    }
+
+    // A request creates the origin's connection when none is in use or idle
+    // within Qt's expiry; otherwise its TLS configuration is never applied
+    const QString connectionKey = QString(useCertificate ? "mtls " : "") +
+        request.url().adjusted(QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment | QUrl::RemoveUserInfo).toString();
+    ConnectionState& connection = m_connections[connectionKey];
+    const bool createsConnection = connection.inFlight == 0 &&
+        (!connection.idle.isValid() || connection.idle.hasExpired(CONNECTION_CACHE_EXPIRY_MS));
+    if (createsConnection) {
+        connection.ticketOffered = ticketOffered;
+    }
+    ++connection.inFlight;
+
+    QNetworkReply* reply = body ? manager->post(request, *body) : manager->get(request);
+    reply->setProperty("tlsClientAuth", useCertificate);
+    if (createsConnection) {
+        reply->setProperty("tlsTicketOffered", ticketOffered);
+    }
+    ReplyTimer::attach(reply);
+    connect(reply, &QNetworkReply::finished, this, [this, connectionKey]() {
+        ConnectionState& connection = m_connections[connectionKey];
+        --connection.inFlight;
+        connection.idle.start();
+    });
+    return reply;
+}
+
+bool OIDCManager::loadClientCertificate()
+{
+    // Parsed once per manager, not per flow
+    if (m_config.clientCertificate == m_loadedCertificatePath && m_config.clientKey == m_loadedKeyPath) {
+        return true;
+    }
+
+    m_clientCertificate = QSslCertificate();
+    m_clientKey = QSslKey();
+    m_loadedCertificatePath.clear();
+    m_loadedKeyPath.clear();
+
+    // Connections made with the previous certificate must not be reused
+    if (m_clientAuthNetworkManager) {
+        m_clientAuthNetworkManager->deleteLater();
+        m_clientAuthNetworkManager = nullptr;
+        auto it = m_connections.begin();
+        while (it != m_connections.end()) {
+            if (it.key().startsWith(QLatin1String("mtls "))) {
+                it = m_connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (m_config.clientCertificate.isEmpty()) {
+        return true;
+    }
+
+    const QList<QSslCertificate> certificates = QSslCertificate::fromPath(m_config.clientCertificate, QSsl::Pem);
+    if (certificates.isEmpty()) {
+        emit errorOccurred(QString("Cannot read client certificate %1").arg(m_config.clientCertificate));
+        return false;
+    }
+
+    const QString keyPath = m_config.clientKey.isEmpty() ? m_config.clientCertificate : m_config.clientKey;
+    QFile keyFile(keyPath);
+    if (!keyFile.open(QIODevice::ReadOnly)) {
+        emit errorOccurred(QString("Cannot open client key %1: %2").arg(keyPath, keyFile.errorString()));
+        return false;
+    }
+    const QByteArray pem = keyFile.readAll();
+    QSslKey key(pem, QSsl::Rsa);
+    if (key.isNull()) {
+        key = QSslKey(pem, QSsl::Ec);
+    }
+    if (key.isNull()) {
+        emit errorOccurred(QString("%1 holds no unencrypted RSA or EC private key").arg(keyPath));
+        return false;
+    }
+
+    m_clientCertificate = certificates.first();
+    m_clientKey = key;
+    m_loadedCertificatePath = m_config.clientCertificate;
+    m_loadedKeyPath = m_config.clientKey;
+    emit logMessage(QString("Using client certificate \"%1\" for token endpoint requests (mTLS)")
+                   .arg(m_clientCertificate.subjectInfo(QSslCertificate::CommonName).join(", ")));
+    return true;
+}
+
+QStringList OIDCManager::checkIdTokenClaims(const QString& idToken, const QString& issuerURL,
+                                            const QString& clientID, const QString& nonce)
+{
+    ClaimSet claims;
+    if (!ClaimExtractor::extractFromJWT(idToken, VALIDATION_CLAIMS, &claims)) {
+        return {"ID token payload could not be read"};
+    }
+
+    QStringList problems;
+    QString issuer = claims.string(Claim::Iss);
+    if (issuer != issuerURL && issuer + "/" != issuerURL && issuer != issuerURL + "/") {
+        problems << QString("iss \"%1\" does not match the issuer").arg(issuer);
+    }
+
+    if (!claims.strings(Claim::Aud).contains(clientID)) {
+        problems << "aud does not contain the client ID";
+    }
+
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (!claims.has(Claim::Exp)) {
+        problems << "exp is missing";
+    } else if (claims.integer(Claim::Exp) <= now) {
+        problems << QString("expired %1 s ago").arg(now - claims.integer(Claim::Exp));
+    }
+    if (claims.has(Claim::Nbf) && claims.integer(Claim::Nbf) > now) {
+        problems << "not valid yet (nbf in the future)";
+    }
+
+    if (!nonce.isEmpty() && claims.string(Claim::Nonce) != nonce) {
+        problems << (claims.has(Claim::Nonce) ? "nonce does not match the request" : "nonce is missing");
+    }
+
+    return problems;
+}
+
+void OIDCManager::logIdTokenProblems(const QString& idToken)
+{
+    // The nonce is only sent for implicit and hybrid flows
+    bool nonceSent = m_config.responseType.contains("token") || m_config.responseType.contains("id_token");
+    const QStringList problems = checkIdTokenClaims(idToken, m_config.issuerURL, m_config.clientID, nonceSent ? m_nonce : QString());
+    for (const QString& problem : problems) {
+        emit logMessage(QString("⚠️ ID token check: %1").arg(problem));
+    }
+}
+
+void OIDCManager::beginExchange()
+{
+    m_exchangeTimer.start();
+    m_exchangeStartMs = m_recorder ? m_recorder->elapsedMs() : 0;
+}
+
+void OIDCManager::recordExchange(const CapturedExchange& exchange)
+{
+    CapturedExchange timed = exchange;
+    timed.startOffsetMs = m_exchangeStartMs;
+    timed.durationMs = qint32(m_exchangeTimer.elapsed());
+
+    // Behind a browser the callback time is mostly a person logging in, not
+    // IdP latency; only scripted authorizers measure the authorize round trips
+    if (exchange.kind == CapturedExchange::Callback && !(m_authorizer && m_authorizer->capturesCallback())) {
+        timed.durationMs = 0;
+    }
+    m_recorder->record(timed);
+}
+
+QString OIDCManager::formatTokenResponse(const JsonObjectView& json)
+{
+    QString result;
+
+    if (json.contains(QLatin1String("access_token"))) {
+        result += QString("Access Token: %1\n").arg(json.string(QLatin1String("access_token")));
+    }
+
+    if (json.contains(QLatin1String("id_token"))) {
+        result += QString("ID Token: %1\n").arg(json.string(QLatin1String("id_token")));
+    }
+
+    if (json.contains(QLatin1String("refresh_token"))) {
+        result += QString("Refresh Token: %1\n").arg(json.string(QLatin1String("refresh_token")));
+    }
+
+    if (json.contains(QLatin1String("token_type"))) {
+        result += QString("Token Type: %1\n").arg(json.string(QLatin1String("token_type")));
+    }
+
+    if (json.contains(QLatin1String("expires_in"))) {
+        result += QString("Expires In: %1 seconds\n").arg(json.integer(QLatin1String("expires_in")));
+    }
+
+    return result;
+}
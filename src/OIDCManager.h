@@ -7,69 +7,247 @@
 #include <QNetworkAccessManager>
 #include <QTcpServer>
 #include <QMap>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+#include <QUrlQuery>
+
+#include <QElapsedTimer>
+#include <QSslCertificate>
+#include <QSslKey>
+#include "JsonScanner.h"
+#include "NetworkTiming.h"
+#include "DpopProof.h"
+
+class Authorizer;
+class ExchangeRecorder;
+class DiscoveryCache;
+class TokenCache;
+class RetryPolicy;
+class TlsSessionCache;
+class QTimer;
+struct CapturedExchange;
+
+// Per-phase latency of the most recent flow in microseconds (-1 = phase not reached)
+struct FlowTimings
+{
+    qint64 discoveryUs = -1;
+    qint64 authorizeUs = -1;
+    qint64 tokenUs = -1;
+};
+
+// Everything one authorization flow is configured with
+struct OIDCConfig
+{
+    QString issuerURL;
+    QString clientID;
+    QString clientSecret;
+    QString scopes = "openid profile email";
+    QString acrValue = "None";
+    QString loginHint;
+    bool promptLogin = false;
+    QString responseType = "code";
+    QString extraParams;
+    bool skipStateValidation = false;
+    bool disablePKCE = false;
+
+    // RFC 8705 mutual TLS at the token endpoint: PEM certificate, and PEM
+    // private key (unencrypted; empty = in the certificate file)
+    QString clientCertificate;
+    QString clientKey;
+
+    // private_key_jwt (RFC 7523): PEM signing key for client assertions,
+    // replacing the client secret; kid sent in the assertion header
+    QString clientAssertionKey;
+    QString clientAssertionKeyId;
+
+    // Sender-constrained tokens (RFC 9449): DPoP proofs on token requests,
+    // from one ephemeral key per manager. Bypasses the token cache.
+    bool useDpop = false;
+};
 
 class OIDCManager : public QObject
 {
     Q_OBJECT
+    friend class OIDCManagerBenchmark;
 
 public:
     explicit OIDCManager(QObject *parent = nullptr);
     ~OIDCManager();
 
-    void startAuthentication(const QString& issuerURL,
-                            const QString& clientID,
-                            const QString& clientSecret,
-                            const QString& scopes,
-                            const QString& acrValue,
-                            const QString& loginHint,
-                            bool promptLogin,
-                            const QString& responseType,
-                            const QString& extraParams,
-                            bool skipStateValidation = false,
-                            bool disablePKCE = false);
+    void startAuthentication(const OIDCConfig& config);
+
+    // Session steps after a completed flow, against the same issuer: refresh
+    // emits tokensReceived, revoke emits tokensRevoked (errorOccurred on failure)
+    void refreshSession();
+    void revokeSession(const QString& tokenTypeHint = "refresh_token");
     
     void cancelAuthentication();
 
+    // Takes ownership; replaces (and deletes) the current authorizer
+    void setAuthorizer(Authorizer* authorizer);
+    Authorizer* authorizer() const { return m_authorizer; }
+
+    enum FlowKind { LoginFlow, RefreshFlow, RevokeFlow };
+
+    const FlowTimings& lastFlowTimings() const { return m_timings; }
+    FlowKind lastFlowKind() const { return m_flowKind; }
+
+    // Token response behind the last tokensReceived (implicit callbacks are
+    // converted to the same shape)
+    QJsonObject lastTokenResponse() const { return m_lastTokenResponse.toJsonObject(); }
+    const JsonObjectView& lastTokenResponseView() const { return m_lastTokenResponse; }
+    QString lastAuthorizationCode() const { return m_lastAuthorizationCode; }
+    qint64 flowElapsedUs() const { return m_flowTimer.nsecsElapsed() / 1000; }
+
+    // Captures discovery, callback and token exchanges; not owned, may be shared
+    void setRecorder(ExchangeRecorder* recorder) { m_recorder = recorder; }
+
+    // Consulted before fetching discovery and filled after a live fetch;
+    // not owned, nullptr always fetches. Bypassed while recording.
+    void setDiscoveryCache(DiscoveryCache* cache) { m_discoveryCache = cache; }
+
+    // Unexpired cached tokens are returned without any network traffic and
+    // expiring ones are refreshed; the interactive flow only runs when
+    // neither works. Not owned, nullptr always runs the full flow.
+    void setTokenCache(TokenCache* cache) { m_tokenCache = cache; }
+
+    // Retries and hedges refresh requests; not owned, may be shared.
+    // nullptr sends each refresh once.
+    void setRetryPolicy(RetryPolicy* policy) { m_retryPolicy = policy; }
+
+    // Fed the DNS/connect/TLS/TTFB breakdown of every request; not owned, may
+    // be shared. Each breakdown is logged either way.
+    void setNetworkTimingStats(NetworkTimingStats* stats) { m_networkStats = stats; }
+
+    // Offers and collects TLS session tickets so new connections can resume
+    // sessions from any manager; not owned, nullptr leaves resumption to the
+    // network access manager
+    void setTlsSessionCache(TlsSessionCache* cache) { m_tlsSessionCache = cache; }
+
+    // Key and server nonces behind this manager's DPoP-bound tokens, for proofs
+    // on resource requests made with them
+    DpopProofFactory* dpopProofs() { return &m_dpop; }
+
+    // private_key_jwt: assertions come from ClientAssertionPool::shared(), whose
+    // key the last flow loaded
+    bool usesClientAssertion() const { return !m_config.clientAssertionKey.isEmpty(); }
+
+    // Turns a raw HTTP request received on the callback server into the full
+    // callback URL (form_post bodies are appended as query); empty if malformed
+    static QString parseCallbackRequest(const QByteArray& request, int port);
+
+    // Formats a token endpoint response as "Access Token: ...\n" lines
+    static QString formatTokenResponse(const JsonObjectView& json);
+    static QString formatTokenResponse(const QJsonObject& json) { return formatTokenResponse(JsonObjectView(json)); }
+
+    // Problems with an ID token's iss, aud, exp/nbf and nonce claims (empty
+    // nonce = none was sent); read with ClaimExtractor, no JSON DOM
+    static QStringList checkIdTokenClaims(const QString& idToken, const QString& issuerURL,
+                                          const QString& clientID, const QString& nonce);
+
 signals:
     void progressUpdated(const QString& message);
     void errorOccurred(const QString& error);
     void tokensReceived(const QString& tokens);
+    void tokensRevoked();
     void logMessage(const QString& message);
 
 private slots:
     void onDiscoveryFinished();
     void onTokenExchangeFinished();
+    void onRefreshFinished();
+    void onHedgeTimeout();
+    void onRevokeFinished();
     void onNewConnection();
     void onReadyRead();
+    void onCallbackCaptured(const QUrl& url);
 
 private:
+    void applyDiscoveryDocument(const JsonObjectView& json);
+    void startAuthorization();
+    void refreshTokens(const QString& refreshToken);
+    void sendRefreshAttempt(bool hedge);
+    void finishRefresh(QNetworkReply* reply);
     QUrl buildAuthorizationURL(const QString& authEndpoint);
     void exchangeCodeForTokens(const QString& code, const QString& tokenEndpoint);
+    void postTokenExchange();
+    bool acceptDpopNonce(QNetworkReply* reply);
     void handleAuthCallback(const QUrl& url);
-    QString parseCallbackURL(const QString& urlString);
+    void logIdTokenProblems(const QString& idToken);
+    void beginExchange();
+    void recordExchange(const CapturedExchange& exchange);
+    void reportRequestTimings(QNetworkReply* reply, NetworkTimingStats::Endpoint endpoint);
+    bool loadClientCertificate();
+
+    // client_secret, or a pooled client assertion for the endpoint being called
+    void addClientAuthentication(QUrlQuery& postData, const QString& audience);
+
+    // All requests go through here: TLS client authentication (token endpoint
+    // requests), cached session tickets and connection timing; GET without a body
+    QNetworkReply* sendRequest(QNetworkRequest request, const QByteArray* body, bool clientAuthentication);
+    QNetworkAccessManager* clientAuthNetworkManager();
+
+    // QNetworkAccessManager keeps one connection per origin and applies a
+    // request's TLS configuration only when it creates it; this tracks which
+    // request did, so ticket statistics describe the configuration really used
+    struct ConnectionState
+    {
+        bool ticketOffered = false;
+        int inFlight = 0;
+        QElapsedTimer idle;
+    };
     
     QNetworkAccessManager* m_networkManager;
+    QNetworkAccessManager* m_clientAuthNetworkManager;   // mTLS requests; recreated per certificate
+    QHash<QString, ConnectionState> m_connections;
     QTcpServer* m_callbackServer;
+    Authorizer* m_authorizer;
+    ExchangeRecorder* m_recorder;
+    DiscoveryCache* m_discoveryCache;
+    TokenCache* m_tokenCache;
+    RetryPolicy* m_retryPolicy;
+    QTimer* m_hedgeTimer;
+    NetworkTimingStats* m_networkStats;
+    TlsSessionCache* m_tlsSessionCache;
+    QString m_tokenCacheKey;
+    QString m_pendingRefreshToken;
+    JsonObjectView m_lastTokenResponse;
+    QString m_lastAuthorizationCode;
+    QElapsedTimer m_exchangeTimer;
+    QElapsedTimer m_flowTimer;
+    FlowTimings m_timings;
+    FlowKind m_flowKind;
+    qint64 m_exchangeStartMs;
+    QByteArray m_tokenRequestBody;
+    QUrlQuery m_tokenExchangeParameters;
+    QString m_tokenExchangeEndpoint;
+    DpopProofFactory m_dpop;
+
+    // Attempts of the refresh in progress
+    QByteArray m_refreshBody;
+    QList<QNetworkReply*> m_refreshReplies;
+    QNetworkReply* m_hedgeReply;     // hedge still in flight, else null
+    int m_refreshAttempts;
+    quint64 m_refreshGeneration;
     
-    QString m_issuerURL;
-    QString m_clientID;
-    QString m_clientSecret;
-    QString m_scopes;
-    QString m_acrValue;
-    QString m_loginHint;
-    bool m_promptLogin;
-    QString m_responseType;
-    QString m_extraParams;
+    OIDCConfig m_config;
+    QSslCertificate m_clientCertificate;
+    QSslKey m_clientKey;
+    QString m_loadedCertificatePath;
+    QString m_loadedKeyPath;
     QString m_redirectURI;
     QString m_authorizationEndpoint;
     QString m_tokenEndpoint;
+    QString m_revocationEndpoint;
     QString m_state;
+    QString m_nonce;
     QString m_codeVerifier;
     QString m_codeChallenge;
-    bool m_skipStateValidation;
-    bool m_disablePKCE;
 
     static const int CALLBACK_PORT = 8080;
+    static const int CONNECTION_CACHE_EXPIRY_MS = 120 * 1000;   // Qt's idle connection lifetime
+    static const qint64 REFRESH_MARGIN_MS = 60 * 1000;
 };
 
 #endif // OIDCMANAGER_H
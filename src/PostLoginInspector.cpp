@@ -0,0 +1,145 @@
+#include "PostLoginInspector.h"
+#include "DpopProof.h"
+#include "ClientAssertion.h"
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QUrlQuery>
+
+static const char* INDEX_PROPERTY = "inspectionIndex";
+static const char* GENERATION_PROPERTY = "inspectionGeneration";
+
+PostLoginInspector::PostLoginInspector(QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_pending(0)
+    , m_generation(0)
+{
+}
+
+void PostLoginInspector::inspect(const QJsonObject& discovery, const QByteArray& cachedJwks, const QString& accessToken,
+                                 const QString& clientID, const QString& clientSecret, bool clientAssertion,
+                                 DpopProofFactory* dpop)
+{
+    // A new inspection supersedes one still in flight
+    ++m_generation;
+    m_calls.clear();
+    m_pending = 0;
+    m_timer.start();
+
+    QString userinfoEndpoint = discovery["userinfo_endpoint"].toString();
+    if (!userinfoEndpoint.isEmpty() && !accessToken.isEmpty()) {
+        QNetworkRequest request(userinfoEndpoint);
+        if (dpop) {
+            request.setRawHeader("Authorization", "DPoP " + accessToken.toUtf8());
+            request.setRawHeader("DPoP", dpop->proof("GET", request.url(), accessToken));
+        } else {
+            request.setRawHeader("Authorization", "Bearer " + accessToken.toUtf8());
+        }
+        track(m_networkManager->get(request), "userinfo");
+    }
+
+    QString introspectionEndpoint = discovery["introspection_endpoint"].toString();
+    if (!introspectionEndpoint.isEmpty() && !accessToken.isEmpty()) {
+        QNetworkRequest request(introspectionEndpoint);
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+        QUrlQuery postData;
+        postData.addQueryItem("token", accessToken);
+        postData.addQueryItem("token_type_hint", "access_token");
+        if (clientAssertion) {
+            // Same pool and audience rule as the token endpoint: the endpoint being called
+            postData.addQueryItem("client_id", clientID);
+            postData.addQueryItem("client_assertion_type", "urn:ietf:params:oauth:client-assertion-type:jwt-bearer");
+            postData.addQueryItem("client_assertion", QString::fromLatin1(
+                ClientAssertionPool::shared()->take(clientID, introspectionEndpoint)));
+        } else if (clientSecret.isEmpty()) {
+            postData.addQueryItem("client_id", clientID);
+        } else {
+            QByteArray credentials = QUrl::toPercentEncoding(clientID) + ":" + QUrl::toPercentEncoding(clientSecret);
+            request.setRawHeader("Authorization", "Basic " + credentials.toBase64());
+        }
+        track(m_networkManager->post(request, postData.toString(QUrl::FullyEncoded).toUtf8()), "introspection");
+    }
+
+    QString jwksURI = discovery["jwks_uri"].toString();
+    if (!jwksURI.isEmpty() && !cachedJwks.isEmpty()) {
+        InspectionCall call;
+        call.name = "jwks (cached)";
+        call.url = jwksURI;
+        call.status = 200;
+        call.elapsedMs = 0;
+        call.body = cachedJwks;
+        m_calls.append(call);
+    } else if (!jwksURI.isEmpty()) {
+        track(m_networkManager->get(QNetworkRequest(QUrl(jwksURI))), "jwks");
+    }
+
+    if (m_pending == 0) {
+        if (m_calls.isEmpty()) {
+            emit logMessage("Post-login checks skipped: discovery advertises no userinfo, introspection or JWKS endpoint");
+        }
+        emit finished(m_calls, 0);
+        return;
+    }
+
+    emit logMessage(QString("Post-login checks started: %1 concurrent call(s)").arg(m_pending));
+}
+
+void PostLoginInspector::track(QNetworkReply* reply, const QString& name)
+{
+    InspectionCall call;
+    call.name = name;
+    call.url = reply->url().toString();
+    m_calls.append(call);
+
+    reply->setProperty(INDEX_PROPERTY, m_calls.size() - 1);
+    reply->setProperty(GENERATION_PROPERTY, m_generation);
+    ++m_pending;
+    connect(reply, &QNetworkReply::finished, this, &PostLoginInspector::onCallFinished);
+}
+
+void PostLoginInspector::onCallFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+
+    reply->deleteLater();
+    if (reply->property(GENERATION_PROPERTY).toInt() != m_generation) return;
+
+    InspectionCall& call = m_calls[reply->property(INDEX_PROPERTY).toInt()];
+    call.elapsedMs = m_timer.elapsed();
+    call.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    call.body = reply->readAll();
+    if (reply->error() != QNetworkReply::NoError) {
+        call.error = reply->errorString();
+    }
+
+    emit logMessage(QString("Post-login %1: HTTP %2 in %3 ms").arg(call.name).arg(call.status).arg(call.elapsedMs));
+
+    if (--m_pending == 0) {
+        emit finished(m_calls, m_timer.elapsed());
+    }
+}
+
+QString PostLoginInspector::formatReport(const QList<InspectionCall>& calls, qint64 totalMs)
+{
+    QString report;
+    qint64 sumMs = 0;
+    for (const InspectionCall& call : calls) {
+        report += QString("%1 HTTP %2  %3 ms%4\n")
+                      .arg(call.name, -14)
+                      .arg(call.status)
+                      .arg(call.elapsedMs, 6)
+                      .arg(call.error.isEmpty() ? QString() : "  (" + call.error + ")");
+        sumMs += qMax<qint64>(0, call.elapsedMs);
+    }
+    report += QString("Total %1 ms (sequential would be ~%2 ms)\n").arg(totalMs).arg(sumMs);
+
+    for (const InspectionCall& call : calls) {
+        report += QString("\n=== %1 (%2) ===\n").arg(call.name, call.url);
+        QJsonDocument doc = QJsonDocument::fromJson(call.body);
+        report += doc.isNull() ? QString::fromUtf8(call.body) : QString::fromUtf8(doc.toJson(QJsonDocument::Indented));
+    }
+    return report;
+}
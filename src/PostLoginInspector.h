@@ -0,0 +1,65 @@
+#ifndef POSTLOGININSPECTOR_H
+#define POSTLOGININSPECTOR_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+
+class QNetworkReply;
+class DpopProofFactory;
+
+// Outcome of one post-login call
+struct InspectionCall
+{
+    QString name;           // "userinfo", "introspection" or "jwks"
+    QString url;
+    int status = 0;
+    qint64 elapsedMs = -1;  // 0 for a cached JWKS
+    QByteArray body;
+    QString error;
+};
+
+// Checks freshly issued tokens against the userinfo, RFC 7662 introspection
+// and JWKS endpoints named in the discovery document. All calls go out at
+// once, so the stage costs the slowest call rather than the sum. Endpoints the
+// provider does not advertise are skipped, and a JWKS the caller already holds
+// (e.g. from DiscoveryCache) is reported instead of fetched again.
+class PostLoginInspector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PostLoginInspector(QObject *parent = nullptr);
+
+    // With clientAssertion, introspection authenticates with a pooled
+    // private_key_jwt assertion instead of the secret. With dpop, the access
+    // token is DPoP-bound and userinfo gets a proof from it.
+    void inspect(const QJsonObject& discovery, const QByteArray& cachedJwks, const QString& accessToken,
+                 const QString& clientID, const QString& clientSecret, bool clientAssertion,
+                 DpopProofFactory* dpop = nullptr);
+    bool isRunning() const { return m_pending > 0; }
+
+    // Per-call latencies followed by each (pretty-printed) response
+    static QString formatReport(const QList<InspectionCall>& calls, qint64 totalMs);
+
+signals:
+    void finished(const QList<InspectionCall>& calls, qint64 totalMs);
+    void logMessage(const QString& message);
+
+private slots:
+    void onCallFinished();
+
+private:
+    void track(QNetworkReply* reply, const QString& name);
+
+    QNetworkAccessManager* m_networkManager;
+    QList<InspectionCall> m_calls;
+    QElapsedTimer m_timer;
+    int m_pending;
+    int m_generation;
+};
+
+#endif // POSTLOGININSPECTOR_H
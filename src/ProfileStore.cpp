@@ -0,0 +1,142 @@
+#include "ProfileStore.h"
+#include <QSettings>
+
+const QString ProfileStore::DEFAULT_PROFILE = "Default";
+
+static OIDCProfile readProfile(const QSettings& settings)
+{
+    OIDCProfile profile;
+    profile.issuerURL = settings.value("issuerURL", "").toString();
+    profile.clientID = settings.value("clientID", "").toString();
+    profile.clientSecret = settings.value("clientSecret", "").toString();
+    profile.scopes = settings.value("scopes", profile.scopes).toString();
+    profile.acrValue = settings.value("acrValue", profile.acrValue).toString();
+    profile.loginHint = settings.value("loginHint", "").toString();
+    profile.promptLogin = settings.value("promptLogin", false).toBool();
+    profile.responseType = settings.value("responseType", profile.responseType).toString();
+    profile.extraParams = settings.value("extraParams", "").toString();
+    profile.skipStateValidation = settings.value("skipStateValidation", false).toBool();
+    profile.disablePKCE = settings.value("disablePKCE", false).toBool();
+    profile.clientCertificate = settings.value("clientCertificate", "").toString();
+    profile.clientKey = settings.value("clientKey", "").toString();
+    profile.clientAssertionKey = settings.value("clientAssertionKey", "").toString();
+    profile.clientAssertionKeyId = settings.value("clientAssertionKeyId", "").toString();
+    profile.useDpop = settings.value("useDpop", false).toBool();
+    profile.authorizer = settings.value("authorizer", profile.authorizer).toString();
+    profile.loginFormFields = settings.value("loginFormFields", "").toString();
+    profile.useTokenCache = settings.value("useTokenCache", true).toBool();
+    profile.postLoginChecks = settings.value("postLoginChecks", false).toBool();
+    return profile;
+}
+
+static void writeProfile(QSettings& settings, const OIDCProfile& profile)
+{
+    settings.setValue("name", profile.name);
+    settings.setValue("issuerURL", profile.issuerURL);
+    settings.setValue("clientID", profile.clientID);
+    settings.setValue("clientSecret", profile.clientSecret);
+    settings.setValue("scopes", profile.scopes);
+    settings.setValue("acrValue", profile.acrValue);
+    settings.setValue("loginHint", profile.loginHint);
+    settings.setValue("promptLogin", profile.promptLogin);
+    settings.setValue("responseType", profile.responseType);
+    settings.setValue("extraParams", profile.extraParams);
+    settings.setValue("skipStateValidation", profile.skipStateValidation);
+    settings.setValue("disablePKCE", profile.disablePKCE);
+    settings.setValue("clientCertificate", profile.clientCertificate);
+    settings.setValue("clientKey", profile.clientKey);
+    settings.setValue("clientAssertionKey", profile.clientAssertionKey);
+    settings.setValue("clientAssertionKeyId", profile.clientAssertionKeyId);
+    settings.setValue("useDpop", profile.useDpop);
+    settings.setValue("authorizer", profile.authorizer);
+    settings.setValue("loginFormFields", profile.loginFormFields);
+    settings.setValue("useTokenCache", profile.useTokenCache);
+    settings.setValue("postLoginChecks", profile.postLoginChecks);
+}
+
+ProfileStore::ProfileStore()
+    : m_currentName(DEFAULT_PROFILE)
+{
+}
+
+void ProfileStore::load()
+{
+    QSettings settings;
+    m_profiles.clear();
+
+    int count = settings.beginReadArray("profiles");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        OIDCProfile profile = readProfile(settings);
+        profile.name = settings.value("name").toString();
+        if (!profile.name.isEmpty()) {
+            m_profiles.insert(profile.name, profile);
+        }
+    }
+    settings.endArray();
+
+    if (m_profiles.isEmpty()) {
+        // Settings written before profiles existed live at the top level
+        OIDCProfile legacy = readProfile(settings);
+        legacy.name = DEFAULT_PROFILE;
+        m_profiles.insert(legacy.name, legacy);
+    }
+
+    setCurrentName(settings.value("currentProfile", DEFAULT_PROFILE).toString());
+}
+
+void ProfileStore::save() const
+{
+    QSettings settings;
+
+    settings.remove("profiles");
+    settings.beginWriteArray("profiles", m_profiles.size());
+    int index = 0;
+    for (const OIDCProfile& profile : m_profiles) {
+        settings.setArrayIndex(index++);
+        writeProfile(settings, profile);
+    }
+    settings.endArray();
+
+    settings.setValue("currentProfile", m_currentName);
+}
+
+void ProfileStore::setProfile(const OIDCProfile& profile)
+{
+    if (profile.name.isEmpty()) return;
+    m_profiles.insert(profile.name, profile);
+}
+
+void ProfileStore::removeProfile(const QString& name)
+{
+    m_profiles.remove(name);
+    if (m_profiles.isEmpty()) {
+        OIDCProfile empty;
+        empty.name = DEFAULT_PROFILE;
+        m_profiles.insert(empty.name, empty);
+    }
+    if (!m_profiles.contains(m_currentName)) {
+        m_currentName = m_profiles.firstKey();
+    }
+}
+
+void ProfileStore::setCurrentName(const QString& name)
+{
+    if (m_profiles.contains(name) || m_profiles.isEmpty()) {
+        m_currentName = name;
+    } else {
+        m_currentName = m_profiles.firstKey();
+    }
+}
+
+QStringList ProfileStore::issuerURLs() const
+{
+    QStringList issuers;
+    for (const OIDCProfile& profile : m_profiles) {
+        QString issuer = profile.issuerURL.trimmed();
+        if (!issuer.isEmpty() && !issuers.contains(issuer)) {
+            issuers.append(issuer);
+        }
+    }
+    return issuers;
+}
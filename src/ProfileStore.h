@@ -0,0 +1,67 @@
+#ifndef PROFILESTORE_H
+#define PROFILESTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+
+// One named issuer/client configuration as edited on the Config tab
+struct OIDCProfile
+{
+    QString name;
+    QString issuerURL;
+    QString clientID;
+    QString clientSecret;
+    QString scopes = "openid profile email";
+    QString acrValue = "None";
+    QString loginHint;
+    bool promptLogin = false;
+    QString responseType = "code";
+    QString extraParams;
+    bool skipStateValidation = false;
+    bool disablePKCE = false;
+    QString clientCertificate;
+    QString clientKey;
+    QString clientAssertionKey;
+    QString clientAssertionKeyId;
+    bool useDpop = false;
+    QString authorizer = "browser";
+    QString loginFormFields;
+    bool useTokenCache = true;
+    bool postLoginChecks = false;
+};
+
+// Named profiles persisted as a QSettings array. Everything is read in one
+// pass by load(), so switching profiles afterwards never touches the settings
+// backend. The single pre-profile configuration is migrated to "Default".
+class ProfileStore
+{
+public:
+    ProfileStore();
+
+    void load();
+    void save() const;
+
+    QStringList names() const { return m_profiles.keys(); }
+    bool contains(const QString& name) const { return m_profiles.contains(name); }
+    OIDCProfile profile(const QString& name) const { return m_profiles.value(name); }
+
+    // Adds or replaces the profile with the same name
+    void setProfile(const OIDCProfile& profile);
+    void removeProfile(const QString& name);
+
+    QString currentName() const { return m_currentName; }
+    void setCurrentName(const QString& name);
+    OIDCProfile current() const { return m_profiles.value(m_currentName); }
+
+    // Distinct issuer URLs across all profiles, for discovery prefetch
+    QStringList issuerURLs() const;
+
+    static const QString DEFAULT_PROFILE;
+
+private:
+    QMap<QString, OIDCProfile> m_profiles;
+    QString m_currentName;
+};
+
+#endif // PROFILESTORE_H
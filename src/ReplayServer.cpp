@@ -0,0 +1,244 @@
+#include "ReplayServer.h"
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+static QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 302: return "Found";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 500: return "Internal Server Error";
+    default: return "Status";
+    }
+}
+
+ReplayServer::ReplayServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_timeScale(1.0)
+    , m_served(0)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &ReplayServer::onNewConnection);
+}
+
+bool ReplayServer::load(const QString& capturePath, QString* error)
+{
+    if (!ExchangeRecorder::load(capturePath, &m_exchanges, error)) {
+        return false;
+    }
+
+    m_byKind.clear();
+    m_cursor.clear();
+    for (int i = 0; i < m_exchanges.size(); ++i) {
+        m_byKind[m_exchanges[i].kind].append(i);
+    }
+
+    if (m_byKind.value(CapturedExchange::Discovery).isEmpty()) {
+        *error = QString("Capture %1 contains no discovery exchange").arg(capturePath);
+        return false;
+    }
+
+    // The recorded issuer is the discovery URL minus the well-known suffix
+    QUrl discoveryURL = QUrl::fromEncoded(m_exchanges[m_byKind[CapturedExchange::Discovery].first()].url);
+    m_recordedOrigin = discoveryURL.adjusted(QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toEncoded();
+    m_recordedIssuerPath = discoveryURL.path().toUtf8();
+    m_recordedIssuerPath.chop(QByteArray("/.well-known/openid-configuration").size());
+
+    // Endpoints may live on other hosts than discovery; all of them are served here
+    const QJsonObject discovery = QJsonDocument::fromJson(
+        m_exchanges[m_byKind[CapturedExchange::Discovery].first()].responseBody).object();
+    QSet<QByteArray> origins = {m_recordedOrigin};
+    for (auto it = discovery.constBegin(); it != discovery.constEnd(); ++it) {
+        QUrl endpoint(it.value().toString());
+        if (endpoint.scheme().startsWith("http") && !endpoint.host().isEmpty()) {
+            origins.insert(endpoint.adjusted(QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toEncoded());
+        }
+    }
+    m_endpointOrigins = QList<QByteArray>(origins.begin(), origins.end());
+    // Longest first, so https://idp:8443 is not rewritten as https://idp plus ":8443"
+    std::sort(m_endpointOrigins.begin(), m_endpointOrigins.end(),
+              [](const QByteArray& a, const QByteArray& b) { return a.size() > b.size(); });
+
+    m_authorizePath = QUrl(discovery.value("authorization_endpoint").toString()).path();
+    m_tokenPaths.clear();
+    for (int index : m_byKind.value(CapturedExchange::Token)) {
+        m_tokenPaths.insert(QUrl::fromEncoded(m_exchanges[index].url).path());
+    }
+
+    emit logMessage(QString("Loaded %1 recorded exchanges (%2 discovery, %3 callback, %4 token) from %5")
+                   .arg(m_exchanges.size())
+                   .arg(m_byKind.value(CapturedExchange::Discovery).size())
+                   .arg(m_byKind.value(CapturedExchange::Callback).size())
+                   .arg(m_byKind.value(CapturedExchange::Token).size())
+                   .arg(capturePath));
+    return true;
+}
+
+bool ReplayServer::listen(quint16 port, QString* error)
+{
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        *error = QString("Failed to start replay server on port %1: %2").arg(port).arg(m_server->errorString());
+        return false;
+    }
+
+    emit logMessage(QString("Replaying %1 as issuer %2 (time scale %3)")
+                   .arg(QString::fromUtf8(m_recordedOrigin + m_recordedIssuerPath), issuerURL())
+                   .arg(m_timeScale));
+    return true;
+}
+
+QString ReplayServer::issuerURL() const
+{
+    return QString("http://127.0.0.1:%1%2").arg(m_server->serverPort()).arg(QString::fromUtf8(m_recordedIssuerPath));
+}
+
+void ReplayServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, &ReplayServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ReplayServer::onReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    QByteArray& buffer = m_buffers[socket];
+    buffer += socket->readAll();
+
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return;
+
+    QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    int contentLength = 0;
+    for (const QByteArray& line : lines) {
+        if (line.toLower().startsWith("content-length:")) {
+            contentLength = line.mid(line.indexOf(':') + 1).trimmed().toInt();
+        }
+    }
+
+    // Wait for the whole body
+    if (buffer.size() < headerEnd + 4 + contentLength) return;
+
+    QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+    m_buffers.remove(socket);
+
+    handleRequest(socket, requestLine[0], QUrl::fromEncoded("http://localhost" + requestLine[1]), body);
+}
+
+void ReplayServer::handleRequest(QTcpSocket* socket, const QByteArray& method, const QUrl& url, const QByteArray& body)
+{
+    Q_UNUSED(body);
+
+    CapturedExchange::Kind kind;
+    QUrlQuery query(url);
+
+    // Captures without an authorization_endpoint in discovery fall back to the query
+    const bool authorizeRequest = m_authorizePath.isEmpty() ? query.hasQueryItem("response_type")
+                                                            : url.path() == m_authorizePath;
+
+    if (url.path().endsWith("/.well-known/openid-configuration")) {
+        kind = CapturedExchange::Discovery;
+    } else if (method == "POST" && m_tokenPaths.contains(url.path())) {
+        kind = CapturedExchange::Token;
+    } else if (method == "GET" && authorizeRequest) {
+        kind = CapturedExchange::Callback;
+    } else {
+        CapturedExchange notFound;
+        respond(socket, notFound, 404, QByteArray(), QByteArray());
+        return;
+    }
+
+    const CapturedExchange* exchange = next(kind);
+    if (!exchange) {
+        emit logMessage(QString("No recorded exchange to replay for %1 %2")
+                       .arg(QString::fromUtf8(method), url.path()));
+        CapturedExchange notFound;
+        respond(socket, notFound, 404, QByteArray(), QByteArray());
+        return;
+    }
+
+    int delayMs = qRound(exchange->durationMs * m_timeScale);
+    CapturedExchange recorded = *exchange;
+
+    QTimer::singleShot(delayMs, socket, [this, socket, recorded, kind, query]() {
+        if (kind == CapturedExchange::Callback) {
+            // Redirect to the recorded callback, carrying the live state so validation passes
+            QUrl callback = QUrl::fromEncoded(recorded.url);
+            QUrlQuery callbackQuery(callback);
+            callbackQuery.removeAllQueryItems("state");
+            callbackQuery.addQueryItem("state", query.queryItemValue("state"));
+            callback.setQuery(callbackQuery);
+            respond(socket, recorded, 302, "Location: " + callback.toEncoded() + "\r\n", QByteArray());
+        } else if (kind == CapturedExchange::Discovery) {
+            respond(socket, recorded, recorded.status, QByteArray(), rewriteOrigin(recorded.responseBody));
+        } else {
+            respond(socket, recorded, recorded.status, QByteArray(), recorded.responseBody);
+        }
+    });
+}
+
+void ReplayServer::respond(QTcpSocket* socket, const CapturedExchange& exchange, int status,
+                           const QByteArray& extraHeaders, const QByteArray& body)
+{
+    QByteArray contentType = exchange.contentType.isEmpty() ? QByteArray("application/json") : exchange.contentType;
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reasonPhrase(status) + "\r\n"
+                          "Content-Type: " + contentType + "\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          "Connection: close\r\n" +
+                          extraHeaders +
+                          "\r\n" +
+                          body;
+
+    socket->write(response);
+    socket->disconnectFromHost();
+    ++m_served;
+}
+
+const CapturedExchange* ReplayServer::next(CapturedExchange::Kind kind)
+{
+    const QList<int>& indexes = m_byKind[kind];
+    if (indexes.isEmpty()) return nullptr;
+
+    // Cycle through the recording so a replay can run more flows than were captured
+    int& cursor = m_cursor[kind];
+    const CapturedExchange* exchange = &m_exchanges[indexes[cursor % indexes.size()]];
+    ++cursor;
+    return exchange;
+}
+
+QByteArray ReplayServer::rewriteOrigin(const QByteArray& data) const
+{
+    QByteArray localOrigin = QString("http://127.0.0.1:%1").arg(m_server->serverPort()).toUtf8();
+    QByteArray escapedLocal = localOrigin;
+    escapedLocal.replace("/", "\\/");
+
+    QByteArray rewritten = data;
+    for (const QByteArray& origin : m_endpointOrigins) {
+        QByteArray escapedRecorded = origin;
+        escapedRecorded.replace("/", "\\/");
+        rewritten.replace(origin, localOrigin);
+        rewritten.replace(escapedRecorded, escapedLocal);
+    }
+    return rewritten;
+}
@@ -0,0 +1,65 @@
+#ifndef REPLAYSERVER_H
+#define REPLAYSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include "ExchangeCapture.h"
+
+class QTcpSocket;
+
+// Local stand-in IdP serving a recorded capture. Discovery is rewritten to
+// point every recorded endpoint origin at this server, the authorize endpoint
+// redirects straight to the next recorded callback (with the live state
+// substituted) and the token endpoint returns the next recorded token
+// response; requests are dispatched on the recorded paths. Responses are
+// delayed by the recorded duration times the time scale (0 = as fast as
+// possible).
+class ReplayServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayServer(QObject *parent = nullptr);
+
+    bool load(const QString& capturePath, QString* error);
+    bool listen(quint16 port, QString* error);
+
+    void setTimeScale(double scale) { m_timeScale = qMax(0.0, scale); }
+
+    // Issuer URL clients should use instead of the recorded one
+    QString issuerURL() const;
+
+    int servedCount() const { return m_served; }
+
+signals:
+    void logMessage(const QString& message);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    void handleRequest(QTcpSocket* socket, const QByteArray& method, const QUrl& url, const QByteArray& body);
+    void respond(QTcpSocket* socket, const CapturedExchange& exchange, int status,
+                 const QByteArray& extraHeaders, const QByteArray& body);
+    const CapturedExchange* next(CapturedExchange::Kind kind);
+    QByteArray rewriteOrigin(const QByteArray& data) const;
+
+    QTcpServer* m_server;
+    QList<CapturedExchange> m_exchanges;
+    QHash<int, QList<int>> m_byKind;
+    QHash<int, int> m_cursor;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QByteArray m_recordedOrigin;
+    QList<QByteArray> m_endpointOrigins;   // longest first
+    QString m_authorizePath;
+    QSet<QString> m_tokenPaths;
+    QByteArray m_recordedIssuerPath;
+    double m_timeScale;
+    int m_served;
+};
+
+#endif // REPLAYSERVER_H
@@ -0,0 +1,336 @@
+#include "ResultsFile.h"
+#include <cstring>
+#include <algorithm>
+
+static const quint32 RESULTS_MAGIC = 0x4F524553; // "ORES"
+static const quint32 BLOCK_MAGIC = 0x4F52424B;   // "ORBK"
+static const quint16 RESULTS_VERSION = 1;
+static const quint16 BYTE_ORDER_MARK = 0x0102;   // reads back as 0x0201 on the other endianness
+
+namespace {
+
+struct FileHeader
+{
+    quint32 magic;
+    quint16 version;
+    quint16 byteOrderMark;
+    qint64 runStartEpochMs;
+    quint32 blockRows;
+    quint8 reserved[12];
+};
+
+struct BlockHeader
+{
+    quint32 magic;
+    quint32 rows;
+    qint64 minFinishedUs;
+    qint64 maxFinishedUs;
+};
+
+static_assert(sizeof(FileHeader) == 32, "results file header layout");
+static_assert(sizeof(BlockHeader) == 24, "results block header layout");
+
+// Bytes per row across all columns
+const qint64 ROW_BYTES = 8 + 4 * 4 + 4 + 1;
+
+qint64 paddedColumnBytes(qint64 rows)
+{
+    return (rows * ROW_BYTES + 7) & ~qint64(7);
+}
+
+}
+
+QString FlowResult::errorClassName(ErrorClass errorClass)
+{
+    switch (errorClass) {
+    case NoError: return "ok";
+    case DiscoveryError: return "discovery";
+    case AuthorizeError: return "authorize";
+    case TokenError: return "token";
+    case SessionError: return "session";
+    case ErrorClassCount: break;
+    }
+    return QString();
+}
+
+QString FlowResult::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Total: return "total";
+    case Discovery: return "discovery";
+    case Authorize: return "authorize";
+    case Token: return "token";
+    case PhaseCount: break;
+    }
+    return QString();
+}
+
+ResultsWriter::ResultsWriter()
+    : m_headerWritten(false)
+    , m_runStartEpochMs(0)
+    , m_rows(0)
+{
+}
+
+ResultsWriter::~ResultsWriter()
+{
+    close();
+}
+
+bool ResultsWriter::open(const QString& path, QString* error)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *error = QString("Failed to open results file %1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    m_headerWritten = false;
+    m_rows = 0;
+    for (auto* column : {&m_discoveryUs, &m_authorizeUs, &m_tokenUs, &m_totalUs}) {
+        column->reserve(BLOCK_ROWS);
+    }
+    m_finishedUs.reserve(BLOCK_ROWS);
+    m_tokenBytes.reserve(BLOCK_ROWS);
+    m_errorClass.reserve(BLOCK_ROWS);
+    return true;
+}
+
+void ResultsWriter::close()
+{
+    if (!m_file.isOpen()) return;
+
+    flush();
+    if (!m_headerWritten) {
+        writeHeader();
+    }
+    m_file.close();
+}
+
+void ResultsWriter::writeHeader()
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = RESULTS_MAGIC;
+    header.version = RESULTS_VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.runStartEpochMs = m_runStartEpochMs;
+    header.blockRows = BLOCK_ROWS;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_headerWritten = true;
+}
+
+void ResultsWriter::append(const FlowResult& row)
+{
+    if (!m_file.isOpen()) return;
+
+    m_finishedUs.append(row.finishedUs);
+    m_discoveryUs.append(row.discoveryUs);
+    m_authorizeUs.append(row.authorizeUs);
+    m_tokenUs.append(row.tokenUs);
+    m_totalUs.append(row.totalUs);
+    m_tokenBytes.append(row.tokenBytes);
+    m_errorClass.append(row.errorClass);
+    ++m_rows;
+
+    if (m_finishedUs.size() >= BLOCK_ROWS) {
+        flush();
+    }
+}
+
+void ResultsWriter::flush()
+{
+    if (!m_file.isOpen() || m_finishedUs.isEmpty()) return;
+
+    // The header is deferred so it can carry the run start set after open()
+    if (!m_headerWritten) {
+        writeHeader();
+    }
+
+    const qint64 rows = m_finishedUs.size();
+    BlockHeader header;
+    header.magic = BLOCK_MAGIC;
+    header.rows = quint32(rows);
+    header.minFinishedUs = *std::min_element(m_finishedUs.constBegin(), m_finishedUs.constEnd());
+    header.maxFinishedUs = *std::max_element(m_finishedUs.constBegin(), m_finishedUs.constEnd());
+
+    QByteArray block;
+    block.reserve(sizeof(header) + paddedColumnBytes(rows));
+    block.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    block.append(reinterpret_cast<const char*>(m_finishedUs.constData()), rows * sizeof(qint64));
+    for (const QVector<qint32>* column : {&m_discoveryUs, &m_authorizeUs, &m_tokenUs, &m_totalUs}) {
+        block.append(reinterpret_cast<const char*>(column->constData()), rows * sizeof(qint32));
+    }
+    block.append(reinterpret_cast<const char*>(m_tokenBytes.constData()), rows * sizeof(quint32));
+    block.append(reinterpret_cast<const char*>(m_errorClass.constData()), rows);
+    block.append(int(paddedColumnBytes(rows) - rows * ROW_BYTES), '\0');
+
+    // One write per block, so a reader never sees a block header without its columns
+    // unless the process died mid-write
+    m_file.write(block);
+    m_file.flush();
+
+    m_finishedUs.clear();
+    m_discoveryUs.clear();
+    m_authorizeUs.clear();
+    m_tokenUs.clear();
+    m_totalUs.clear();
+    m_tokenBytes.clear();
+    m_errorClass.clear();
+}
+
+ResultsReader::ResultsReader()
+    : m_map(nullptr)
+    , m_rows(0)
+    , m_runStartEpochMs(0)
+    , m_lastFinishedUs(0)
+    , m_truncated(false)
+{
+}
+
+ResultsReader::~ResultsReader()
+{
+    close();
+}
+
+bool ResultsReader::open(const QString& path, QString* error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        *error = QString("Failed to open results file %1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(FileHeader))) {
+        *error = QString("%1 is not a results file").arg(path);
+        return false;
+    }
+
+    m_map = m_file.map(0, size);
+    if (!m_map) {
+        *error = QString("Failed to map %1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, m_map, sizeof(header));
+    if (header.magic != RESULTS_MAGIC) {
+        *error = QString("%1 is not a results file").arg(path);
+        close();
+        return false;
+    }
+    if (header.byteOrderMark != BYTE_ORDER_MARK) {
+        *error = QString("%1 was written on a machine of the other byte order").arg(path);
+        close();
+        return false;
+    }
+    if (header.version != RESULTS_VERSION) {
+        *error = QString("Unsupported results file version %1").arg(header.version);
+        close();
+        return false;
+    }
+    m_runStartEpochMs = header.runStartEpochMs;
+
+    // Index the blocks; only their headers are touched
+    qint64 offset = sizeof(FileHeader);
+    while (offset + qint64(sizeof(BlockHeader)) <= size) {
+        BlockHeader blockHeader;
+        std::memcpy(&blockHeader, m_map + offset, sizeof(blockHeader));
+        qint64 end = offset + qint64(sizeof(BlockHeader)) + paddedColumnBytes(blockHeader.rows);
+        if (blockHeader.magic != BLOCK_MAGIC || end > size) {
+            break;
+        }
+
+        Block block;
+        block.columns = m_map + offset + sizeof(BlockHeader);
+        block.rows = blockHeader.rows;
+        block.minFinishedUs = blockHeader.minFinishedUs;
+        block.maxFinishedUs = blockHeader.maxFinishedUs;
+        m_blocks.append(block);
+        m_rows += block.rows;
+        m_lastFinishedUs = qMax(m_lastFinishedUs, block.maxFinishedUs);
+        offset = end;
+    }
+    m_truncated = offset != size;
+    return true;
+}
+
+void ResultsReader::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_blocks.clear();
+    m_rows = 0;
+    m_lastFinishedUs = 0;
+    m_truncated = false;
+}
+
+ResultsReader::Result ResultsReader::query(const Query& query) const
+{
+    Result result;
+
+    int windowCount = 0;
+    if (query.windowUs > 0) {
+        qint64 end = qMin(query.toUs, m_lastFinishedUs + 1);
+        windowCount = int(qBound<qint64>(0, (end - query.fromUs + query.windowUs - 1) / query.windowUs, MAX_WINDOWS));
+        result.windows.resize(windowCount);
+    }
+
+    for (const Block& block : m_blocks) {
+        if (block.maxFinishedUs < query.fromUs || block.minFinishedUs >= query.toUs) {
+            continue;
+        }
+        const bool wholeBlock = block.minFinishedUs >= query.fromUs && block.maxFinishedUs < query.toUs;
+
+        // Column offsets within the block, as written by ResultsWriter::flush()
+        const qint64 rows = block.rows;
+        const qint64* finishedUs = reinterpret_cast<const qint64*>(block.columns);
+        const qint32* phaseColumns = reinterpret_cast<const qint32*>(block.columns + rows * 8);
+        const qint32* discoveryUs = phaseColumns;
+        const qint32* authorizeUs = phaseColumns + rows;
+        const qint32* tokenUs = phaseColumns + 2 * rows;
+        const qint32* totalUs = phaseColumns + 3 * rows;
+        const quint32* tokenBytes = reinterpret_cast<const quint32*>(phaseColumns + 4 * rows);
+        const quint8* errorClass = reinterpret_cast<const quint8*>(tokenBytes + rows);
+
+        const qint32* latency = totalUs;
+        switch (query.phase) {
+        case FlowResult::Discovery: latency = discoveryUs; break;
+        case FlowResult::Authorize: latency = authorizeUs; break;
+        case FlowResult::Token: latency = tokenUs; break;
+        default: break;
+        }
+
+        for (qint64 row = 0; row < rows; ++row) {
+            if (!wholeBlock && (finishedUs[row] < query.fromUs || finishedUs[row] >= query.toUs)) {
+                continue;
+            }
+
+            quint8 errorValue = errorClass[row];
+            if (errorValue != FlowResult::NoError) {
+                ++result.failures[qMin<int>(errorValue, FlowResult::ErrorClassCount - 1)];
+                continue;
+            }
+
+            qint32 value = latency[row];
+            if (value < 0) continue;
+
+            result.latency.record(value);
+            result.tokenBytes.record(tokenBytes[row]);
+            if (windowCount > 0) {
+                qint64 window = (finishedUs[row] - query.fromUs) / query.windowUs;
+                if (window < windowCount) {
+                    result.windows[int(window)].record(value);
+                }
+            }
+        }
+    }
+
+    return result;
+}
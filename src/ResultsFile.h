@@ -0,0 +1,145 @@
+#ifndef RESULTSFILE_H
+#define RESULTSFILE_H
+
+#include <QString>
+#include <QFile>
+#include <QVector>
+#include <limits>
+#include "LatencyHistogram.h"
+
+// One finished flow as stored in a results file
+struct FlowResult
+{
+    enum ErrorClass : quint8 {
+        NoError = 0,
+        DiscoveryError = 1,     // failed before discovery completed
+        AuthorizeError = 2,     // ... before the callback arrived
+        TokenError = 3,         // ... at or after the token exchange
+        SessionError = 4,       // refresh or revocation of an existing session
+        ErrorClassCount
+    };
+
+    enum Phase { Total, Discovery, Authorize, Token, PhaseCount };
+
+    qint64 finishedUs = 0;      // since the start of the run
+    qint32 discoveryUs = -1;    // -1 = phase not reached
+    qint32 authorizeUs = -1;
+    qint32 tokenUs = -1;
+    qint32 totalUs = 0;
+    quint32 tokenBytes = 0;     // id + access + refresh token
+    ErrorClass errorClass = NoError;
+
+    static QString errorClassName(ErrorClass errorClass);
+    static QString phaseName(Phase phase);
+};
+
+// Append-only, block-columnar results file. Rows are buffered and written in
+// blocks of up to BLOCK_ROWS, each laid out column by column (8-byte aligned)
+// behind a header holding its row count and finishedUs range:
+//
+//   file header   u32 magic "ORES", u16 version, u16 byte order mark,
+//                 i64 run start (ms since epoch), u32 block rows, 12 reserved
+//   block header  u32 magic "ORBK", u32 rows, i64 min finishedUs, i64 max finishedUs
+//   columns       i64 finishedUs, i32 discoveryUs, i32 authorizeUs, i32 tokenUs,
+//                 i32 totalUs, u32 tokenBytes, u8 errorClass, zero padding
+//
+// A crash loses at most the block being buffered. Not thread-safe: append
+// from one thread (LoadRunner does so from its own).
+class ResultsWriter
+{
+public:
+    ResultsWriter();
+    ~ResultsWriter();
+
+    bool open(const QString& path, QString* error);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // Wall-clock time finishedUs is relative to; recorded in the file header
+    void setRunStart(qint64 epochMs) { m_runStartEpochMs = epochMs; }
+
+    void append(const FlowResult& row);
+
+    // Writes the rows buffered so far as a (short) block
+    void flush();
+
+    qint64 rowCount() const { return m_rows; }
+
+    static const int BLOCK_ROWS = 65536;
+
+private:
+    void writeHeader();
+
+    QFile m_file;
+    bool m_headerWritten;
+    qint64 m_runStartEpochMs;
+    qint64 m_rows;
+
+    QVector<qint64> m_finishedUs;
+    QVector<qint32> m_discoveryUs;
+    QVector<qint32> m_authorizeUs;
+    QVector<qint32> m_tokenUs;
+    QVector<qint32> m_totalUs;
+    QVector<quint32> m_tokenBytes;
+    QVector<quint8> m_errorClass;
+};
+
+// Memory-mapped reader: only the block headers are read when opening, and a
+// query touches only the columns it needs, skipping blocks outside its time
+// window, so files far larger than RAM aggregate in one sequential pass.
+class ResultsReader
+{
+public:
+    struct Query
+    {
+        qint64 fromUs = 0;
+        qint64 toUs = std::numeric_limits<qint64>::max();
+        FlowResult::Phase phase = FlowResult::Total;
+        qint64 windowUs = 0;    // > 0 splits the result into windows of this length
+    };
+
+    struct Result
+    {
+        LatencyHistogram latency;                       // successful flows
+        QVector<LatencyHistogram> windows;              // when Query::windowUs > 0
+        QVector<qint64> failures = QVector<qint64>(FlowResult::ErrorClassCount, 0);
+        LatencyHistogram tokenBytes;
+    };
+
+    ResultsReader();
+    ~ResultsReader();
+
+    bool open(const QString& path, QString* error);
+    void close();
+
+    qint64 rowCount() const { return m_rows; }
+    int blockCount() const { return m_blocks.size(); }
+    qint64 runStartEpochMs() const { return m_runStartEpochMs; }
+    qint64 lastFinishedUs() const { return m_lastFinishedUs; }
+
+    // Trailing bytes that do not form a whole block (an interrupted write)
+    bool isTruncated() const { return m_truncated; }
+
+    Result query(const Query& query) const;
+
+    static const int MAX_WINDOWS = 100000;
+
+private:
+    struct Block
+    {
+        const uchar* columns = nullptr;
+        qint64 rows = 0;
+        qint64 minFinishedUs = 0;
+        qint64 maxFinishedUs = 0;
+    };
+
+    QFile m_file;
+    uchar* m_map;
+    QVector<Block> m_blocks;
+    qint64 m_rows;
+    qint64 m_runStartEpochMs;
+    qint64 m_lastFinishedUs;
+    bool m_truncated;
+};
+
+#endif // RESULTSFILE_H
@@ -0,0 +1,114 @@
+#include "RetryPolicy.h"
+#include <QMutexLocker>
+#include <QRandomGenerator>
+
+RetryPolicy::RetryPolicy()
+    : m_maxAttempts(1)
+    , m_baseDelayMs(100)
+    , m_maxDelayMs(5000)
+    , m_hedging(false)
+    , m_fixedHedgeDelayMs(0)
+    , m_requests(0)
+    , m_failures(0)
+    , m_retries(0)
+    , m_hedges(0)
+    , m_hedgesWon(0)
+{
+}
+
+void RetryPolicy::setBackoff(int baseDelayMs, int maxDelayMs)
+{
+    m_baseDelayMs = qMax(1, baseDelayMs);
+    m_maxDelayMs = qMax(m_baseDelayMs, maxDelayMs);
+}
+
+void RetryPolicy::setHedging(bool enabled, int fixedDelayMs)
+{
+    m_hedging = enabled;
+    m_fixedHedgeDelayMs = qMax(0, fixedDelayMs);
+}
+
+int RetryPolicy::backoffMs(int retry) const
+{
+    // Full jitter keeps retrying clients from synchronising into waves
+    qint64 ceiling = qint64(m_baseDelayMs) << qBound(0, retry - 1, 20);
+    ceiling = qMin<qint64>(ceiling, m_maxDelayMs);
+    return int(QRandomGenerator::global()->bounded(ceiling + 1));
+}
+
+qint64 RetryPolicy::hedgeDelayUs() const
+{
+    if (m_fixedHedgeDelayMs > 0) {
+        return qint64(m_fixedHedgeDelayMs) * 1000;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_attemptLatency.count() < MIN_HEDGE_SAMPLES) {
+        return -1;
+    }
+    return m_attemptLatency.percentile(95);
+}
+
+bool RetryPolicy::isRetryable(QNetworkReply::NetworkError error, int statusCode)
+{
+    if (statusCode == 429 || statusCode >= 500) {
+        return true;
+    }
+    if (statusCode >= 400) {
+        return false;
+    }
+    return error != QNetworkReply::NoError && error != QNetworkReply::OperationCanceledError;
+}
+
+void RetryPolicy::recordAttempt(qint64 latencyUs, bool success)
+{
+    // Only successful attempts describe the latency a hedge should beat
+    if (!success) return;
+
+    QMutexLocker locker(&m_mutex);
+    m_attemptLatency.record(latencyUs);
+}
+
+void RetryPolicy::recordCancelledAttempt(qint64 elapsedUs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_attemptLatency.record(elapsedUs);
+}
+
+void RetryPolicy::recordRequest(qint64 latencyUs, bool success, bool wonByHedge)
+{
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+    if (!success) {
+        m_failures.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (wonByHedge) {
+        m_hedgesWon.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_requestLatency.record(latencyUs);
+}
+
+QString RetryPolicy::summary() const
+{
+    const quint64 requests = m_requests.load(std::memory_order_relaxed);
+    const quint64 hedges = m_hedges.load(std::memory_order_relaxed);
+    const quint64 hedgesWon = m_hedgesWon.load(std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_mutex);
+    return QString("Refresh requests: %1, failed %2, retries %3; hedges fired %4 (%5% of requests), won %6 (%7% of hedges); "
+                   "request latency p50 %8 ms, p95 %9 ms, p99 %10 ms, max %11 ms (single attempt p95 %12 ms)")
+        .arg(requests)
+        .arg(m_failures.load(std::memory_order_relaxed))
+        .arg(m_retries.load(std::memory_order_relaxed))
+        .arg(hedges)
+        .arg(requests > 0 ? 100.0 * hedges / requests : 0.0, 0, 'f', 1)
+        .arg(hedgesWon)
+        .arg(hedges > 0 ? 100.0 * hedgesWon / hedges : 0.0, 0, 'f', 1)
+        .arg(m_requestLatency.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_requestLatency.percentile(95) / 1000.0, 0, 'f', 1)
+        .arg(m_requestLatency.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(m_requestLatency.max() / 1000.0, 0, 'f', 1)
+        .arg(m_attemptLatency.percentile(95) / 1000.0, 0, 'f', 1);
+}
@@ -0,0 +1,79 @@
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include "LatencyHistogram.h"
+#include <QString>
+#include <QMutex>
+#include <QNetworkReply>
+#include <atomic>
+
+// Retries and hedging for token requests that are safe to repeat (refresh),
+// shared by every OIDCManager of a run and safe to use from any thread.
+//
+// Failed attempts are retried after an exponential backoff with full jitter
+// (a uniform delay up to base * 2^(retry-1), capped). With hedging, a second
+// attempt is sent when the first has not answered after the hedge delay
+// (fixed, or the p95 of attempts seen so far, with cancelled attempts counted
+// at their elapsed time) and the first success wins.
+class RetryPolicy
+{
+public:
+    RetryPolicy();
+
+    void setMaxAttempts(int attempts) { m_maxAttempts = qMax(1, attempts); }
+    void setBackoff(int baseDelayMs, int maxDelayMs);
+    void setHedging(bool enabled, int fixedDelayMs = 0);
+
+    int maxAttempts() const { return m_maxAttempts; }
+    bool hedging() const { return m_hedging; }
+
+    // Delay before the given retry (1 = first retry)
+    int backoffMs(int retry) const;
+
+    // When to send the hedge for a request; -1 until enough attempts have
+    // completed to estimate the p95
+    qint64 hedgeDelayUs() const;
+
+    // Transport errors, 429 and 5xx; other 4xx (invalid_grant) are final
+    static bool isRetryable(QNetworkReply::NetworkError error, int statusCode);
+
+    // One HTTP attempt, whether or not it ended the request
+    void recordAttempt(qint64 latencyUs, bool success);
+
+    // An attempt cancelled because another one won; its latency is at least
+    // elapsedUs. Leaving these out would keep the slowest attempts out of the
+    // p95 and let the hedge delay drift down.
+    void recordCancelledAttempt(qint64 elapsedUs);
+    void countRetry() { m_retries.fetch_add(1, std::memory_order_relaxed); }
+    void countHedge() { m_hedges.fetch_add(1, std::memory_order_relaxed); }
+
+    // One request as the caller sees it, from the first attempt to the outcome
+    void recordRequest(qint64 latencyUs, bool success, bool wonByHedge);
+
+    quint64 requests() const { return m_requests.load(std::memory_order_relaxed); }
+    quint64 hedgesFired() const { return m_hedges.load(std::memory_order_relaxed); }
+    quint64 hedgesWon() const { return m_hedgesWon.load(std::memory_order_relaxed); }
+
+    QString summary() const;
+
+private:
+    static const int MIN_HEDGE_SAMPLES = 20;
+
+    int m_maxAttempts;
+    int m_baseDelayMs;
+    int m_maxDelayMs;
+    bool m_hedging;
+    int m_fixedHedgeDelayMs;
+
+    std::atomic<quint64> m_requests;
+    std::atomic<quint64> m_failures;
+    std::atomic<quint64> m_retries;
+    std::atomic<quint64> m_hedges;
+    std::atomic<quint64> m_hedgesWon;
+
+    mutable QMutex m_mutex;
+    LatencyHistogram m_attemptLatency;
+    LatencyHistogram m_requestLatency;
+};
+
+#endif // RETRYPOLICY_H
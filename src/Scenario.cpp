@@ -0,0 +1,178 @@
+#include "Scenario.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <algorithm>
+
+namespace {
+
+// thinkTimeMs is either a fixed number or a [min, max] range
+bool parseThinkTime(const QJsonValue& value, int* minMs, int* maxMs)
+{
+    if (value.isUndefined()) return true;
+
+    if (value.isDouble()) {
+        *minMs = *maxMs = value.toInt(-1);
+    } else if (value.isArray() && value.toArray().size() == 2) {
+        *minMs = value.toArray().at(0).toInt(-1);
+        *maxMs = value.toArray().at(1).toInt(-1);
+    } else {
+        return false;
+    }
+    return *minMs >= 0 && *maxMs >= *minMs;
+}
+
+}
+
+Scenario::Scenario()
+    : m_concurrency(0)
+{
+}
+
+QString Scenario::actionName(Action action)
+{
+    switch (action) {
+    case Login: return "login";
+    case StepUp: return "stepup";
+    case Refresh: return "refresh";
+    case Revoke: return "revoke";
+    }
+    return QString();
+}
+
+bool Scenario::loadFile(const QString& path, const OIDCConfig& base, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!doc.isObject()) {
+        if (error) *error = QString("%1: %2").arg(path, parseError.errorString());
+        return false;
+    }
+
+    return compile(doc.object(), base, error);
+}
+
+bool Scenario::compile(const QJsonObject& json, const OIDCConfig& base, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    QString name = json["name"].toString("scenario");
+    int concurrency = json["concurrency"].toInt(0);
+    if (concurrency < 0) {
+        return fail("concurrency must be positive");
+    }
+
+    const QJsonArray flows = json["flows"].toArray();
+    if (flows.isEmpty()) {
+        return fail("Scenario has no flows");
+    }
+
+    QVector<Step> steps;
+    QVector<int> entries;
+    QVector<quint32> cumulativeWeights;
+    QStringList flowNames;
+    quint32 totalWeight = 0;
+
+    for (int f = 0; f < flows.size(); ++f) {
+        const QJsonObject flow = flows[f].toObject();
+        QString flowName = flow["name"].toString(QString("flow%1").arg(f + 1));
+
+        int weight = flow["weight"].toInt(1);
+        if (weight <= 0) {
+            return fail(QString("%1: weight must be positive").arg(flowName));
+        }
+
+        const QJsonArray flowSteps = flow["steps"].toArray();
+        if (flowSteps.isEmpty()) {
+            return fail(QString("%1: no steps").arg(flowName));
+        }
+
+        int flowThinkMin = 0;
+        int flowThinkMax = 0;
+        if (!parseThinkTime(flow["thinkTimeMs"], &flowThinkMin, &flowThinkMax)) {
+            return fail(QString("%1: thinkTimeMs must be a number or a [min, max] pair").arg(flowName));
+        }
+
+        entries.append(steps.size());
+        bool loggedIn = false;
+
+        for (int s = 0; s < flowSteps.size(); ++s) {
+            const QJsonObject stepJson = flowSteps[s].toObject();
+            QString actionText = stepJson["action"].toString();
+
+            Step step;
+            if (actionText == "login") {
+                step.action = Login;
+            } else if (actionText == "stepup") {
+                step.action = StepUp;
+            } else if (actionText == "refresh") {
+                step.action = Refresh;
+            } else if (actionText == "revoke") {
+                step.action = Revoke;
+            } else {
+                return fail(QString("%1 step %2: unknown action \"%3\"").arg(flowName).arg(s + 1).arg(actionText));
+            }
+
+            // Session steps need a session
+            if (step.action != Login && !loggedIn) {
+                return fail(QString("%1 step %2: %3 needs an earlier login").arg(flowName).arg(s + 1).arg(actionText));
+            }
+            loggedIn = step.action != Revoke && (loggedIn || step.action == Login);
+
+            step.label = QString("%1/%2 %3").arg(flowName).arg(s + 1).arg(actionText);
+
+            step.config = base;
+            if (stepJson.contains("acr")) step.config.acrValue = stepJson["acr"].toString();
+            if (stepJson.contains("scopes")) step.config.scopes = stepJson["scopes"].toString();
+            if (stepJson.contains("loginHint")) step.config.loginHint = stepJson["loginHint"].toString();
+            if (stepJson.contains("extraParams")) step.config.extraParams = stepJson["extraParams"].toString();
+            if (stepJson.contains("prompt")) step.config.promptLogin = stepJson["prompt"].toString() == "login";
+
+            step.tokenTypeHint = stepJson["token"].toString("refresh_token");
+            if (step.tokenTypeHint != "refresh_token" && step.tokenTypeHint != "access_token") {
+                return fail(QString("%1 step %2: token must be refresh_token or access_token").arg(flowName).arg(s + 1));
+            }
+
+            step.thinkMinMs = flowThinkMin;
+            step.thinkMaxMs = flowThinkMax;
+            if (!parseThinkTime(stepJson["thinkTimeMs"], &step.thinkMinMs, &step.thinkMaxMs)) {
+                return fail(QString("%1 step %2: thinkTimeMs must be a number or a [min, max] pair").arg(flowName).arg(s + 1));
+            }
+
+            step.next = s + 1 < flowSteps.size() ? steps.size() + 1 : -1;
+            steps.append(step);
+        }
+
+        totalWeight += quint32(weight);
+        cumulativeWeights.append(totalWeight);
+        flowNames.append(flowName);
+    }
+
+    m_name = name;
+    m_concurrency = concurrency;
+    m_steps = steps;
+    m_entries = entries;
+    m_cumulativeWeights = cumulativeWeights;
+    m_flowNames = flowNames;
+    return true;
+}
+
+int Scenario::pickEntry() const
+{
+    if (m_entries.isEmpty()) return -1;
+
+    quint32 roll = QRandomGenerator::global()->bounded(m_cumulativeWeights.last());
+    int flow = int(std::upper_bound(m_cumulativeWeights.begin(), m_cumulativeWeights.end(), roll)
+                   - m_cumulativeWeights.begin());
+    return m_entries[flow];
+}
@@ -0,0 +1,71 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "OIDCManager.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+
+// A weighted mix of multi-step session flows read from a JSON file, e.g.
+//
+//   { "name": "epcs-mix", "concurrency": 20,
+//     "flows": [
+//       { "name": "prescribe", "weight": 3, "steps": [
+//           { "action": "login", "acr": "urn:example:aal2" },
+//           { "action": "stepup", "acr": "urn:example:epcs", "prompt": "login", "thinkTimeMs": [500, 2000] },
+//           { "action": "refresh", "thinkTimeMs": 30000 },
+//           { "action": "revoke", "token": "refresh_token" } ] },
+//       { "name": "browse", "weight": 7, "steps": [ { "action": "login" } ] } ] }
+//
+// The file is compiled once into a flat step table: every step carries its
+// fully resolved OIDCConfig, its think time (waited before the step runs)
+// and the index of the step that follows it, so a virtual user only has to
+// hold its current step index.
+class Scenario
+{
+public:
+    enum Action { Login, StepUp, Refresh, Revoke };
+
+    struct Step
+    {
+        Action action = Login;
+        QString label;              // "flow/index action", for reports
+        OIDCConfig config;          // login and step-up
+        QString tokenTypeHint;      // revoke
+        int thinkMinMs = 0;
+        int thinkMaxMs = 0;
+        int next = -1;              // -1 ends the iteration
+    };
+
+    Scenario();
+
+    // base supplies every setting a step does not override
+    bool loadFile(const QString& path, const OIDCConfig& base, QString* error);
+    bool compile(const QJsonObject& json, const OIDCConfig& base, QString* error);
+
+    bool isEmpty() const { return m_steps.isEmpty(); }
+    QString name() const { return m_name; }
+    int concurrency() const { return m_concurrency; }   // 0 = not set
+
+    int stepCount() const { return m_steps.size(); }
+    const Step& step(int index) const { return m_steps[index]; }
+
+    int flowCount() const { return m_entries.size(); }
+    QString flowName(int flow) const { return m_flowNames.value(flow); }
+
+    // Entry step of a flow chosen by weight
+    int pickEntry() const;
+
+    static QString actionName(Action action);
+
+private:
+    QString m_name;
+    int m_concurrency;
+    QVector<Step> m_steps;
+    QVector<int> m_entries;
+    QVector<quint32> m_cumulativeWeights;
+    QStringList m_flowNames;
+};
+
+#endif // SCENARIO_H
@@ -0,0 +1,254 @@
+#include "ScriptedAuthorizer.h"
+#include <QNetworkAccessManager>
+#include <QNetworkCookieJar>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QRegularExpression>
+#include <QUrlQuery>
+#include <QMap>
+
+static QString decodeEntities(QString text)
+{
+    text.replace("&quot;", "\"");
+    text.replace("&#39;", "'");
+    text.replace("&#x27;", "'");
+    text.replace("&lt;", "<");
+    text.replace("&gt;", ">");
+    text.replace("&amp;", "&");
+    return text;
+}
+
+static QMap<QString, QString> parseAttributes(const QString& tag)
+{
+    static const QRegularExpression attrRe(
+        "([a-zA-Z_:][-a-zA-Z0-9_:.]*)\\s*=\\s*(?:\"([^\"]*)\"|'([^']*)'|([^\\s\"'>]+))");
+
+    QMap<QString, QString> attributes;
+    QRegularExpressionMatchIterator it = attrRe.globalMatch(tag);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        QString value = match.captured(2);
+        if (value.isEmpty()) value = match.captured(3);
+        if (value.isEmpty()) value = match.captured(4);
+        attributes.insert(match.captured(1).toLower(), decodeEntities(value));
+    }
+    return attributes;
+}
+
+ScriptedAuthorizer::ScriptedAuthorizer(QObject *parent)
+    : Authorizer(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_reply(nullptr)
+    , m_steps(0)
+    , m_maxSteps(10)
+{
+}
+
+ScriptedAuthorizer::~ScriptedAuthorizer()
+{
+    cancel();
+}
+
+void ScriptedAuthorizer::setFormFields(const QString& formFields)
+{
+    m_formFields = QUrlQuery(formFields).queryItems(QUrl::FullyDecoded);
+}
+
+bool ScriptedAuthorizer::authorize(const QUrl& authURL, const QString& redirectURI)
+{
+    cancel();
+
+    m_redirectURI = QUrl(redirectURI).adjusted(QUrl::RemoveQuery | QUrl::RemoveFragment);
+    m_steps = 0;
+
+    // Fresh cookie jar per flow, the scripted equivalent of an incognito window
+    m_networkManager->setCookieJar(new QNetworkCookieJar());
+
+    emit logMessage("Performing scripted authorization (no browser)");
+    get(authURL);
+    return true;
+}
+
+void ScriptedAuthorizer::cancel()
+{
+    if (m_reply) {
+        QNetworkReply* reply = m_reply;
+        m_reply = nullptr;
+        reply->abort();
+    }
+}
+
+void ScriptedAuthorizer::get(const QUrl& url)
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 (X11; Linux x86_64) oidc-tester");
+
+    m_reply = m_networkManager->get(request);
+    connect(m_reply, &QNetworkReply::finished, this, &ScriptedAuthorizer::onReplyFinished);
+}
+
+void ScriptedAuthorizer::submitForm(const HtmlForm& form)
+{
+    QUrlQuery fields;
+    fields.setQueryItems(form.fields);
+    for (const auto& field : m_formFields) {
+        fields.removeAllQueryItems(field.first);
+        fields.addQueryItem(field.first, field.second);
+    }
+
+    emit logMessage(QString("Submitting login form to %1").arg(form.action.toString()));
+
+    if (form.method == "get") {
+        QUrl url = form.action;
+        url.setQuery(fields);
+        get(url);
+        return;
+    }
+
+    QNetworkRequest request(form.action);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 (X11; Linux x86_64) oidc-tester");
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    m_reply = m_networkManager->post(request, fields.toString(QUrl::FullyEncoded).toUtf8());
+    connect(m_reply, &QNetworkReply::finished, this, &ScriptedAuthorizer::onReplyFinished);
+}
+
+bool ScriptedAuthorizer::isCallback(const QUrl& url) const
+{
+    return url.adjusted(QUrl::RemoveQuery | QUrl::RemoveFragment) == m_redirectURI;
+}
+
+void ScriptedAuthorizer::fail(const QString& error)
+{
+    emit errorOccurred(error);
+    emit logMessage(error);
+}
+
+void ScriptedAuthorizer::onReplyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+
+    reply->deleteLater();
+
+    // Aborted or superseded by a newer flow
+    if (reply != m_reply) return;
+    m_reply = nullptr;
+
+    if (++m_steps > m_maxSteps) {
+        fail(QString("Scripted authorization gave up after %1 steps without reaching the callback").arg(m_maxSteps));
+        return;
+    }
+
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (statusCode >= 300 && statusCode < 400) {
+        QUrl location = reply->url().resolved(reply->header(QNetworkRequest::LocationHeader).toUrl());
+        if (location.isEmpty()) {
+            fail(QString("Redirect from %1 has no Location header").arg(reply->url().toString()));
+            return;
+        }
+
+        if (isCallback(location)) {
+            // Fragment-encoded responses are handed over as a query for uniform processing
+            if (location.hasFragment() && !location.hasQuery()) {
+                location.setQuery(location.fragment());
+                location.setFragment(QString());
+            }
+            emit logMessage(QString("Scripted authorization reached the callback after %1 steps").arg(m_steps));
+            emit callbackCaptured(location);
+            return;
+        }
+
+        get(location);
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError) {
+        fail(QString("Authorization request failed (HTTP %1): %2").arg(statusCode).arg(reply->errorString()));
+        return;
+    }
+
+    QString html = QString::fromUtf8(reply->readAll());
+    QList<HtmlForm> forms = parseForms(html, reply->url());
+
+    // response_mode=form_post: the IdP answers with an auto-submitting form aimed at the callback
+    for (const HtmlForm& form : forms) {
+        if (isCallback(form.action)) {
+            QUrl callback = form.action;
+            QUrlQuery query(callback);
+            for (const auto& field : form.fields) {
+                query.addQueryItem(field.first, field.second);
+            }
+            callback.setQuery(query);
+            emit logMessage(QString("Scripted authorization reached the callback after %1 steps").arg(m_steps));
+            emit callbackCaptured(callback);
+            return;
+        }
+    }
+
+    if (forms.isEmpty()) {
+        fail(QString("Authorization page %1 has neither a redirect nor a form to submit").arg(reply->url().toString()));
+        return;
+    }
+
+    // Prefer the form that actually asks for one of the configured fields (the login form)
+    const HtmlForm* target = &forms.first();
+    for (const HtmlForm& form : forms) {
+        bool matches = false;
+        for (const auto& field : form.fields) {
+            for (const auto& configured : m_formFields) {
+                if (field.first == configured.first) {
+                    matches = true;
+                }
+            }
+        }
+        if (matches) {
+            target = &form;
+            break;
+        }
+    }
+
+    submitForm(*target);
+}
+
+QList<ScriptedAuthorizer::HtmlForm> ScriptedAuthorizer::parseForms(const QString& html, const QUrl& baseURL)
+{
+    static const QRegularExpression formRe("<form\\b([^>]*)>(.*?)</form>",
+                                           QRegularExpression::CaseInsensitiveOption |
+                                           QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression inputRe("<input\\b([^>]*)>", QRegularExpression::CaseInsensitiveOption);
+
+    QList<HtmlForm> forms;
+    QRegularExpressionMatchIterator formIt = formRe.globalMatch(html);
+    while (formIt.hasNext()) {
+        QRegularExpressionMatch formMatch = formIt.next();
+        QMap<QString, QString> formAttributes = parseAttributes(formMatch.captured(1));
+
+        HtmlForm form;
+        form.action = baseURL.resolved(QUrl(formAttributes.value("action")));
+        form.method = formAttributes.value("method", "get").toLower();
+
+        QRegularExpressionMatchIterator inputIt = inputRe.globalMatch(formMatch.captured(2));
+        while (inputIt.hasNext()) {
+            QString tag = inputIt.next().captured(1);
+            QMap<QString, QString> input = parseAttributes(tag);
+            QString name = input.value("name");
+            QString type = input.value("type", "text").toLower();
+
+            if (name.isEmpty() || type == "submit" || type == "button" || type == "image" || type == "reset") {
+                continue;
+            }
+            if ((type == "checkbox" || type == "radio") && !tag.contains("checked", Qt::CaseInsensitive)) {
+                continue;
+            }
+            form.fields.append(qMakePair(name, input.value("value")));
+        }
+
+        forms.append(form);
+    }
+
+    return forms;
+}
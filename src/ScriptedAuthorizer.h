@@ -0,0 +1,55 @@
+#ifndef SCRIPTEDAUTHORIZER_H
+#define SCRIPTEDAUTHORIZER_H
+
+#include "Authorizer.h"
+#include <QList>
+#include <QPair>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Browserless authorizer: issues the authorize request itself, follows
+// redirects, submits login forms with the configured fields and captures the
+// redirect to the callback URI. With no form fields configured it only follows
+// redirects, which is enough for IdPs that auto-approve (e.g. mock IdPs).
+class ScriptedAuthorizer : public Authorizer
+{
+    Q_OBJECT
+
+public:
+    explicit ScriptedAuthorizer(QObject *parent = nullptr);
+    ~ScriptedAuthorizer() override;
+
+    // Fields in "key1=value1&key2=value2" form, overriding the page's own inputs
+    void setFormFields(const QString& formFields);
+    void setMaxSteps(int maxSteps) { m_maxSteps = maxSteps; }
+
+    bool authorize(const QUrl& authURL, const QString& redirectURI) override;
+    void cancel() override;
+    bool capturesCallback() const override { return true; }
+
+private slots:
+    void onReplyFinished();
+
+private:
+    struct HtmlForm {
+        QUrl action;
+        QString method;
+        QList<QPair<QString, QString>> fields;
+    };
+
+    void get(const QUrl& url);
+    void submitForm(const HtmlForm& form);
+    bool isCallback(const QUrl& url) const;
+    void fail(const QString& error);
+    static QList<HtmlForm> parseForms(const QString& html, const QUrl& baseURL);
+
+    QNetworkAccessManager* m_networkManager;
+    QNetworkReply* m_reply;
+    QList<QPair<QString, QString>> m_formFields;
+    QUrl m_redirectURI;
+    int m_steps;
+    int m_maxSteps;
+};
+
+#endif // SCRIPTEDAUTHORIZER_H
@@ -0,0 +1,225 @@
+#include "SoakMonitor.h"
+#include "LoadRunner.h"
+#include <QDateTime>
+#include <QDir>
+#include <atomic>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// Qt's exported hook table (qhooks_p.h), the same mechanism debugging tools
+// such as GammaRay use to observe QObject lifetimes
+extern quintptr Q_CORE_EXPORT qtHookData[];
+
+static const int HOOK_DATA_VERSION = 0;
+static const int HOOK_ADD_QOBJECT = 3;
+static const int HOOK_REMOVE_QOBJECT = 4;
+
+static const int PROBE_INTERVAL_MS = 50;
+
+typedef void (*ObjectHook)(QObject*);
+
+static std::atomic<qint64> s_objectDelta(0);
+static std::atomic<bool> s_counterInstalled(false);
+static ObjectHook s_previousAddHook = nullptr;
+static ObjectHook s_previousRemoveHook = nullptr;
+
+static void onObjectAdded(QObject* object)
+{
+    s_objectDelta.fetch_add(1, std::memory_order_relaxed);
+    if (s_previousAddHook) s_previousAddHook(object);
+}
+
+static void onObjectRemoved(QObject* object)
+{
+    s_objectDelta.fetch_sub(1, std::memory_order_relaxed);
+    if (s_previousRemoveHook) s_previousRemoveHook(object);
+}
+
+SoakMonitor::SoakMonitor(LoadRunner* runner, QObject *parent)
+    : QObject(parent)
+    , m_runner(runner)
+    , m_lastProbeMs(0)
+    , m_lagSumMs(0.0)
+    , m_lagMaxMs(0.0)
+    , m_lagCount(0)
+    , m_lastCompleted(0)
+    , m_lastFailed(0)
+    , m_lastSampleMs(0)
+    , m_samples(0)
+{
+    m_probeTimer.setTimerType(Qt::PreciseTimer);
+    m_probeTimer.setInterval(PROBE_INTERVAL_MS);
+    connect(&m_probeTimer, &QTimer::timeout, this, &SoakMonitor::onProbe);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &SoakMonitor::onSample);
+}
+
+SoakMonitor::~SoakMonitor()
+{
+    stop();
+}
+
+void SoakMonitor::installObjectCounter()
+{
+    if (s_counterInstalled.exchange(true)) return;
+
+    // Hook layout version 1 is what qhooks_p.h has shipped since Qt 5.4
+    if (qtHookData[HOOK_DATA_VERSION] < 1) {
+        s_counterInstalled = false;
+        return;
+    }
+
+    s_previousAddHook = reinterpret_cast<ObjectHook>(qtHookData[HOOK_ADD_QOBJECT]);
+    s_previousRemoveHook = reinterpret_cast<ObjectHook>(qtHookData[HOOK_REMOVE_QOBJECT]);
+    qtHookData[HOOK_ADD_QOBJECT] = reinterpret_cast<quintptr>(&onObjectAdded);
+    qtHookData[HOOK_REMOVE_QOBJECT] = reinterpret_cast<quintptr>(&onObjectRemoved);
+}
+
+bool SoakMonitor::start(const QString& csvPath, int intervalMs, QString* error)
+{
+    m_file.setFileName(csvPath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        *error = QString("Failed to open soak output %1: %2").arg(csvPath, m_file.errorString());
+        return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream << "timestamp,elapsed_s,flows_completed,flows_failed,flows_per_s,"
+                "rss_kb,open_fds,qobjects_delta,loop_lag_avg_ms,loop_lag_max_ms\n";
+    m_stream.flush();
+
+    m_samples = 0;
+    m_lastCompleted = 0;
+    m_lastFailed = 0;
+    m_lastSampleMs = 0;
+    m_clock.start();
+    m_lastProbeMs = 0;
+
+    m_probeTimer.start();
+    m_sampleTimer.start(qMax(100, intervalMs));
+
+    // Baseline sample before any flow has run
+    onSample();
+    return true;
+}
+
+void SoakMonitor::stop()
+{
+    if (!m_file.isOpen()) return;
+
+    m_probeTimer.stop();
+    m_sampleTimer.stop();
+    onSample();
+
+    m_stream.flush();
+    m_file.close();
+}
+
+void SoakMonitor::onProbe()
+{
+    qint64 now = m_clock.elapsed();
+    double lagMs = qMax(0.0, double(now - m_lastProbeMs - PROBE_INTERVAL_MS));
+    m_lastProbeMs = now;
+
+    m_lagSumMs += lagMs;
+    m_lagMaxMs = qMax(m_lagMaxMs, lagMs);
+    ++m_lagCount;
+}
+
+void SoakMonitor::onSample()
+{
+    Sample sample;
+    sample.elapsedMs = m_clock.elapsed();
+    sample.flowsCompleted = m_runner ? m_runner->completedFlows() : 0;
+    sample.flowsFailed = m_runner ? m_runner->failedFlows() : 0;
+    sample.rssKB = currentRssKB();
+    sample.openFDs = currentOpenFDs();
+    sample.qobjectDelta = qobjectDelta();
+    sample.loopLagAvgMs = m_lagCount > 0 ? m_lagSumMs / m_lagCount : 0.0;
+    sample.loopLagMaxMs = m_lagMaxMs;
+
+    double intervalSeconds = (sample.elapsedMs - m_lastSampleMs) / 1000.0;
+    int flowsInInterval = (sample.flowsCompleted + sample.flowsFailed) - (m_lastCompleted + m_lastFailed);
+    double flowsPerSecond = intervalSeconds > 0 ? flowsInInterval / intervalSeconds : 0.0;
+
+    m_stream << QDateTime::currentDateTimeUtc().toString(Qt::ISODate) << ','
+             << QString::number(sample.elapsedMs / 1000.0, 'f', 1) << ','
+             << sample.flowsCompleted << ','
+             << sample.flowsFailed << ','
+             << QString::number(flowsPerSecond, 'f', 2) << ','
+             << sample.rssKB << ','
+             << sample.openFDs << ','
+             << (objectCounterInstalled() ? QString::number(sample.qobjectDelta) : QString()) << ','
+             << QString::number(sample.loopLagAvgMs, 'f', 2) << ','
+             << QString::number(sample.loopLagMaxMs, 'f', 1) << '\n';
+    m_stream.flush();
+
+    if (m_samples == 0) {
+        m_first = sample;
+    }
+    m_last = sample;
+    ++m_samples;
+
+    m_lastCompleted = sample.flowsCompleted;
+    m_lastFailed = sample.flowsFailed;
+    m_lastSampleMs = sample.elapsedMs;
+    m_lagSumMs = 0.0;
+    m_lagMaxMs = 0.0;
+    m_lagCount = 0;
+}
+
+QString SoakMonitor::summary() const
+{
+    if (m_samples == 0) {
+        return "Soak: no samples";
+    }
+
+    QString result = QString("Soak: %1 samples over %2 h; RSS %3 -> %4 KB, open FDs %5 -> %6")
+        .arg(m_samples)
+        .arg(m_last.elapsedMs / 3600000.0, 0, 'f', 2)
+        .arg(m_first.rssKB).arg(m_last.rssKB)
+        .arg(m_first.openFDs).arg(m_last.openFDs);
+    if (objectCounterInstalled()) {
+        result += QString(", QObjects %1 over the run").arg(m_last.qobjectDelta - m_first.qobjectDelta, 0, 10);
+    }
+    return result;
+}
+
+qint64 SoakMonitor::currentRssKB()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) return -1;
+
+    // Fields: size resident shared text lib data dt (in pages)
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+#else
+    return -1;
+#endif
+}
+
+int SoakMonitor::currentOpenFDs()
+{
+#ifdef Q_OS_LINUX
+    QDir fdDir("/proc/self/fd");
+    if (!fdDir.exists()) return -1;
+
+    // Listing the directory holds one descriptor of its own
+    return int(fdDir.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size()) - 1;
+#else
+    return -1;
+#endif
+}
+
+bool SoakMonitor::objectCounterInstalled()
+{
+    return s_counterInstalled;
+}
+
+qint64 SoakMonitor::qobjectDelta()
+{
+    return s_objectDelta.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,76 @@
+#ifndef SOAKMONITOR_H
+#define SOAKMONITOR_H
+
+#include <QObject>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class LoadRunner;
+
+// Samples process health during long runs (RSS, open file descriptors, net
+// QObject growth, event-loop lag and flow throughput) into a CSV time series
+// so leaks and slow degradation show up as trends.
+class SoakMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Sample {
+        qint64 elapsedMs = 0;
+        int flowsCompleted = 0;
+        int flowsFailed = 0;
+        qint64 rssKB = -1;
+        int openFDs = -1;
+        qint64 qobjectDelta = 0;     // only meaningful with objectCounterInstalled()
+        double loopLagAvgMs = 0.0;
+        double loopLagMaxMs = 0.0;
+    };
+
+    explicit SoakMonitor(LoadRunner* runner, QObject *parent = nullptr);
+    ~SoakMonitor();
+
+    // Hooks QObject construction/destruction; call before the QCoreApplication
+    // exists so almost no objects predate the hook
+    static void installObjectCounter();
+    static bool objectCounterInstalled();
+
+    bool start(const QString& csvPath, int intervalMs, QString* error);
+    void stop();
+
+    // First vs. last sample, for the end-of-run report
+    QString summary() const;
+
+    static qint64 currentRssKB();
+    static int currentOpenFDs();
+    // QObjects created minus QObjects destroyed since installObjectCounter().
+    // Qt offers no way to enumerate existing objects, so this is the change in
+    // the live count, not the count itself; it goes negative when objects that
+    // predate the hook are destroyed.
+    static qint64 qobjectDelta();
+
+private slots:
+    void onProbe();
+    void onSample();
+
+private:
+    LoadRunner* m_runner;
+    QFile m_file;
+    QTextStream m_stream;
+    QTimer m_sampleTimer;
+    QTimer m_probeTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastProbeMs;
+    double m_lagSumMs;
+    double m_lagMaxMs;
+    int m_lagCount;
+    int m_lastCompleted;
+    int m_lastFailed;
+    qint64 m_lastSampleMs;
+    Sample m_first;
+    Sample m_last;
+    int m_samples;
+};
+
+#endif // SOAKMONITOR_H
@@ -0,0 +1,140 @@
+#include "StallWatchdog.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+
+std::atomic<const char*> StallWatchdog::s_phase(nullptr);
+
+StallWatchdog::PhaseScope::PhaseScope(const char* phase)
+    : m_previous(s_phase.exchange(phase, std::memory_order_relaxed))
+{
+}
+
+StallWatchdog::PhaseScope::~PhaseScope()
+{
+    s_phase.store(m_previous, std::memory_order_relaxed);
+}
+
+StallWatchdog::StallWatchdog(int thresholdMs, QObject *parent)
+    : QObject(parent)
+    , m_thresholdMs(qMax(1, thresholdMs))
+    , m_heartbeat(new QTimer(this))
+    , m_monitor(nullptr)
+    , m_lastBeatNs(0)
+    , m_running(false)
+    , m_capturedBeatNs(-1)
+    , m_capturedPhase(nullptr)
+{
+    m_heartbeat->setTimerType(Qt::PreciseTimer);
+    m_heartbeat->setInterval(HEARTBEAT_MS);
+    connect(m_heartbeat, &QTimer::timeout, this, &StallWatchdog::onHeartbeat);
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::start()
+{
+    if (m_running) return;
+
+    m_clock.start();
+    m_lastBeatNs = m_clock.nsecsElapsed();
+    m_running = true;
+    m_heartbeat->start();
+
+    m_monitor = QThread::create([this]() { monitorLoop(); });
+    m_monitor->start(QThread::HighPriority);
+}
+
+void StallWatchdog::stop()
+{
+    if (!m_running) return;
+
+    m_running = false;
+    m_heartbeat->stop();
+    m_monitor->wait();
+    delete m_monitor;
+    m_monitor = nullptr;
+}
+
+void StallWatchdog::monitorLoop()
+{
+    // Monitor thread: samples twice per heartbeat, so a stall is seen within
+    // ~10 ms of crossing the threshold
+    const qint64 thresholdNs = qint64(m_thresholdMs) * 1000000;
+
+    while (m_running.load(std::memory_order_relaxed)) {
+        QThread::msleep(HEARTBEAT_MS / 2);
+
+        qint64 lastBeat = m_lastBeatNs.load(std::memory_order_acquire);
+        if (m_clock.nsecsElapsed() - lastBeat < qint64(HEARTBEAT_MS) * 1000000 + thresholdNs) continue;
+
+        QMutexLocker locker(&m_captureMutex);
+        if (m_capturedBeatNs != lastBeat) {
+            m_capturedBeatNs = lastBeat;
+            m_capturedPhase = s_phase.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void StallWatchdog::onHeartbeat()
+{
+    qint64 now = m_clock.nsecsElapsed();
+    qint64 previous = m_lastBeatNs.exchange(now, std::memory_order_release);
+    qint64 lateUs = qMax<qint64>(0, (now - previous) / 1000 - HEARTBEAT_MS * 1000);
+
+    m_latency.record(lateUs);
+    if (lateUs < qint64(m_thresholdMs) * 1000) return;
+
+    const char* phase = nullptr;
+    {
+        QMutexLocker locker(&m_captureMutex);
+        if (m_capturedBeatNs == previous) {
+            phase = m_capturedPhase;
+        }
+    }
+
+    // Shorter stalls can end between two monitor samples
+    QString phaseName = phase ? QString::fromLatin1(phase) : QString("unattributed");
+
+    m_stalls.record(lateUs);
+    ++m_stallsByPhase[phaseName];
+    qint64& worst = m_worstByPhase[phaseName];
+    worst = qMax(worst, lateUs);
+
+    emit stallDetected(lateUs, phaseName);
+}
+
+QString StallWatchdog::summary() const
+{
+    QString result = QString("Event loop latency p50 %1 ms, p99 %2 ms, max %3 ms; %4 stall(s) over %5 ms")
+        .arg(m_latency.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_latency.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(m_latency.max() / 1000.0, 0, 'f', 1)
+        .arg(m_stalls.count())
+        .arg(m_thresholdMs);
+
+    if (m_stalls.count() == 0) {
+        return result;
+    }
+
+    result += QString(" (p50 %1 ms, p99 %2 ms, max %3 ms)")
+        .arg(m_stalls.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_stalls.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(m_stalls.max() / 1000.0, 0, 'f', 1);
+
+    // Phases with the most stalls first
+    QStringList phases = m_stallsByPhase.keys();
+    std::sort(phases.begin(), phases.end(), [this](const QString& a, const QString& b) {
+        return m_stallsByPhase.value(a) > m_stallsByPhase.value(b);
+    });
+    for (const QString& phase : phases) {
+        result += QString("\n  %1: %2 stall(s), worst %3 ms")
+            .arg(phase, -28)
+            .arg(m_stallsByPhase.value(phase))
+            .arg(m_worstByPhase.value(phase) / 1000.0, 0, 'f', 1);
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include "LatencyHistogram.h"
+#include <QObject>
+#include <QTimer>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QElapsedTimer>
+#include <atomic>
+
+// Measures how late the thread it lives on (normally the GUI thread) gets
+// back to its event loop. A precise heartbeat timer records how late every
+// beat fires; a monitor thread watches the last beat and, while a stall is
+// still in progress, captures the phase the thread is stuck in. Stalls over
+// the threshold are recorded with that phase once the thread recovers.
+//
+// Phases are marked with PhaseScope, on the watched thread, around slots that
+// may run long; names must be string literals (only the pointer is stored).
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StallWatchdog(int thresholdMs = 100, QObject *parent = nullptr);
+    ~StallWatchdog();
+
+    void start();
+    void stop();
+
+    class PhaseScope
+    {
+    public:
+        explicit PhaseScope(const char* phase);
+        ~PhaseScope();
+
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+
+    private:
+        const char* m_previous;
+    };
+
+    // Takes effect on the next start()
+    void setThresholdMs(int thresholdMs) { m_thresholdMs = qMax(1, thresholdMs); }
+    int thresholdMs() const { return m_thresholdMs; }
+    qint64 stallCount() const { return m_stalls.count(); }
+
+    // Lateness of every heartbeat, and of the beats over the threshold
+    const LatencyHistogram& latencyHistogram() const { return m_latency; }
+    const LatencyHistogram& stallHistogram() const { return m_stalls; }
+
+    QString summary() const;
+
+signals:
+    // Emitted on the watched thread once a stall is over
+    void stallDetected(qint64 durationUs, const QString& phase);
+
+private slots:
+    void onHeartbeat();
+
+private:
+    void monitorLoop();
+
+    static const int HEARTBEAT_MS = 20;
+
+    int m_thresholdMs;
+    QTimer* m_heartbeat;
+    QThread* m_monitor;
+    QElapsedTimer m_clock;
+    std::atomic<qint64> m_lastBeatNs;
+    std::atomic<bool> m_running;
+
+    // Phase captured by the monitor for the beat it saw overdue
+    QMutex m_captureMutex;
+    qint64 m_capturedBeatNs;
+    const char* m_capturedPhase;
+
+    LatencyHistogram m_latency;
+    LatencyHistogram m_stalls;
+    QHash<QString, quint64> m_stallsByPhase;
+    QHash<QString, qint64> m_worstByPhase;
+
+    static std::atomic<const char*> s_phase;
+};
+
+#endif // STALLWATCHDOG_H
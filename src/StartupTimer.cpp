@@ -0,0 +1,54 @@
+#include "StartupTimer.h"
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+namespace {
+
+QElapsedTimer& clock()
+{
+    static QElapsedTimer timer;
+    return timer;
+}
+
+QList<QPair<QString, qint64>>& marks()
+{
+    static QList<QPair<QString, qint64>> phases;
+    return phases;
+}
+
+}
+
+void StartupTimer::start()
+{
+    clock().start();
+    marks().clear();
+}
+
+void StartupTimer::mark(const QString& phase)
+{
+    if (!clock().isValid()) return;
+    marks().append(qMakePair(phase, clock().nsecsElapsed() / 1000));
+}
+
+qint64 StartupTimer::elapsedMs()
+{
+    return clock().isValid() ? clock().elapsed() : 0;
+}
+
+QString StartupTimer::report()
+{
+    QStringList lines;
+    lines << "Startup timing:";
+
+    qint64 previousUs = 0;
+    for (const QPair<QString, qint64>& phase : marks()) {
+        lines << QString("  %1 %2 ms (+%3 ms)")
+            .arg(phase.first + ":", -22)
+            .arg(phase.second / 1000.0, 7, 'f', 1)
+            .arg((phase.second - previousUs) / 1000.0, 0, 'f', 1);
+        previousUs = phase.second;
+    }
+    return lines.join('\n');
+}
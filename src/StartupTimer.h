@@ -0,0 +1,20 @@
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+#include <QString>
+
+// Process-wide marks for tracking GUI time-to-first-frame. start() is called
+// first thing in main(); every later mark records the time since then.
+class StartupTimer
+{
+public:
+    static void start();
+    static void mark(const QString& phase);
+
+    static qint64 elapsedMs();
+
+    // One line per phase: total time and time since the previous mark
+    static QString report();
+};
+
+#endif // STARTUPTIMER_H
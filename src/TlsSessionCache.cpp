@@ -0,0 +1,82 @@
+#include "TlsSessionCache.h"
+#include <QMutexLocker>
+#include <QDateTime>
+
+TlsSessionCache* TlsSessionCache::shared()
+{
+    static TlsSessionCache cache;
+    return &cache;
+}
+
+QString TlsSessionCache::key(const QUrl& url, const QString& clientCertificatePath)
+{
+    return QString("%1:%2|%3").arg(url.host()).arg(url.port(443)).arg(clientCertificatePath);
+}
+
+QByteArray TlsSessionCache::ticket(const QString& key) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_tickets.constFind(key);
+    if (it == m_tickets.constEnd() || it->expiresMs <= QDateTime::currentMSecsSinceEpoch()) {
+        return QByteArray();
+    }
+    return it->ticket;
+}
+
+void TlsSessionCache::store(const QString& key, const QByteArray& ticket, int lifetimeHintSeconds)
+{
+    if (ticket.isEmpty()) return;
+
+    Entry entry;
+    entry.ticket = ticket;
+    entry.expiresMs = QDateTime::currentMSecsSinceEpoch()
+                    + qint64(lifetimeHintSeconds > 0 ? lifetimeHintSeconds : DEFAULT_LIFETIME_S) * 1000;
+
+    QMutexLocker locker(&m_mutex);
+    m_tickets.insert(key, entry);
+}
+
+void TlsSessionCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_tickets.clear();
+}
+
+void TlsSessionCache::recordHandshake(qint64 connectUs, bool ticketOffered)
+{
+    if (connectUs < 0) return;
+
+    QMutexLocker locker(&m_mutex);
+    (ticketOffered ? m_resumedHandshakes : m_fullHandshakes).record(connectUs);
+}
+
+void TlsSessionCache::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_fullHandshakes.reset();
+    m_resumedHandshakes.reset();
+}
+
+QString TlsSessionCache::summary() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QString result = QString("TLS connects: %1 without a cached session (p50 %2 ms, p99 %3 ms), "
+                             "%4 offering one (p50 %5 ms, p99 %6 ms)")
+        .arg(m_fullHandshakes.count())
+        .arg(m_fullHandshakes.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_fullHandshakes.percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(m_resumedHandshakes.count())
+        .arg(m_resumedHandshakes.percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(m_resumedHandshakes.percentile(99) / 1000.0, 0, 'f', 1);
+
+    // Both groups include the TCP connect, so the difference of the means is the TLS saving
+    if (m_fullHandshakes.count() > 0 && m_resumedHandshakes.count() > 0) {
+        double savedMs = (m_fullHandshakes.mean() - m_resumedHandshakes.mean()) / 1000.0;
+        result += QString("; resumption saved %1 ms per connection, %2 s in total")
+            .arg(savedMs, 0, 'f', 1)
+            .arg(savedMs * m_resumedHandshakes.count() / 1000.0, 0, 'f', 1);
+    }
+    return result;
+}
@@ -0,0 +1,55 @@
+#ifndef TLSSESSIONCACHE_H
+#define TLSSESSIONCACHE_H
+
+#include "LatencyHistogram.h"
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QUrl>
+
+// Process-wide TLS session tickets per endpoint. Each QNetworkAccessManager
+// only resumes sessions of its own connections, so with one manager per
+// flow or thread almost every new connection pays a full handshake (with
+// client certificate verification under mTLS). Tickets stored here are
+// offered by every manager on any thread and outlive individual runs.
+//
+// Also keeps the connect time of new connections split by whether a ticket
+// was offered, which is how the summary estimates what resumption saves.
+class TlsSessionCache
+{
+public:
+    static TlsSessionCache* shared();
+
+    // Sessions made with a client certificate are only offered with that certificate
+    static QString key(const QUrl& url, const QString& clientCertificatePath);
+
+    // Empty if there is no unexpired ticket for the key
+    QByteArray ticket(const QString& key) const;
+    void store(const QString& key, const QByteArray& ticket, int lifetimeHintSeconds);
+    void clear();
+
+    // Connect (TCP + TLS) time of one new https connection
+    void recordHandshake(qint64 connectUs, bool ticketOffered);
+    void resetStatistics();
+    QString summary() const;
+
+private:
+    TlsSessionCache() = default;
+
+    struct Entry
+    {
+        QByteArray ticket;
+        qint64 expiresMs = 0;
+    };
+
+    // Used when the server gives no lifetime hint
+    static const int DEFAULT_LIFETIME_S = 300;
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_tickets;
+    LatencyHistogram m_fullHandshakes;
+    LatencyHistogram m_resumedHandshakes;
+};
+
+#endif // TLSSESSIONCACHE_H
@@ -0,0 +1,241 @@
+#include "TokenAnalytics.h"
+#include "JWTDecoder.h"
+#include "JsonScanner.h"
+#include <QMutexLocker>
+#include <QVarLengthArray>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+struct ClaimObservation
+{
+    QString name;
+    int valueBytes;
+    int arrayLength;    // -1 for non-arrays
+};
+
+// Number of elements in the array starting at pos, -1 if malformed
+int countArrayElements(const char* data, int pos, int size)
+{
+    pos = JsonScanner::skipWhitespace(data, pos + 1, size);
+    if (pos < size && data[pos] == ']') return 0;
+
+    int count = 0;
+    while (pos < size) {
+        JsonType type;
+        pos = JsonScanner::skipValue(data, pos, size, &type);
+        if (pos < 0) return -1;
+        ++count;
+
+        pos = JsonScanner::skipWhitespace(data, pos, size);
+        if (pos >= size) return -1;
+        if (data[pos] == ']') return count;
+        if (data[pos] != ',') return -1;
+        pos = JsonScanner::skipWhitespace(data, pos + 1, size);
+    }
+    return -1;
+}
+
+QJsonObject histogramJson(const LatencyHistogram& histogram)
+{
+    QJsonObject json;
+    json["count"] = histogram.count();
+    json["mean"] = histogram.mean();
+    json["p50"] = histogram.percentile(50);
+    json["p95"] = histogram.percentile(95);
+    json["p99"] = histogram.percentile(99);
+    json["max"] = histogram.max();
+    return json;
+}
+
+}
+
+TokenAnalytics::TokenAnalytics(int oversizeBytes)
+    : m_oversizeBytes(oversizeBytes)
+{
+}
+
+QString TokenAnalytics::typeName(TokenType type)
+{
+    switch (type) {
+    case IdToken: return "id_token";
+    case AccessToken: return "access_token";
+    case RefreshToken: return "refresh_token";
+    default: return QString();
+    }
+}
+
+void TokenAnalytics::observe(TokenType type, const QString& token)
+{
+    if (token.isEmpty() || type < 0 || type >= TokenTypeCount) return;
+
+    // Scan before taking the lock
+    QByteArray header;
+    QByteArray payload;
+    bool isJWT = JWTDecoder::splitJWT(token, &header, &payload);
+
+    QVarLengthArray<ClaimObservation, 32> claims;
+    if (isJWT) {
+        const char* data = payload.constData();
+        const int size = payload.size();
+        isJWT = JsonScanner::forEachMember(data, size,
+            [&](int keyOffset, int keyLength, bool keyEscaped, int valueOffset, int valueLength, JsonType valueType) {
+                ClaimObservation claim;
+                claim.name = keyEscaped ? JsonScanner::unescape(data + keyOffset, keyLength)
+                                        : QString::fromUtf8(data + keyOffset, keyLength);
+                claim.valueBytes = valueLength;
+                claim.arrayLength = valueType == JsonType::Array ? countArrayElements(data, valueOffset, size) : -1;
+                claims.append(claim);
+                return true;
+            });
+    }
+
+    TypeStats& stats = m_types[type];
+    QMutexLocker locker(&stats.mutex);
+
+    ++stats.tokens;
+    stats.tokenBytes.record(token.size());
+    if (token.size() > m_oversizeBytes) {
+        ++stats.oversize;
+    }
+
+    if (!isJWT) {
+        ++stats.opaque;
+        return;
+    }
+
+    stats.headerBytes.record(header.size());
+    stats.payloadBytes.record(payload.size());
+    for (const ClaimObservation& claim : claims) {
+        ClaimStats& claimStats = stats.claims[claim.name];
+        ++claimStats.present;
+        claimStats.valueBytes.record(claim.valueBytes);
+        if (claim.arrayLength >= 0) {
+            claimStats.arrayLength.record(claim.arrayLength);
+        }
+    }
+}
+
+void TokenAnalytics::reset()
+{
+    for (TypeStats& stats : m_types) {
+        QMutexLocker locker(&stats.mutex);
+        stats.tokens = 0;
+        stats.opaque = 0;
+        stats.oversize = 0;
+        stats.tokenBytes.reset();
+        stats.headerBytes.reset();
+        stats.payloadBytes.reset();
+        stats.claims.clear();
+    }
+}
+
+quint64 TokenAnalytics::tokenCount(TokenType type) const
+{
+    QMutexLocker locker(&m_types[type].mutex);
+    return m_types[type].tokens;
+}
+
+quint64 TokenAnalytics::oversizeCount(TokenType type) const
+{
+    QMutexLocker locker(&m_types[type].mutex);
+    return m_types[type].oversize;
+}
+
+QString TokenAnalytics::summary() const
+{
+    QStringList lines;
+    lines << "Token sizes:";
+
+    for (int type = 0; type < TokenTypeCount; ++type) {
+        const TypeStats& stats = m_types[type];
+        QMutexLocker locker(&stats.mutex);
+        if (stats.tokens == 0) continue;
+
+        QString line = QString("  %1: %2 token(s), size p50 %3 B, p95 %4 B, max %5 B")
+            .arg(typeName(TokenType(type)))
+            .arg(stats.tokens)
+            .arg(stats.tokenBytes.percentile(50))
+            .arg(stats.tokenBytes.percentile(95))
+            .arg(stats.tokenBytes.max());
+        if (stats.headerBytes.count() > 0) {
+            line += QString(", header p50 %1 B, payload p50 %2 B")
+                .arg(stats.headerBytes.percentile(50))
+                .arg(stats.payloadBytes.percentile(50));
+        }
+        if (stats.opaque > 0) {
+            line += QString(", %1 opaque").arg(stats.opaque);
+        }
+        if (stats.oversize > 0) {
+            line += QString(", %1 over %2 B").arg(stats.oversize).arg(m_oversizeBytes);
+        }
+        lines << line;
+
+        // Largest claims first: they are what to look at when tokens grow
+        QVector<QHash<QString, ClaimStats>::const_iterator> order;
+        for (auto it = stats.claims.constBegin(); it != stats.claims.constEnd(); ++it) {
+            order.append(it);
+        }
+        std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+            return a->valueBytes.max() > b->valueBytes.max();
+        });
+
+        for (const auto& it : order) {
+            const ClaimStats& claim = it.value();
+            QString claimLine = QString("    %1: %2% present, size p50 %3 B, max %4 B")
+                .arg(it.key())
+                .arg(100.0 * claim.present / stats.headerBytes.count(), 0, 'f', 1)
+                .arg(claim.valueBytes.percentile(50))
+                .arg(claim.valueBytes.max());
+            if (claim.arrayLength.count() > 0) {
+                claimLine += QString(", length p50 %1, p95 %2, max %3")
+                    .arg(claim.arrayLength.percentile(50))
+                    .arg(claim.arrayLength.percentile(95))
+                    .arg(claim.arrayLength.max());
+            }
+            lines << claimLine;
+        }
+    }
+
+    if (lines.size() == 1) {
+        lines << "  no tokens observed";
+    }
+    return lines.join('\n');
+}
+
+QJsonObject TokenAnalytics::toJson() const
+{
+    QJsonObject json;
+    json["oversizeBytes"] = m_oversizeBytes;
+
+    for (int type = 0; type < TokenTypeCount; ++type) {
+        const TypeStats& stats = m_types[type];
+        QMutexLocker locker(&stats.mutex);
+        if (stats.tokens == 0) continue;
+
+        QJsonObject typeJson;
+        typeJson["tokens"] = qint64(stats.tokens);
+        typeJson["opaque"] = qint64(stats.opaque);
+        typeJson["oversize"] = qint64(stats.oversize);
+        typeJson["bytes"] = histogramJson(stats.tokenBytes);
+        typeJson["headerBytes"] = histogramJson(stats.headerBytes);
+        typeJson["payloadBytes"] = histogramJson(stats.payloadBytes);
+
+        QJsonObject claimsJson;
+        for (auto it = stats.claims.constBegin(); it != stats.claims.constEnd(); ++it) {
+            QJsonObject claimJson;
+            claimJson["present"] = qint64(it->present);
+            claimJson["bytes"] = histogramJson(it->valueBytes);
+            if (it->arrayLength.count() > 0) {
+                claimJson["length"] = histogramJson(it->arrayLength);
+            }
+            claimsJson[it.key()] = claimJson;
+        }
+        typeJson["claims"] = claimsJson;
+
+        json[typeName(TokenType(type))] = typeJson;
+    }
+    return json;
+}
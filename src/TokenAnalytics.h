@@ -0,0 +1,66 @@
+#ifndef TOKENANALYTICS_H
+#define TOKENANALYTICS_H
+
+#include "LatencyHistogram.h"
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+
+// Streaming size and shape statistics over every token issued during a run,
+// to track token bloat between IdP releases. Per token type it keeps
+// histograms of the encoded size and of the decoded header and payload, and
+// per claim how often it is present, its encoded size and, for arrays such
+// as groups or roles, its length. Tokens are scanned outside the lock; only
+// the counter updates are serialised, one mutex per token type.
+//
+// LatencyHistogram doubles as the size histogram here (exact below 128,
+// ~1.6% relative precision above).
+class TokenAnalytics
+{
+public:
+    enum TokenType { IdToken, AccessToken, RefreshToken, TokenTypeCount };
+
+    // Common proxy header buffer size (e.g. nginx large_client_header_buffers)
+    static const int DEFAULT_OVERSIZE_BYTES = 8192;
+
+    explicit TokenAnalytics(int oversizeBytes = DEFAULT_OVERSIZE_BYTES);
+
+    // Safe from any thread; empty tokens are ignored
+    void observe(TokenType type, const QString& token);
+
+    void reset();
+
+    quint64 tokenCount(TokenType type) const;
+    quint64 oversizeCount(TokenType type) const;
+
+    QString summary() const;
+    QJsonObject toJson() const;
+
+    static QString typeName(TokenType type);
+
+private:
+    struct ClaimStats
+    {
+        quint64 present = 0;
+        LatencyHistogram valueBytes;
+        LatencyHistogram arrayLength;
+    };
+
+    struct TypeStats
+    {
+        mutable QMutex mutex;
+        quint64 tokens = 0;
+        quint64 opaque = 0;
+        quint64 oversize = 0;
+        LatencyHistogram tokenBytes;
+        LatencyHistogram headerBytes;
+        LatencyHistogram payloadBytes;
+        QHash<QString, ClaimStats> claims;
+    };
+
+    int m_oversizeBytes;
+    TypeStats m_types[TokenTypeCount];
+};
+
+#endif // TOKENANALYTICS_H
@@ -0,0 +1,228 @@
+#include "TokenCache.h"
+#include "ClaimExtractor.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QDataStream>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <openssl/evp.h>
+
+static const quint32 CACHE_MAGIC = 0x4F544B43;   // "OTKC"
+static const int KEY_LENGTH = 32;
+static const int IV_LENGTH = 12;
+static const int TAG_LENGTH = 16;
+
+static QByteArray aesGcm(bool encrypt, const QByteArray& key, const QByteArray& iv,
+                         const QByteArray& input, QByteArray* tag)
+{
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) return QByteArray();
+
+    QByteArray output(input.size(), Qt::Uninitialized);
+    int length = 0;
+    int finalLength = 0;
+    bool ok = EVP_CipherInit_ex(ctx, EVP_aes_256_gcm(), nullptr,
+                                reinterpret_cast<const unsigned char*>(key.constData()),
+                                reinterpret_cast<const unsigned char*>(iv.constData()),
+                                encrypt ? 1 : 0) == 1
+           && EVP_CipherUpdate(ctx, reinterpret_cast<unsigned char*>(output.data()), &length,
+                               reinterpret_cast<const unsigned char*>(input.constData()), input.size()) == 1;
+
+    if (ok && !encrypt) {
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_LENGTH, tag->data()) == 1;
+    }
+    // GCM produces no trailing block, but Final verifies the tag on decrypt
+    ok = ok && EVP_CipherFinal_ex(ctx, reinterpret_cast<unsigned char*>(output.data()) + length, &finalLength) == 1;
+    if (ok && encrypt) {
+        tag->resize(TAG_LENGTH);
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_LENGTH, tag->data()) == 1;
+    }
+
+    EVP_CIPHER_CTX_free(ctx);
+    return ok ? output.left(length + finalLength) : QByteArray();
+}
+
+qint64 CachedTokens::remainingMs() const
+{
+    if (expiresAtMs == 0) return 0;
+    return expiresAtMs - QDateTime::currentMSecsSinceEpoch();
+}
+
+TokenCache::TokenCache(const QString& filePath)
+    : m_filePath(filePath)
+{
+    load();
+}
+
+QString TokenCache::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/token-cache.bin";
+}
+
+QString TokenCache::cacheKey(const QString& issuerURL, const QString& clientID,
+                             const QString& scopes, const QString& acrValue)
+{
+    QString issuer = issuerURL.trimmed();
+    while (issuer.endsWith('/')) {
+        issuer.chop(1);
+    }
+
+    // Scope order does not change what the tokens grant
+    QStringList scopeList = scopes.split(' ', Qt::SkipEmptyParts);
+    scopeList.sort();
+    scopeList.removeDuplicates();
+
+    return QStringList({issuer, clientID.trimmed(), scopeList.join(' '), acrValue}).join('\n');
+}
+
+qint64 TokenCache::expiryFromResponse(const QJsonObject& response)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (response.contains("expires_in")) {
+        // Implicit callbacks carry expires_in as a string
+        qint64 seconds = response["expires_in"].isString()
+            ? response["expires_in"].toString().toLongLong()
+            : qint64(response["expires_in"].toDouble());
+        if (seconds > 0) {
+            return now + seconds * 1000;
+        }
+    }
+
+    // Otherwise fall back to the exp claim of a JWT access or ID token
+    for (const char* name : {"access_token", "id_token"}) {
+        ClaimSet claims;
+        ClaimExtractor::extractFromJWT(response[name].toString(), claimBit(Claim::Exp), &claims);
+        qint64 exp = claims.integer(Claim::Exp);
+        if (exp > 0) {
+            return exp * 1000;
+        }
+    }
+    return 0;
+}
+
+bool TokenCache::lookup(const QString& key, CachedTokens* tokens) const
+{
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd()) return false;
+
+    if (tokens) {
+        *tokens = it.value();
+    }
+    return true;
+}
+
+void TokenCache::store(const QString& key, const QJsonObject& response)
+{
+    CachedTokens entry;
+    entry.response = response;
+    entry.expiresAtMs = expiryFromResponse(response);
+
+    if (!response.contains("refresh_token") && m_entries.contains(key)) {
+        QString previous = m_entries[key].refreshToken();
+        if (!previous.isEmpty()) {
+            entry.response["refresh_token"] = previous;
+        }
+    }
+
+    m_entries.insert(key, entry);
+    save();
+}
+
+void TokenCache::remove(const QString& key)
+{
+    if (m_entries.remove(key) > 0) {
+        save();
+    }
+}
+
+void TokenCache::clear()
+{
+    m_entries.clear();
+    save();
+}
+
+QByteArray TokenCache::encryptionKey() const
+{
+    QString keyPath = m_filePath + ".key";
+    QFile keyFile(keyPath);
+    if (keyFile.open(QIODevice::ReadOnly)) {
+        QByteArray key = keyFile.readAll();
+        if (key.size() == KEY_LENGTH) {
+            return key;
+        }
+        keyFile.close();
+    }
+
+    QByteArray key(KEY_LENGTH, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(key.data()), KEY_LENGTH / 4);
+
+    QDir().mkpath(QFileInfo(keyPath).absolutePath());
+    QSaveFile out(keyPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        return QByteArray();
+    }
+    out.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    out.write(key);
+    return out.commit() ? key : QByteArray();
+}
+
+void TokenCache::load()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic;
+    QByteArray iv, tag, ciphertext;
+    in >> magic >> iv >> tag >> ciphertext;
+    if (in.status() != QDataStream::Ok || magic != CACHE_MAGIC || iv.size() != IV_LENGTH || tag.size() != TAG_LENGTH) {
+        return;
+    }
+
+    QByteArray key = encryptionKey();
+    if (key.isEmpty()) return;
+
+    // A wrong key or tampered file fails tag verification and is ignored
+    QByteArray plaintext = aesGcm(false, key, iv, ciphertext, &tag);
+    QJsonObject entries = QJsonDocument::fromJson(plaintext).object();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        QJsonObject entry = it.value().toObject();
+        CachedTokens tokens;
+        tokens.response = entry["response"].toObject();
+        tokens.expiresAtMs = qint64(entry["expiresAtMs"].toDouble());
+        m_entries.insert(it.key(), tokens);
+    }
+}
+
+void TokenCache::save() const
+{
+    QByteArray key = encryptionKey();
+    if (key.isEmpty()) return;
+
+    QJsonObject entries;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        QJsonObject entry;
+        entry["response"] = it.value().response;
+        entry["expiresAtMs"] = double(it.value().expiresAtMs);
+        entries[it.key()] = entry;
+    }
+
+    QByteArray iv(IV_LENGTH, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(iv.data()), IV_LENGTH / 4);
+    QByteArray tag;
+    QByteArray ciphertext = aesGcm(true, key, iv, QJsonDocument(entries).toJson(QJsonDocument::Compact), &tag);
+    if (tag.size() != TAG_LENGTH) return;
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    QDataStream out(&file);
+    out << CACHE_MAGIC << iv << tag << ciphertext;
+    file.commit();
+}
@@ -0,0 +1,52 @@
+#ifndef TOKENCACHE_H
+#define TOKENCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QJsonObject>
+
+// A token endpoint response plus the absolute time it stops being usable
+struct CachedTokens
+{
+    QJsonObject response;
+    qint64 expiresAtMs = 0;     // ms since epoch; 0 = unknown
+
+    QString refreshToken() const { return response["refresh_token"].toString(); }
+    qint64 remainingMs() const;
+};
+
+// Tokens keyed by issuer, client, scopes and ACR, held in memory and mirrored
+// to an AES-256-GCM encrypted file. The 256-bit key lives next to it in an
+// owner-only file, so the cache is safe to copy around but not against the
+// same local user. Not thread-safe.
+class TokenCache
+{
+public:
+    explicit TokenCache(const QString& filePath = defaultPath());
+
+    static QString defaultPath();
+    static QString cacheKey(const QString& issuerURL, const QString& clientID,
+                            const QString& scopes, const QString& acrValue);
+
+    bool lookup(const QString& key, CachedTokens* tokens) const;
+
+    // Stores a token endpoint (or implicit callback) response. A refresh
+    // response without a new refresh_token keeps the previous one.
+    void store(const QString& key, const QJsonObject& response);
+    void remove(const QString& key);
+    void clear();
+
+    int size() const { return m_entries.size(); }
+
+private:
+    static qint64 expiryFromResponse(const QJsonObject& response);
+
+    void load();
+    void save() const;
+    QByteArray encryptionKey() const;
+
+    QString m_filePath;
+    QHash<QString, CachedTokens> m_entries;
+};
+
+#endif // TOKENCACHE_H
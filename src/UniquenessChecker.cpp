@@ -0,0 +1,118 @@
+#include "UniquenessChecker.h"
+#include <QHashFunctions>
+#include <QMutexLocker>
+#include <cmath>
+
+UniquenessChecker::UniquenessChecker(quint64 bloomBytes, int shardCount)
+    : m_shardCount(qMax(1, shardCount))
+    , m_bloomBits(bloomBytes * 8)
+{
+    if (m_bloomBits > 0) {
+        quint64 words = (m_bloomBits + 63) / 64;
+        m_bloomWords.reset(new std::atomic<quint64>[words]);
+        for (quint64 i = 0; i < words; ++i) {
+            m_bloomWords[i].store(0, std::memory_order_relaxed);
+        }
+    } else {
+        m_shards.reset(new Shard[m_shardCount]);
+    }
+
+    for (int kind = 0; kind < KindCount; ++kind) {
+        m_observed[kind].store(0, std::memory_order_relaxed);
+        m_duplicates[kind].store(0, std::memory_order_relaxed);
+    }
+}
+
+QString UniquenessChecker::kindName(Kind kind)
+{
+    switch (kind) {
+    case Jti: return "jti";
+    case Code: return "code";
+    case Nonce: return "nonce";
+    default: return QString();
+    }
+}
+
+bool UniquenessChecker::testAndSetBloom(quint64 h1, quint64 h2)
+{
+    // Double hashing: bit i = h1 + i * h2; the value is new if any bit was clear
+    bool wasNew = false;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        quint64 bit = (h1 + quint64(i) * h2) % m_bloomBits;
+        quint64 mask = quint64(1) << (bit % 64);
+        quint64 previous = m_bloomWords[bit / 64].fetch_or(mask, std::memory_order_relaxed);
+        wasNew = wasNew || !(previous & mask);
+    }
+    return wasNew;
+}
+
+bool UniquenessChecker::observe(Kind kind, const QByteArray& value)
+{
+    if (value.isEmpty()) return true;
+
+    m_observed[kind].fetch_add(1, std::memory_order_relaxed);
+
+    // Kinds are kept apart by seeding the fingerprint differently
+    quint64 fingerprint = quint64(qHashBits(value.constData(), size_t(value.size()), size_t(kind) + 1));
+
+    bool isNew;
+    if (m_bloomBits > 0) {
+        quint64 second = quint64(qHashBits(value.constData(), size_t(value.size()), size_t(kind) + 0x9E3779B9)) | 1;
+        isNew = testAndSetBloom(fingerprint, second);
+    } else {
+        Shard& shard = m_shards[int((fingerprint >> 40) % quint64(m_shardCount))];
+        QMutexLocker locker(&shard.mutex);
+        int before = shard.fingerprints.size();
+        shard.fingerprints.insert(fingerprint);
+        isNew = shard.fingerprints.size() != before;
+    }
+
+    if (!isNew) {
+        m_duplicates[kind].fetch_add(1, std::memory_order_relaxed);
+        QMutexLocker locker(&m_sampleMutex);
+        if (m_samples[kind].size() < MAX_SAMPLES) {
+            m_samples[kind].append(QString::fromUtf8(value.left(64)));
+        }
+    }
+    return isNew;
+}
+
+quint64 UniquenessChecker::totalDuplicates() const
+{
+    quint64 total = 0;
+    for (int kind = 0; kind < KindCount; ++kind) {
+        total += duplicates(Kind(kind));
+    }
+    return total;
+}
+
+double UniquenessChecker::bloomFalsePositiveRate() const
+{
+    quint64 inserted = 0;
+    for (int kind = 0; kind < KindCount; ++kind) {
+        inserted += observed(Kind(kind));
+    }
+    return std::pow(1.0 - std::exp(-double(BLOOM_HASHES) * inserted / double(m_bloomBits)), BLOOM_HASHES);
+}
+
+QString UniquenessChecker::summary() const
+{
+    QString result = isExact()
+        ? QString("Uniqueness (exact):")
+        : QString("Uniqueness (Bloom, %1 MB, est. false-positive rate %2%):")
+              .arg(m_bloomBits / 8.0 / (1024 * 1024), 0, 'f', 1)
+              .arg(bloomFalsePositiveRate() * 100.0, 0, 'g', 2);
+
+    for (int kind = 0; kind < KindCount; ++kind) {
+        result += QString(" %1 %2/%3 duplicate").arg(kindName(Kind(kind))).arg(duplicates(Kind(kind))).arg(observed(Kind(kind)));
+        result += kind + 1 < KindCount ? "," : "";
+    }
+
+    QMutexLocker locker(&m_sampleMutex);
+    for (int kind = 0; kind < KindCount; ++kind) {
+        for (const QString& sample : m_samples[kind]) {
+            result += QString("\n  repeated %1: %2").arg(kindName(Kind(kind)), sample);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef UNIQUENESSCHECKER_H
+#define UNIQUENESSCHECKER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+// Detects values an IdP hands out more than once (jti, authorization code,
+// ID token nonce) across a load run, from any number of threads.
+//
+// Exact mode keeps a 64-bit fingerprint of every value in a sharded hash set
+// (one mutex per shard, so threads rarely contend). Bloom mode bounds memory
+// to a fixed atomic bit array instead; duplicates are then "probable" and the
+// summary reports the estimated false-positive rate.
+class UniquenessChecker
+{
+public:
+    enum Kind { Jti, Code, Nonce, KindCount };
+
+    // bloomBytes == 0 selects exact mode
+    explicit UniquenessChecker(quint64 bloomBytes = 0, int shardCount = 64);
+
+    // Returns false (and counts a duplicate) if the value was seen before
+    bool observe(Kind kind, const QByteArray& value);
+
+    bool isExact() const { return m_bloomBits == 0; }
+    quint64 observed(Kind kind) const { return m_observed[kind].load(std::memory_order_relaxed); }
+    quint64 duplicates(Kind kind) const { return m_duplicates[kind].load(std::memory_order_relaxed); }
+    quint64 totalDuplicates() const;
+
+    QString summary() const;
+
+    static QString kindName(Kind kind);
+
+private:
+    struct Shard
+    {
+        QMutex mutex;
+        QSet<quint64> fingerprints;
+    };
+
+    bool testAndSetBloom(quint64 h1, quint64 h2);
+    double bloomFalsePositiveRate() const;
+
+    static const int BLOOM_HASHES = 7;
+    static const int MAX_SAMPLES = 5;
+
+    std::unique_ptr<Shard[]> m_shards;
+    int m_shardCount;
+    std::unique_ptr<std::atomic<quint64>[]> m_bloomWords;
+    quint64 m_bloomBits;
+    std::atomic<quint64> m_observed[KindCount];
+    std::atomic<quint64> m_duplicates[KindCount];
+
+    mutable QMutex m_sampleMutex;
+    QStringList m_samples[KindCount];
+};
+
+#endif // UNIQUENESSCHECKER_H
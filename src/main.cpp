@@ -1,18 +1,507 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QTimer>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QTimeZone>
+#include <cstring>
 #include "MainWindow.h"
+#include "LoadRunner.h"
+#include "ExchangeCapture.h"
+#include "ReplayServer.h"
+#include "SoakMonitor.h"
+#include "JsonScanner.h"
+#include "ClaimRules.h"
+#include "UniquenessChecker.h"
+#include "TokenAnalytics.h"
+#include "StartupTimer.h"
+#include "Scenario.h"
+#include "LoadCoordinator.h"
+#include "LoadWorker.h"
+#include "ResultsFile.h"
+#include "RetryPolicy.h"
+#include "TlsSessionCache.h"
+
+static bool hasArgument(int argc, char *argv[], const char* name)
+{
+    const size_t length = std::strlen(name);
+    for (int i = 1; i < argc; ++i) {
+        // Matches both "--option value" and "--option=value"
+        if (std::strncmp(argv[i], name, length) == 0 && (argv[i][length] == '\0' || argv[i][length] == '=')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void setApplicationMetadata()
+{
+    QCoreApplication::setApplicationName("OIDC Tester");
+    QCoreApplication::setOrganizationName("OIDC Tester");
+    QCoreApplication::setApplicationVersion("1.0.0");
+}
+
+// Coordinator mode: split the run across worker processes and merge their results
+static int runCoordinator(QCoreApplication& app, const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    auto log = [&out](const QString& message) {
+        out << message << Qt::endl;
+    };
+
+    WorkerAssignment totals;
+    totals.flows = parser.value("flows").toInt();
+    totals.concurrency = parser.value("concurrency").toInt();
+    totals.ratePerSecond = parser.value("rate").toDouble();
+    if (parser.isSet("soak")) {
+        totals.durationMs = qint64(parser.value("soak").toDouble() * 3600.0 * 1000.0);
+    }
+
+    QString error;
+    if (parser.isSet("scenario")) {
+        // Only checked and read for its concurrency here; every worker compiles its own copy
+        Scenario scenario;
+        if (!scenario.loadFile(parser.value("scenario"), OIDCConfig(), &error)) {
+            log(QString("Invalid scenario: %1").arg(error));
+            return 1;
+        }
+        if (scenario.concurrency() > 0 && !parser.isSet("concurrency")) {
+            totals.concurrency = scenario.concurrency();
+        }
+    }
+
+    // Options every worker needs to build the same flows; run shape comes from its assignment
+    QStringList workerArguments;
+    for (const char* name : {"profile", "threads", "form-fields", "replay", "replay-scale", "scenario",
+                             "rules", "unique-bloom-mb", "json-backend", "retries", "retry-base-ms",
+                             "retry-max-ms", "hedge-delay-ms", "client-cert", "client-key",
+                             "assertion-key", "assertion-kid", "record", "results", "token-stats-out"}) {
+        if (parser.isSet(name)) {
+            workerArguments << QString("--%1").arg(name) << parser.value(name);
+        }
+    }
+    for (const char* name : {"unique", "token-stats", "hedge", "network-timing", "no-tls-resumption", "dpop"}) {
+        if (parser.isSet(name)) {
+            workerArguments << QString("--%1").arg(name);
+        }
+    }
+
+    for (const char* name : {"record", "results", "token-stats-out"}) {
+        if (parser.isSet(name)) {
+            log(QString("Workers write --%1 to %2.w<worker>").arg(QLatin1String(name), parser.value(name)));
+        }
+    }
+
+    LoadCoordinator coordinator;
+    coordinator.setTotals(totals);
+    coordinator.setWorkerArguments(workerArguments);
+    QObject::connect(&coordinator, &LoadCoordinator::logMessage, log);
+    QObject::connect(&coordinator, &LoadCoordinator::finished, &app, [&]() {
+        log(coordinator.summary());
+        // Same rule as a single-process run: failures and failed checks both exit 2
+        const bool violated = coordinator.ruleViolations() > 0 || coordinator.duplicateValues() > 0;
+        app.exit(coordinator.failedFlows() > 0 || coordinator.lostWorkers() > 0 || violated ? 2 : 0);
+    });
+
+    QString serverName = parser.isSet("coordinator-socket")
+        ? parser.value("coordinator-socket")
+        : QString("oidc-tester-%1").arg(QCoreApplication::applicationPid());
+    if (!coordinator.start(serverName, parser.value("coordinator").toInt(), parser.value("attach").toInt(), &error)) {
+        log(error);
+        return 1;
+    }
+    return app.exec();
+}
+
+// Analysis mode: re-aggregate a results file written by --results
+static int runAnalyze(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    ResultsReader reader;
+    QString error;
+    if (!reader.open(parser.value("analyze"), &error)) {
+        out << error << Qt::endl;
+        return 1;
+    }
+
+    ResultsReader::Query query;
+    const QString phaseName = parser.value("phase");
+    bool knownPhase = false;
+    for (int phase = 0; phase < FlowResult::PhaseCount; ++phase) {
+        if (FlowResult::phaseName(FlowResult::Phase(phase)) == phaseName) {
+            query.phase = FlowResult::Phase(phase);
+            knownPhase = true;
+        }
+    }
+    if (!knownPhase) {
+        out << "Unknown phase " << phaseName << " (total, discovery, authorize or token)" << Qt::endl;
+        return 1;
+    }
+    if (parser.isSet("from")) {
+        query.fromUs = qint64(parser.value("from").toDouble() * 1000000.0);
+    }
+    if (parser.isSet("to")) {
+        query.toUs = qint64(parser.value("to").toDouble() * 1000000.0);
+    }
+    query.windowUs = qint64(parser.value("window").toDouble() * 1000000.0);
+
+    out << QString("%1: %2 rows in %3 block(s), run started %4%5")
+           .arg(parser.value("analyze"))
+           .arg(reader.rowCount())
+           .arg(reader.blockCount())
+           .arg(QDateTime::fromMSecsSinceEpoch(reader.runStartEpochMs(), QTimeZone::utc()).toString(Qt::ISODate))
+           .arg(reader.isTruncated() ? " (truncated final block ignored)" : "")
+        << Qt::endl;
+
+    const ResultsReader::Result result = reader.query(query);
+    auto describe = [](const LatencyHistogram& histogram) {
+        return QString("n=%1 mean %2 ms, p50 %3 ms, p90 %4 ms, p99 %5 ms, p99.9 %6 ms, max %7 ms")
+            .arg(histogram.count())
+            .arg(histogram.mean() / 1000.0, 0, 'f', 1)
+            .arg(histogram.percentile(50) / 1000.0, 0, 'f', 1)
+            .arg(histogram.percentile(90) / 1000.0, 0, 'f', 1)
+            .arg(histogram.percentile(99) / 1000.0, 0, 'f', 1)
+            .arg(histogram.percentile(99.9) / 1000.0, 0, 'f', 1)
+            .arg(histogram.max() / 1000.0, 0, 'f', 1);
+    };
+
+    QStringList failures;
+    for (int errorClass = FlowResult::NoError + 1; errorClass < FlowResult::ErrorClassCount; ++errorClass) {
+        failures << QString("%1 %2").arg(FlowResult::errorClassName(FlowResult::ErrorClass(errorClass)))
+                                    .arg(result.failures[errorClass]);
+    }
+
+    out << QString("Phase %1: %2").arg(phaseName, describe(result.latency)) << Qt::endl;
+    out << QString("Failed flows by class: %1").arg(failures.join(", ")) << Qt::endl;
+    out << QString("Tokens per flow: mean %1 bytes, p99 %2 bytes, max %3 bytes")
+           .arg(result.tokenBytes.mean(), 0, 'f', 0)
+           .arg(result.tokenBytes.percentile(99))
+           .arg(result.tokenBytes.max())
+        << Qt::endl;
+
+    for (int window = 0; window < result.windows.size(); ++window) {
+        const LatencyHistogram& histogram = result.windows[window];
+        if (histogram.count() == 0) continue;
+        double start = (query.fromUs + window * query.windowUs) / 1000000.0;
+        out << QString("  %1-%2 s: %3").arg(start, 0, 'f', 1).arg(start + query.windowUs / 1000000.0, 0, 'f', 1)
+                                       .arg(describe(histogram))
+            << Qt::endl;
+    }
+    return 0;
+}
+
+// Headless mode: repeat scripted flows using the configuration saved by the GUI,
+// optionally recording them or replaying a previous recording
+static int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    setApplicationMetadata();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("OIDC Tester - unattended load mode");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption({"load", "Run scripted flows without a browser or GUI."});
+    parser.addOption({"profile", "Saved profile to run (defaults to the last one used in the GUI).", "name"});
+    parser.addOption({"flows", "Number of flows to run.", "count", "100"});
+    parser.addOption({"concurrency", "Flows kept in flight at once.", "count", "1"});
+    parser.addOption({"threads", "Worker threads the concurrent flows are spread over.", "count", "1"});
+    parser.addOption({"form-fields", "Login form fields (key1=value1&key2=value2), overrides the saved value.", "fields"});
+    parser.addOption({"record", "Capture discovery, callback and token exchanges to <file>.", "file"});
+    parser.addOption({"replay", "Serve the exchanges captured in <file> from a local stand-in IdP.", "file"});
+    parser.addOption({"replay-port", "Port for the replay server (0 picks a free port).", "port", "0"});
+    parser.addOption({"replay-scale", "Multiplier for recorded response times (0 = no delay).", "factor", "1.0"});
+    parser.addOption({"soak", "Run flows continuously for <hours>, sampling process health.", "hours"});
+    parser.addOption({"soak-out", "CSV time series written during a soak run.", "file", "soak.csv"});
+    parser.addOption({"sample-interval", "Seconds between soak samples.", "seconds", "10"});
+    parser.addOption({"scenario", "Run the weighted multi-step flows described in <file> (JSON).", "file"});
+    parser.addOption({"rules", "Claim assertions checked against every issued token.", "file"});
+    parser.addOption({"unique", "Detect repeated jti, authorization code and nonce values."});
+    parser.addOption({"unique-bloom-mb", "Bound --unique memory with a Bloom filter of <MB> (0 = exact).", "MB", "0"});
+    parser.addOption({"token-stats", "Report token size and claim cardinality statistics."});
+    parser.addOption({"token-stats-out", "Also write the token statistics as JSON to <file>.", "file"});
+    parser.addOption({"json-backend", "Response parser for unattended runs: ondemand (default) or qt.", "name", "ondemand"});
+    parser.addOption({"rate", "Start at most <n> flows per second (0 = as fast as concurrency allows).", "n", "0"});
+    parser.addOption({"coordinator", "Split the run across <count> spawned worker processes.", "count", "0"});
+    parser.addOption({"attach", "Also wait for <count> workers started by hand with --worker.", "count", "0"});
+    parser.addOption({"coordinator-socket", "Local socket name the coordinator listens on.", "name"});
+    parser.addOption({"worker", "Run the share assigned by the coordinator listening on <socket>.", "socket"});
+    parser.addOption({"retries", "Retry failed refresh requests up to <n> times (5xx, 429, transport errors).", "n", "0"});
+    parser.addOption({"retry-base-ms", "Backoff ceiling of the first retry; doubles per retry, full jitter.", "ms", "100"});
+    parser.addOption({"retry-max-ms", "Upper bound of the retry backoff.", "ms", "5000"});
+    parser.addOption({"hedge", "Send a second refresh request when the first is slower than the hedge delay."});
+    parser.addOption({"hedge-delay-ms", "Fixed hedge delay (0 = p95 of refresh attempts so far).", "ms", "0"});
+    parser.addOption({"network-timing", "Report DNS, connect/TLS, TTFB and transfer time per endpoint."});
+    parser.addOption({"client-cert", "PEM client certificate for mutual TLS at the token endpoint, overrides the saved value.", "file"});
+    parser.addOption({"client-key", "PEM private key of --client-cert, if not in the same file.", "file"});
+    parser.addOption({"assertion-key", "Authenticate with private_key_jwt assertions signed by this PEM key (RS256/ES256).", "file"});
+    parser.addOption({"assertion-kid", "kid header of --assertion-key assertions.", "id"});
+    parser.addOption({"dpop", "Request DPoP-bound tokens: proofs on token and refresh requests (RFC 9449)."});
+    parser.addOption({"no-tls-resumption", "Do not share TLS session tickets between flows (full handshake per connection)."});
+    parser.addOption({"results", "Write one row per finished flow to the binary results <file>.", "file"});
+    parser.addOption({"analyze", "Report percentiles from a results <file> written by --results.", "file"});
+    parser.addOption({"phase", "With --analyze: total, discovery, authorize or token.", "name", "total"});
+    parser.addOption({"from", "With --analyze: only flows finished at or after <s> into the run.", "seconds"});
+    parser.addOption({"to", "With --analyze: only flows finished before <s> into the run.", "seconds"});
+    parser.addOption({"window", "With --analyze: also report every <s> second window.", "seconds", "0"});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    auto log = [&out](const QString& message) {
+        out << message << Qt::endl;
+    };
+
+    // The GUI keeps QJsonDocument; unattended runs default to the on-demand scanner
+    JsonObjectView::setDefaultBackend(parser.value("json-backend") == "qt" ? JsonObjectView::QtBackend
+                                                                          : JsonObjectView::OnDemandBackend);
+
+    if (parser.isSet("analyze")) {
+        return runAnalyze(parser);
+    }
+
+    if (parser.isSet("coordinator") || parser.isSet("attach")) {
+        return runCoordinator(app, parser);
+    }
+
+    LoadConfig config = LoadConfig::fromSettings(parser.value("profile"));
+    config.flows = parser.value("flows").toInt();
+    config.concurrency = parser.value("concurrency").toInt();
+    config.threads = parser.value("threads").toInt();
+    config.ratePerSecond = parser.value("rate").toDouble();
+    if (parser.isSet("form-fields")) {
+        config.loginFormFields = parser.value("form-fields");
+    }
+    if (parser.isSet("client-cert")) {
+        config.clientCertificate = parser.value("client-cert");
+        config.clientKey = parser.value("client-key");
+    }
+    if (parser.isSet("dpop")) {
+        config.useDpop = true;
+    }
+    if (parser.isSet("assertion-key")) {
+        config.clientAssertionKey = parser.value("assertion-key");
+        config.clientAssertionKeyId = parser.value("assertion-kid");
+    }
+    if (parser.isSet("soak")) {
+        config.durationMs = qint64(parser.value("soak").toDouble() * 3600.0 * 1000.0);
+    }
+
+    QString error;
+
+    LoadWorker worker;
+    QString outputSuffix;
+    const bool isWorker = parser.isSet("worker");
+    if (isWorker) {
+        WorkerAssignment assignment;
+        if (!worker.connectToCoordinator(parser.value("worker"), &assignment, &error)) {
+            log(error);
+            return 1;
+        }
+        config.flows = assignment.flows;
+        config.concurrency = assignment.concurrency;
+        config.ratePerSecond = assignment.ratePerSecond;
+        config.durationMs = assignment.durationMs;
+
+        // Workers get the coordinator's output paths; each writes its own file
+        outputSuffix = QString(".w%1").arg(assignment.index + 1);
+    }
+    auto outputPath = [&parser, &outputSuffix](const QString& name) {
+        return parser.value(name) + outputSuffix;
+    };
+
+    ReplayServer replay;
+    QObject::connect(&replay, &ReplayServer::logMessage, log);
+    if (parser.isSet("replay")) {
+        replay.setTimeScale(parser.value("replay-scale").toDouble());
+        if (!replay.load(parser.value("replay"), &error) ||
+            !replay.listen(quint16(parser.value("replay-port").toUInt()), &error)) {
+            log(error);
+            return 1;
+        }
+
+        if (!parser.isSet("load") && !parser.isSet("soak") && !isWorker) {
+            // Serve until killed, for clients pointed at the printed issuer URL
+            return app.exec();
+        }
+
+        config.issuerURL = replay.issuerURL();
+        if (config.clientID.isEmpty()) {
+            config.clientID = "replay-client";
+        }
+    }
+
+    if (config.issuerURL.isEmpty() || config.clientID.isEmpty()) {
+        log("Issuer URL and Client ID must be configured (run the GUI once to save them).");
+        return 1;
+    }
+
+    ExchangeRecorder recorder;
+    if (parser.isSet("record") && !recorder.open(outputPath("record"), &error)) {
+        log(error);
+        return 1;
+    }
+
+    ResultsWriter results;
+    if (parser.isSet("results") && !results.open(outputPath("results"), &error)) {
+        log(error);
+        return 1;
+    }
+
+    ClaimRules rules;
+    if (parser.isSet("rules") && !rules.loadFile(parser.value("rules"), &error)) {
+        log(QString("Invalid rules: %1").arg(error));
+        return 1;
+    }
+
+    Scenario scenario;
+    if (parser.isSet("scenario")) {
+        if (!scenario.loadFile(parser.value("scenario"), config, &error)) {
+            log(QString("Invalid scenario: %1").arg(error));
+            return 1;
+        }
+        if (scenario.concurrency() > 0 && !parser.isSet("concurrency") && !isWorker) {
+            config.concurrency = scenario.concurrency();
+        }
+    }
+
+    LoadRunner runner(config);
+    runner.setScenario(&scenario);
+    if (recorder.isOpen()) {
+        runner.setRecorder(&recorder);
+    }
+    if (!rules.isEmpty()) {
+        runner.setRules(&rules);
+    }
+    if (results.isOpen()) {
+        runner.setResultsWriter(&results);
+    }
+
+    NetworkTimingStats networkStats;
+    if (parser.isSet("network-timing")) {
+        runner.setNetworkTimingStats(&networkStats);
+    }
+    if (!parser.isSet("no-tls-resumption")) {
+        runner.setTlsSessionCache(TlsSessionCache::shared());
+    }
+
+    RetryPolicy retryPolicy;
+    retryPolicy.setMaxAttempts(parser.value("retries").toInt() + 1);
+    retryPolicy.setBackoff(parser.value("retry-base-ms").toInt(), parser.value("retry-max-ms").toInt());
+    retryPolicy.setHedging(parser.isSet("hedge"), parser.value("hedge-delay-ms").toInt());
+    if (retryPolicy.maxAttempts() > 1 || retryPolicy.hedging()) {
+        runner.setRetryPolicy(&retryPolicy);
+    }
+
+    UniquenessChecker uniqueness(quint64(parser.value("unique-bloom-mb").toDouble() * 1024 * 1024));
+    if (parser.isSet("unique") || parser.isSet("unique-bloom-mb")) {
+        runner.setUniquenessChecker(&uniqueness);
+    }
+
+    TokenAnalytics tokenAnalytics;
+    if (parser.isSet("token-stats") || parser.isSet("token-stats-out")) {
+        runner.setTokenAnalytics(&tokenAnalytics);
+    }
+
+    SoakMonitor soakMonitor(&runner);
+    if (parser.isSet("soak") &&
+        !soakMonitor.start(parser.value("soak-out"), parser.value("sample-interval").toInt() * 1000, &error)) {
+        log(error);
+        return 1;
+    }
+
+    QObject::connect(&runner, &LoadRunner::logMessage, log);
+    QObject::connect(&runner, &LoadRunner::finished, &app, [&]() {
+        if (isWorker) {
+            // The coordinator prints this worker's summary with the merged report
+            if (!worker.sendResult(runner, &error)) {
+                log(error);
+            }
+        } else {
+            log(runner.summary());
+        }
+        if (parser.isSet("soak")) {
+            soakMonitor.stop();
+            log(soakMonitor.summary());
+        }
+        if (parser.isSet("token-stats-out")) {
+            QSaveFile statsFile(outputPath("token-stats-out"));
+            if (statsFile.open(QIODevice::WriteOnly)) {
+                statsFile.write(QJsonDocument(tokenAnalytics.toJson()).toJson(QJsonDocument::Indented));
+            }
+            if (!statsFile.commit()) {
+                log(QString("Could not write %1: %2").arg(statsFile.fileName(), statsFile.errorString()));
+            }
+        }
+        if (results.isOpen()) {
+            results.close();
+            log(QString("Wrote %1 result rows to %2").arg(results.rowCount()).arg(outputPath("results")));
+        }
+        if (recorder.isOpen()) {
+            log(QString("Recorded %1 exchanges to %2").arg(recorder.recordedCount()).arg(outputPath("record")));
+        }
+        bool violated = false;
+        for (int rule = 0; rule < rules.ruleCount(); ++rule) {
+            violated = violated || rules.violations(rule) > 0;
+        }
+        violated = violated || uniqueness.totalDuplicates() > 0;
+        app.exit(runner.failedFlows() > 0 || violated ? 2 : 0);
+    });
+
+    QTimer::singleShot(0, &runner, &LoadRunner::start);
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    if (hasArgument(argc, argv, "--soak")) {
+        SoakMonitor::installObjectCounter();
+    }
+
+    if (hasArgument(argc, argv, "--load") || hasArgument(argc, argv, "--replay") || hasArgument(argc, argv, "--soak") ||
+        hasArgument(argc, argv, "--scenario") || hasArgument(argc, argv, "--coordinator") ||
+        hasArgument(argc, argv, "--attach") || hasArgument(argc, argv, "--worker") ||
+        hasArgument(argc, argv, "--analyze")) {
+        return runHeadless(argc, argv);
+    }
+
+    StartupTimer::start();
+
     QApplication app(argc, argv);
-    
+    StartupTimer::mark("application created");
+
     // Set application metadata
-    QApplication::setApplicationName("OIDC Tester");
-    QApplication::setOrganizationName("OIDC Tester");
-    QApplication::setApplicationVersion("1.0.0");
-    
+    setApplicationMetadata();
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption({"record", "Capture discovery, callback and token exchanges to <file>.", "file"});
+    parser.addOption({"startup-timing", "Print startup phase timings once the first frame is shown."});
+    parser.addOption({"stall-threshold", "Record GUI event loop stalls longer than <ms>.", "ms", "100"});
+    parser.process(app);
+
+    ExchangeRecorder recorder;
+    QString error;
+    if (parser.isSet("record") && !recorder.open(parser.value("record"), &error)) {
+        QTextStream(stderr) << error << Qt::endl;
+        return 1;
+    }
+
     MainWindow window;
+    if (recorder.isOpen()) {
+        window.setRecorder(&recorder);
+    }
+    window.setStallThreshold(parser.value("stall-threshold").toInt());
+    if (parser.isSet("startup-timing")) {
+        QObject::connect(&window, &MainWindow::startupCompleted, [&]() {
+            QTextStream(stderr) << StartupTimer::report() << Qt::endl;
+        });
+    }
     window.show();
-    
+    StartupTimer::mark("window shown");
+
     return app.exec();
 }
-